@@ -179,7 +179,8 @@ glthread_priority_insert(glthread_t *base_glthread,
             continue;
         }
 
-        glthread_add_next(curr, glthread);
+        /*glthread has higher priority than curr, insert it before curr*/
+        glthread_add_before(curr, glthread);
         return;
 
     }ITERATE_GLTHREAD_END(base_glthread, curr);
@@ -34,6 +34,8 @@
 #include <string.h>
 #include <unistd.h> /*for getpagesize, brk(), sbrk()*/
 #include <errno.h>
+#include <inttypes.h>
+#include <sys/mman.h>
 #include "css.h"
 #include "mm.h"
 
@@ -41,11 +43,92 @@
 void          *gb_heap_segment_start = NULL;
 size_t         GB_SYSTEM_PAGE_SIZE = 0;
 uint32_t       gb_no_of_vm_families_registered = 0;
+vm_page_for_families_t *gb_first_vm_page_for_families = NULL;
 void          *gb_hsba = NULL; /*Heap Segment Start for Block Allocation*/
+vm_page_t     *gb_heap_top_vm_page = NULL; /*Top most VM page of heap segment*/
+mm_counter_t   gb_memory_in_use_by_app = 0;
+mm_counter_t   gb_peak_memory_in_use_by_app = 0;
+mm_counter_t   gb_vm_page_memory = 0; /*Bytes held in VM pages by all families*/
+mm_counter_t   gb_peak_vm_page_memory = 0;
+const mm_page_source_ops_t *gb_page_source_ops = NULL;
+uint64_t       gb_soft_vm_page_memory_limit = MM_NO_LIMIT;
+uint64_t       gb_hard_vm_page_memory_limit = MM_NO_LIMIT;
+
+/*Lower of both limits, compared on page acquisition*/
+static uint64_t gb_vm_page_memory_limit_check = MM_NO_LIMIT;
+static mm_pressure_cb_t gb_pressure_cb = NULL;
+static void *gb_pressure_cb_arg = NULL;
+vm_bool_t gb_pressure_cb_running = MM_FALSE;
+/*Family acquiring VM pages while the pressure callback runs*/
+static vm_page_family_t *gb_pressure_vm_page_family = NULL;
+
+#ifndef MM_MMAP_PAGE_SOURCE
+/* VM pages of heap segment owned by no family, below the top most busy
+ * one, queued through their occupancy glue by size in system pages, so
+ * that acquiring one does not walk the heap segment*/
+static glthread_t gb_free_heap_vm_pages[MM_MAX_SYS_PAGES_PER_VM_PAGE + 1];
+#endif
+
+/*Attached page sources, in attach order*/
+#define MM_MAX_PAGE_SOURCES     16
+static mm_page_source_t *gb_page_sources[MM_MAX_PAGE_SOURCES];
+static uint32_t gb_no_of_page_sources = 0;
+
+/* Size classes of xcalloc_buff(), 16B apart up to 256B, then 4 classes
+ * per doubling, so that a buffer wastes at most 25% beyond 256B*/
+static const uint32_t mm_buff_class_sizes[] = {
+
+    16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
+    320, 384, 448, 512, 640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+    2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192
+};
+
+#define MM_BUFF_GRANULE         16
+#define MM_BUFF_NO_OF_CLASSES   \
+    (sizeof(mm_buff_class_sizes)/sizeof(mm_buff_class_sizes[0]))
+
+/*Size class of a buffer, indexed by its size in granules*/
+static uint8_t mm_buff_class_index[MM_BUFF_MAX_CLASS_SIZE / MM_BUFF_GRANULE + 1];
+
+/* Page family of every size class, created on first use. The last one
+ * serves the buffers bigger than MM_BUFF_MAX_CLASS_SIZE*/
+static vm_page_family_t *gb_buff_page_families[MM_BUFF_NO_OF_CLASSES + 1];
+
+/* Freed buffers of a size class are kept on a LIFO of the class, and
+ * handed out again by xcalloc_buff() without going through the sorted
+ * free block list of the family. They stay allocated blocks, queued
+ * through the priority thread glue as idle objects of an object cache
+ * are. A class keeps at most MM_BUFF_CACHE_MAX_BYTES of freed buffers,
+ * xfree() releases the others to their VM pages*/
+#define MM_BUFF_CACHE_MAX_BYTES (64 * 1024)
+
+typedef struct mm_buff_cache_{
+
+    glthread_t buff_list_head;
+    uint32_t no_of_buffs;
+    uint32_t max_buffs;
+} mm_buff_cache_t;
+
+static mm_buff_cache_t gb_buff_caches[MM_BUFF_NO_OF_CLASSES];
+
+static void
+mm_buff_init_class_index(){
+
+    uint32_t granules, buff_class = 0;
+
+    for(granules = 0; granules <= MM_BUFF_MAX_CLASS_SIZE / MM_BUFF_GRANULE;
+        granules++){
+
+        while(mm_buff_class_sizes[buff_class] < granules * MM_BUFF_GRANULE)
+            buff_class++;
+        mm_buff_class_index[granules] = buff_class;
+    }
+}
 
 void
 mm_init(){
 
+    mm_buff_init_class_index();
     GB_SYSTEM_PAGE_SIZE = getpagesize();
     gb_heap_segment_start = sbrk(0);
     if(!gb_heap_segment_start){
@@ -53,28 +136,59 @@ mm_init(){
         assert(0);
     }
 }
+/* VM page of heap segment owned by no family. VM pages reserved with
+ * mm_reserve() are empty too, but stay with their family*/
+static inline vm_bool_t
+mm_is_vm_page_free_in_heap_segment(vm_page_t *vm_page){
+
+    return !vm_page->pg_family && mm_is_vm_page_empty(vm_page);
+}
+
 #if 1
 vm_page_t *
-mm_get_available_page_from_heap_segment(){
+mm_get_available_page_from_heap_segment(uint32_t units){
 
     vm_page_t *vm_page_curr = NULL;
-#if 1
-    vm_page_t *first_vm_page = (vm_page_t *)gb_hsba;
+#ifdef MM_MMAP_PAGE_SOURCE
+    /* Every VM page is a mapping of its own, and is unmapped as soon as
+     * it is empty, so there is nothing to reuse*/
+    vm_page_curr = (vm_page_t *)mmap(NULL, GB_SYSTEM_PAGE_SIZE * units,
+        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(vm_page_curr == MAP_FAILED){
+        printf("Error : VM Page Mapping Failed, error no = %d\n", errno);
+        return 0;
+    }
+    vm_page_curr->page_size = GB_SYSTEM_PAGE_SIZE * units;
+    vm_page_curr->prev_page_size = 0;
+    return vm_page_curr;
+#else
+    glthread_t *glue = gb_free_heap_vm_pages[units].right;
+
+    if(glue){
+        remove_glthread(glue);
+        return glthread_to_vm_page(glue);
+    }
 
-    ITERATE_HEAP_SEGMENT_PAGE_WISE_BEGIN(first_vm_page, vm_page_curr){
-        if(mm_is_vm_page_empty(vm_page_curr)){
-            return vm_page_curr;
-        }
-    }ITERATE_HEAP_SEGMENT_PAGE_WISE_END(first_vm_page, vm_page_curr);
-#endif
     /*No free Page could be found, expand heap segment*/
     
-    vm_page_curr = (vm_page_t *)sbrk(GB_SYSTEM_PAGE_SIZE);
+    vm_page_curr = (vm_page_t *)sbrk(GB_SYSTEM_PAGE_SIZE * units);
 
-    if(!vm_page_curr){
+    if(vm_page_curr == (void *)-1){
         printf("Error : Heap Segment Expansion Failed, error no = %d\n", errno);
         return 0;
     }
+    vm_page_curr->page_size = GB_SYSTEM_PAGE_SIZE * units;
+    vm_page_curr->prev_page_size = 0;
+
+    /* Remember the size of VM page lying just below, unless someone
+     * else has moved the break pointer in between*/
+    if(gb_heap_top_vm_page &&
+        (char *)gb_heap_top_vm_page + gb_heap_top_vm_page->page_size ==
+        (char *)vm_page_curr){
+        vm_page_curr->prev_page_size = gb_heap_top_vm_page->page_size;
+    }
+    gb_heap_top_vm_page = vm_page_curr;
 #if 0
     printf("Heap Segment Expanded. New diff = %lu, page units from gb_hsba = %ld, new sbrk = %p\n",
         (unsigned long)sbrk(0) - (unsigned long)initial_break,
@@ -82,6 +196,45 @@ mm_get_available_page_from_heap_segment(){
         sbrk(0));
 #endif
     return vm_page_curr;
+#endif
+}
+#endif
+
+#ifndef MM_MMAP_PAGE_SOURCE
+/* Expand heap segment by count VM pages of units system pages with one
+ * sbrk(). The VM pages are left free in heap segment, the top most one
+ * last. Return the bottom most one*/
+static vm_page_t *
+mm_expand_heap_segment(uint32_t units, uint32_t count){
+
+    uint32_t i;
+    vm_page_t *vm_page_curr, *vm_page_first;
+    uint32_t page_size = GB_SYSTEM_PAGE_SIZE * units;
+
+    vm_page_first = (vm_page_t *)sbrk((intptr_t)page_size * count);
+
+    if(vm_page_first == (void *)-1){
+        printf("Error : Heap Segment Expansion Failed, error no = %d\n", errno);
+        return NULL;
+    }
+
+    for(i = 0; i < count; i++){
+
+        vm_page_curr = (vm_page_t *)((char *)vm_page_first + (size_t)i * page_size);
+        MARK_VM_PAGE_EMPTY(vm_page_curr);
+        vm_page_curr->pg_family = NULL;
+        init_glthread(&vm_page_curr->occupancy_glue);
+        vm_page_curr->page_size = page_size;
+        vm_page_curr->prev_page_size = 0;
+
+        if(gb_heap_top_vm_page &&
+            (char *)gb_heap_top_vm_page + gb_heap_top_vm_page->page_size ==
+            (char *)vm_page_curr){
+            vm_page_curr->prev_page_size = gb_heap_top_vm_page->page_size;
+        }
+        gb_heap_top_vm_page = vm_page_curr;
+    }
+    return vm_page_first;
 }
 #endif
 
@@ -97,50 +250,153 @@ mm_get_available_page_from_heap_segment(){
 #endif
 
 static inline uint32_t
-mm_max_page_allocatable_memory(){
+mm_max_page_allocatable_memory(uint32_t units){
 
     return (uint32_t)
-        (GB_SYSTEM_PAGE_SIZE - offset_of(vm_page_t, page_memory));
+        ((GB_SYSTEM_PAGE_SIZE * units) - offset_of(vm_page_t, page_memory));
 }
 
-#define MAX_PAGE_ALLOCATABLE_MEMORY \
-    (mm_max_page_allocatable_memory())
+#define MAX_PAGE_ALLOCATABLE_MEMORY(units) \
+    (mm_max_page_allocatable_memory(units))
 
-static vm_page_t *
-mm_get_available_page_index(vm_page_family_t *vm_page_family){
+/* Bytes left unusable at the bottom of a VM page of 'units' system
+ * pages once it is packed with single objects of size struct_size.
+ * The first object sits in the block embedded in vm_page_t, every
+ * other object costs a meta block on top of struct_size*/
+static uint32_t
+mm_page_tail_waste(uint32_t struct_size, uint32_t units){
 
-    vm_page_t *curr, *prev;
-    int page_index = -1;
+    uint32_t usable_size = MAX_PAGE_ALLOCATABLE_MEMORY(units);
+    uint32_t no_of_blocks;
 
-    if(!vm_page_family->first_page)
-        return NULL;
+    if(usable_size < struct_size)
+        return GB_SYSTEM_PAGE_SIZE * units;
+
+    no_of_blocks = 1 + ((usable_size - struct_size) / 
+        (sizeof(block_meta_data_t) + struct_size));
+
+    return usable_size - struct_size -
+        ((no_of_blocks - 1) * (sizeof(block_meta_data_t) + struct_size));
+}
+
+static inline double
+mm_page_tail_waste_pct(uint32_t tail_waste, uint32_t units){
+
+    return (double)(tail_waste * 100) / 
+        (double)(GB_SYSTEM_PAGE_SIZE * units);
+}
 
-    ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family, curr){
+/* Pick the logical VM page size (in system pages) for a page family
+ * which minimizes the tail waste. A bigger VM page is preferred only
+ * if it is measurably better, since bigger VM pages are harder to
+ * return to the kernel*/
+static uint32_t
+mm_compute_optimal_vm_page_units(uint32_t struct_size){
 
-        if((int)(curr->page_index) == page_index + 1){
-            page_index++;
-            prev = curr;
+    uint32_t units, best_units = 0;
+    double waste_pct, best_waste_pct = 100.0;
+
+    for(units = 1; units <= MM_MAX_SYS_PAGES_PER_VM_PAGE; units++){
+
+        if(MAX_PAGE_ALLOCATABLE_MEMORY(units) < struct_size)
             continue;
+
+        waste_pct = mm_page_tail_waste_pct(
+            mm_page_tail_waste(struct_size, units), units);
+
+        if(!best_units ||
+            best_waste_pct - waste_pct >= MM_PAGE_TAIL_WASTE_TOLERANCE_PCT){
+            best_units = units;
+            best_waste_pct = waste_pct;
         }
-        return curr->prev;
-    } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family, curr)
+    }
+    return best_units;
+}
+
+static void
+mm_vm_page_compute_largest_free_block(vm_page_t *vm_page){
 
-    return prev;
+    block_meta_data_t *block_meta_data;
+
+    vm_page->largest_free_block = 0;
+
+    ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page, block_meta_data){
+
+        if(block_meta_data->is_free == MM_TRUE &&
+            block_meta_data->block_size > vm_page->largest_free_block){
+            vm_page->largest_free_block = block_meta_data->block_size;
+        }
+    } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page, block_meta_data);
 }
 
-/*Return a fresh new virtual page*/
-vm_page_t *
-allocate_vm_page(vm_page_family_t *vm_page_family){
+/* Move the VM page to the occupancy class list matching its current
+ * bytes_in_use and largest_free_block*/
+static void
+mm_vm_page_update_occupancy(vm_page_t *vm_page){
+
+    uint32_t partial_class;
+    mm_page_occupancy_t occupancy;
+    vm_page_family_t *vm_page_family = vm_page->pg_family;
+
+    if(!vm_page->bytes_in_use){
+        occupancy = MM_PAGE_OCCUPANCY_EMPTY;
+    }
+    else if(vm_page->largest_free_block < vm_page_family->struct_size){
+        occupancy = MM_PAGE_OCCUPANCY_FULL;
+    }
+    else{
+        partial_class = (uint32_t)
+            (((uint64_t)vm_page->bytes_in_use * MM_PAGE_OCCUPANCY_PARTIAL_CLASSES) /
+             vm_page->page_size);
+        if(partial_class >= MM_PAGE_OCCUPANCY_PARTIAL_CLASSES)
+            partial_class = MM_PAGE_OCCUPANCY_PARTIAL_CLASSES - 1;
+        occupancy = MM_PAGE_OCCUPANCY_PARTIAL + partial_class;
+    }
+
+    if(occupancy == vm_page->occupancy)
+        return;
 
-    vm_page_t *prev_page = 
-        mm_get_available_page_index(vm_page_family);
+    /* Only reserved VM pages stay empty in the family, others are released
+     * as soon as they become empty*/
+    if(vm_page->occupancy == MM_PAGE_OCCUPANCY_EMPTY)
+        MM_COUNTER_SUB(vm_page_family->no_of_reserved_vm_pages, 1);
 
-    vm_page_t *vm_page = 
-        mm_get_available_page_from_heap_segment();
+    remove_glthread(&vm_page->occupancy_glue);
+    glthread_add_next(&vm_page_family->page_occupancy_list_head[occupancy],
+        &vm_page->occupancy_glue);
+    vm_page->occupancy = occupancy;
+}
+
+static vm_bool_t
+mm_vm_page_limits_check(vm_page_family_t *vm_page_family);
+
+/* Below every limit, the only cost is one comparison per scope. Limits
+ * are checked before the VM page is picked, the pressure callback may
+ * release VM pages*/
+static inline vm_bool_t
+mm_vm_page_within_limits(vm_page_family_t *vm_page_family){
+
+    if(MM_COUNTER_READ(vm_page_family->no_of_vm_pages) <
+            vm_page_family->page_limit_check &&
+        MM_COUNTER_READ(gb_vm_page_memory) +
+            vm_page_family->vm_page_units * GB_SYSTEM_PAGE_SIZE <=
+            gb_vm_page_memory_limit_check){
+        return MM_TRUE;
+    }
+    return mm_vm_page_limits_check(vm_page_family);
+}
+
+/* Make a VM page just taken from the page source or heap segment one
+ * free block of the family, linked first in the family, which keeps
+ * VM pages in descending page index order. The VM page is in no
+ * occupancy class until its first block is allocated*/
+static void
+mm_vm_page_add_to_family(vm_page_family_t *vm_page_family,
+                         vm_page_t *vm_page){
 
     vm_page->block_meta_data.is_free = MM_TRUE;
     vm_page->block_meta_data.block_size = 
-        MAX_PAGE_ALLOCATABLE_MEMORY;
+        MAX_PAGE_ALLOCATABLE_MEMORY(vm_page_family->vm_page_units);
     vm_page->block_meta_data.offset = 
         offset_of(vm_page_t, block_meta_data);
     init_glthread(&vm_page->block_meta_data.priority_thread_glue);
@@ -148,65 +404,390 @@ allocate_vm_page(vm_page_family_t *vm_page_family){
      vm_page->block_meta_data.next_block = NULL;
     vm_page->next = NULL;
     vm_page->prev = NULL;
-    vm_page_family->no_of_system_calls_to_alloc_dealloc_vm_pages++;
+    vm_page->bytes_in_use = 0;
+    vm_page->no_of_pinned_blocks = 0;
+    vm_page->largest_free_block = vm_page->block_meta_data.block_size;
+    vm_page->occupancy = MM_PAGE_OCCUPANCY_MAX;
+    init_glthread(&vm_page->occupancy_glue);
+    MM_COUNTER_ADD(vm_page_family->no_of_system_calls_to_alloc_dealloc_vm_pages, 1);
+    MM_COUNTER_ADD(vm_page_family->no_of_vm_pages, 1);
+    if(!MM_FAMILY_IS_SHARED(vm_page_family)){
+        MM_COUNTER_UPDATE_PEAK(gb_peak_vm_page_memory,
+            MM_COUNTER_ADD(gb_vm_page_memory, vm_page->page_size));
+    }
     vm_page->pg_family = vm_page_family;
 
-    if(!prev_page){
-        vm_page->page_index = 0;
-        vm_page->next = vm_page_family->first_page;
-        if(vm_page_family->first_page)
-            vm_page_family->first_page->prev = vm_page;
-        vm_page_family->first_page = vm_page;
-        return vm_page;
-    }
+    vm_page->page_index = vm_page_family->first_page ?
+        vm_page_family->first_page->page_index + 1 : 0;
+    vm_page->next = vm_page_family->first_page;
+    if(vm_page_family->first_page)
+        vm_page_family->first_page->prev = vm_page;
+    vm_page_family->first_page = vm_page;
+    MM_TRACE_EVENT(vm_page_family, MM_TRACE_OP_PAGE_ACQUIRE,
+        vm_page, vm_page, vm_page->page_size);
+}
+
+/*Return a fresh new virtual page*/
+vm_page_t *
+allocate_vm_page(vm_page_family_t *vm_page_family){
 
-    vm_page->next = prev_page->next;
-    vm_page->prev = prev_page;
-    if(vm_page->next)
-        vm_page->next->prev = vm_page;
-    prev_page->next = vm_page;
-    vm_page->page_index = prev_page->page_index + 1;
+    MM_LATENCY_START(page_acquire_start_ts);
+
+    if(!mm_vm_page_within_limits(vm_page_family))
+        return NULL;
+
+    vm_page_t *vm_page = vm_page_family->page_source ?
+        gb_page_source_ops->get_vm_page(
+            vm_page_family->page_source, vm_page_family->vm_page_units) :
+        mm_get_available_page_from_heap_segment(vm_page_family->vm_page_units);
+
+    if(!vm_page)
+        return NULL;
+
+    mm_vm_page_add_to_family(vm_page_family, vm_page);
+    MM_LATENCY_RECORD(vm_page_family, MM_LATENCY_OP_PAGE_ACQUIRE,
+        page_acquire_start_ts);
     return vm_page;
 }
-void
-mm_instantiate_new_page_family(
-    char *struct_name,
-    uint32_t struct_size){
 
-    vm_page_family_t *vm_page_family = NULL;
-    static size_t remaining_bytes_in_a_page = 0;
+/* Family handle table, indexed by family id, so a handle is the family
+ * id + 1. The entry follows the family when mm_family_destroy() moves
+ * it, and is cleared when the family is destroyed. Table is taken
+ * directly from kernel, its pages are touched only as families get
+ * registered*/
+static vm_page_family_t **gb_family_handle_table = NULL;
 
-    if(struct_size > GB_SYSTEM_PAGE_SIZE){
-        printf("Error : %s() Structure Size exceeds system page size\n",
-            __FUNCTION__);
+static void
+mm_family_handle_table_set(uint32_t family_id,
+                           vm_page_family_t *vm_page_family){
+
+    if(family_id >= MM_MAX_FAMILY_HANDLES)
         return;
+
+    if(!gb_family_handle_table){
+
+        gb_family_handle_table = mmap(NULL,
+            MM_MAX_FAMILY_HANDLES * sizeof(vm_page_family_t *),
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(gb_family_handle_table == MAP_FAILED){
+            gb_family_handle_table = NULL;
+            return;
+        }
     }
+    gb_family_handle_table[family_id] = vm_page_family;
+}
 
-    if(!gb_no_of_vm_families_registered){
-        
-        vm_page_family = (vm_page_family_t *)sbrk(GB_SYSTEM_PAGE_SIZE);
-        remaining_bytes_in_a_page = GB_SYSTEM_PAGE_SIZE - sizeof(vm_page_family_t);
-        gb_hsba = (void *)
-            ((char *)vm_page_family + GB_SYSTEM_PAGE_SIZE);
+mm_family_handle_t
+mm_get_family_handle(char *struct_name){
+
+    vm_page_family_t *vm_page_family = 
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family || vm_page_family->family_id >= MM_MAX_FAMILY_HANDLES)
+        return MM_FAMILY_HANDLE_NULL;
+
+    /*Family of a shared heap may have been registered by another process*/
+    if(MM_FAMILY_IS_SHARED(vm_page_family))
+        mm_family_handle_table_set(vm_page_family->family_id, vm_page_family);
+
+    if(!gb_family_handle_table)
+        return MM_FAMILY_HANDLE_NULL;
+    return vm_page_family->family_id + 1;
+}
+
+static inline vm_page_family_t *
+mm_family_handle_deref(mm_family_handle_t family_handle){
+
+    if(family_handle == MM_FAMILY_HANDLE_NULL ||
+        family_handle > MM_MAX_FAMILY_HANDLES || !gb_family_handle_table){
+        return NULL;
+    }
+    return gb_family_handle_table[family_handle - 1];
+}
+
+static vm_page_family_t *
+mm_instantiate_page_family(
+    char *struct_name,
+    uint32_t struct_size,
+    uint32_t vm_page_units,
+    mm_page_source_t *page_source){
+
+    vm_page_family_t *vm_page_family = NULL;
+    uint32_t i;
+
+    vm_page_for_families_t *vm_page_for_families_curr = NULL;
+    vm_page_for_families_t *vm_page_for_families_last = NULL;
+
+    if(page_source){
+
+        vm_page_for_families_curr = page_source->vm_page_for_families;
+
+        if(vm_page_for_families_curr->no_of_families ==
+                MAX_FAMILIES_PER_VM_PAGE){
+            printf("Error : %s() No room for family %s in its page source\n",
+                __FUNCTION__, struct_name);
+            return NULL;
+        }
+    }
+    else{
+        /* First family page having room, pages emptied by destroy are
+         * reused*/
+        for(vm_page_for_families_curr = gb_first_vm_page_for_families;
+            vm_page_for_families_curr;
+            vm_page_for_families_curr = vm_page_for_families_curr->next){
+
+            if(vm_page_for_families_curr->no_of_families <
+                    MAX_FAMILIES_PER_VM_PAGE){
+                break;
+            }
+            vm_page_for_families_last = vm_page_for_families_curr;
+        }
     }
-    else if(remaining_bytes_in_a_page >= sizeof(vm_page_family_t)){
-        
-        vm_page_family = (vm_page_family_t *)((char *)gb_heap_segment_start + \
-            GB_SYSTEM_PAGE_SIZE - remaining_bytes_in_a_page);
 
-        remaining_bytes_in_a_page -= sizeof(vm_page_family_t);
+    if(vm_page_for_families_curr){
+        vm_page_for_families_last = vm_page_for_families_curr;
     }
     else{
-        vm_page_family = (vm_page_family_t *)sbrk(GB_SYSTEM_PAGE_SIZE);
-        remaining_bytes_in_a_page = GB_SYSTEM_PAGE_SIZE - sizeof(vm_page_family_t);
+
+        /*Request a new vm page from kernel to add a new family*/
+#ifdef MM_MMAP_PAGE_SOURCE
+        vm_page_for_families_t *new_vm_page_for_families = 
+            (vm_page_for_families_t *)mmap(NULL, GB_SYSTEM_PAGE_SIZE,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#else
+        vm_page_for_families_t *new_vm_page_for_families = 
+            (vm_page_for_families_t *)sbrk(GB_SYSTEM_PAGE_SIZE);
+#endif
+
+        if(new_vm_page_for_families == (void *)-1){
+            printf("Error : %s() Heap Segment Expansion Failed, error no = %d\n",
+                __FUNCTION__, errno);
+            return NULL;
+        }
+        memset(new_vm_page_for_families, 0, GB_SYSTEM_PAGE_SIZE);
         gb_hsba = (void *)
-            ((char *)vm_page_family + GB_SYSTEM_PAGE_SIZE);
+            ((char *)new_vm_page_for_families + GB_SYSTEM_PAGE_SIZE);
+        gb_heap_top_vm_page = NULL;
+
+        if(vm_page_for_families_last)
+            vm_page_for_families_last->next = new_vm_page_for_families;
+        else
+            gb_first_vm_page_for_families = new_vm_page_for_families;
+        vm_page_for_families_last = new_vm_page_for_families;
     }
-    gb_no_of_vm_families_registered++;
-    strncpy(vm_page_family->struct_name, struct_name, MM_MAX_STRUCT_NAME);
+
+    vm_page_family = &vm_page_for_families_last->vm_page_family[
+        vm_page_for_families_last->no_of_families++];
+
+    memset(vm_page_family, 0, sizeof(vm_page_family_t));
+    strncpy(vm_page_family->struct_name, struct_name, MM_MAX_STRUCT_NAME - 1);
     vm_page_family->struct_size = struct_size;
+    vm_page_family->vm_page_units = vm_page_units;
+    vm_page_family->page_tail_waste = 
+        mm_page_tail_waste(struct_size, vm_page_units);
     vm_page_family->first_page = NULL;
+    vm_page_family->page_source = page_source;
+    vm_page_family->family_id = MM_FAMILY_IS_SHARED(vm_page_family) ?
+        MM_SHARED_FAMILY_ID_BASE + page_source->no_of_families_registered++ :
+        gb_no_of_vm_families_registered++;
+    vm_page_family->placement_policy = MM_PLACEMENT_FULLEST_PAGE;
+    vm_page_family->soft_page_limit = MM_NO_LIMIT;
+    vm_page_family->hard_page_limit = MM_NO_LIMIT;
+    vm_page_family->page_limit_check = MM_NO_LIMIT;
     init_glthread(&vm_page_family->free_block_priority_list_head);
+    for(i = 0; i < MM_PAGE_OCCUPANCY_MAX; i++)
+        init_glthread(&vm_page_family->page_occupancy_list_head[i]);
+    mm_family_handle_table_set(vm_page_family->family_id, vm_page_family);
+    return vm_page_family;
+}
+
+void
+mm_instantiate_new_page_family(
+    char *struct_name,
+    uint32_t struct_size){
+
+    uint32_t vm_page_units = mm_compute_optimal_vm_page_units(struct_size);
+
+    if(!vm_page_units){
+        printf("Error : %s() Structure Size exceeds max VM page size\n",
+            __FUNCTION__);
+        return;
+    }
+    mm_instantiate_page_family(struct_name, struct_size, vm_page_units, NULL);
+}
+
+vm_page_family_t *
+mm_instantiate_page_family_in_page_source(char *struct_name,
+                                          uint32_t struct_size,
+                                          mm_page_source_t *page_source){
+
+    uint32_t vm_page_units = mm_compute_optimal_vm_page_units(struct_size);
+
+    if(!vm_page_units){
+        printf("Error : %s() Structure Size exceeds max VM page size\n",
+            __FUNCTION__);
+        return NULL;
+    }
+    return mm_instantiate_page_family(struct_name, struct_size,
+                vm_page_units, page_source);
+}
+
+static const char *mm_placement_policy_names[MM_PLACEMENT_POLICY_MAX] = {
+
+    "worst-fit", "best-fit", "first-fit", "fullest-page"
+};
+
+const char *
+mm_placement_policy_str(mm_placement_policy_t placement_policy){
+
+    if(placement_policy >= MM_PLACEMENT_POLICY_MAX)
+        return "unknown";
+    return mm_placement_policy_names[placement_policy];
+}
+
+int
+mm_set_page_family_placement_policy(char *struct_name,
+                                    mm_placement_policy_t placement_policy){
+
+    vm_page_family_t *vm_page_family = 
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family || placement_policy >= MM_PLACEMENT_POLICY_MAX)
+        return -1;
+
+    MM_FAMILY_LOCK(vm_page_family);
+    vm_page_family->placement_policy = placement_policy;
+    MM_FAMILY_UNLOCK(vm_page_family);
+    return 0;
+}
+
+/*Lower of the limit in pages and of the limit in bytes, in units*/
+static uint64_t
+mm_limit_in_units(uint64_t pages, uint64_t bytes, uint64_t unit_size){
+
+    uint64_t limit = pages ? pages : MM_NO_LIMIT;
+
+    if(bytes && bytes / unit_size < limit)
+        limit = bytes / unit_size;
+    return limit;
+}
+
+int
+mm_set_family_limits(char *struct_name, const mm_limits_t *limits){
+
+    uint64_t vm_page_size;
+    vm_page_family_t *vm_page_family = 
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family)
+        return -1;
+
+    vm_page_size = vm_page_family->vm_page_units * GB_SYSTEM_PAGE_SIZE;
+
+    vm_page_family->soft_page_limit = mm_limit_in_units(limits->soft_pages,
+        limits->soft_bytes, vm_page_size);
+    vm_page_family->hard_page_limit = mm_limit_in_units(limits->hard_pages,
+        limits->hard_bytes, vm_page_size);
+    vm_page_family->page_limit_check =
+        vm_page_family->soft_page_limit < vm_page_family->hard_page_limit ?
+        vm_page_family->soft_page_limit : vm_page_family->hard_page_limit;
+    return 0;
+}
+
+void
+mm_set_limits(const mm_limits_t *limits){
+
+    uint64_t soft_pages = mm_limit_in_units(limits->soft_pages,
+        limits->soft_bytes, GB_SYSTEM_PAGE_SIZE);
+    uint64_t hard_pages = mm_limit_in_units(limits->hard_pages,
+        limits->hard_bytes, GB_SYSTEM_PAGE_SIZE);
+
+    gb_soft_vm_page_memory_limit = soft_pages == MM_NO_LIMIT ?
+        MM_NO_LIMIT : soft_pages * GB_SYSTEM_PAGE_SIZE;
+    gb_hard_vm_page_memory_limit = hard_pages == MM_NO_LIMIT ?
+        MM_NO_LIMIT : hard_pages * GB_SYSTEM_PAGE_SIZE;
+    gb_vm_page_memory_limit_check =
+        gb_soft_vm_page_memory_limit < gb_hard_vm_page_memory_limit ?
+        gb_soft_vm_page_memory_limit : gb_hard_vm_page_memory_limit;
+}
+
+void
+mm_register_pressure_callback(mm_pressure_cb_t pressure_cb, void *arg){
+
+    gb_pressure_cb = pressure_cb;
+    gb_pressure_cb_arg = arg;
+}
+
+/* Most severe limit new_vm_pages more VM pages of the family would
+ * cross, -1 if none. VM pages of shared families are not part of
+ * gb_vm_page_memory, they escape the limits of the instance*/
+static int
+mm_vm_page_limits_crossed(vm_page_family_t *vm_page_family,
+                          uint64_t new_vm_pages){
+
+    uint64_t no_of_vm_pages =
+        MM_COUNTER_READ(vm_page_family->no_of_vm_pages) + new_vm_pages - 1;
+    uint64_t vm_page_memory = MM_FAMILY_IS_SHARED(vm_page_family) ? 0 :
+        MM_COUNTER_READ(gb_vm_page_memory) +
+        new_vm_pages * vm_page_family->vm_page_units * GB_SYSTEM_PAGE_SIZE;
+
+    if(no_of_vm_pages >= vm_page_family->hard_page_limit)
+        return MM_PRESSURE_FAMILY_HARD;
+    if(vm_page_memory > gb_hard_vm_page_memory_limit)
+        return MM_PRESSURE_INSTANCE_HARD;
+    if(no_of_vm_pages >= vm_page_family->soft_page_limit)
+        return MM_PRESSURE_FAMILY_SOFT;
+    if(vm_page_memory > gb_soft_vm_page_memory_limit)
+        return MM_PRESSURE_INSTANCE_SOFT;
+    return -1;
+}
+
+/* No of VM pages, out of new_vm_pages more, the family may acquire.
+ * The pressure callback gets a chance to shed memory once, before any
+ * of them is acquired, then hard limits are checked again*/
+static uint64_t
+mm_vm_pages_limits_check(vm_page_family_t *vm_page_family,
+                         uint64_t new_vm_pages){
+
+    uint64_t i;
+    int pressure = mm_vm_page_limits_crossed(vm_page_family, new_vm_pages);
+
+    if(pressure < 0)
+        return new_vm_pages;
+
+    if(gb_pressure_cb && !gb_pressure_cb_running){
+
+        gb_pressure_cb_running = MM_TRUE;
+        gb_pressure_vm_page_family = vm_page_family;
+        gb_pressure_cb(vm_page_family->struct_name, pressure,
+            gb_pressure_cb_arg);
+        gb_pressure_vm_page_family = NULL;
+        gb_pressure_cb_running = MM_FALSE;
+    }
+
+    for(i = 0; i < new_vm_pages; i++){
+
+        pressure = mm_vm_page_limits_crossed(vm_page_family, i + 1);
+
+        if(pressure == MM_PRESSURE_FAMILY_HARD ||
+            pressure == MM_PRESSURE_INSTANCE_HARD){
+            MM_COUNTER_ADD(vm_page_family->no_of_hard_limit_failures, 1);
+            break;
+        }
+
+        if(pressure >= 0)
+            MM_COUNTER_ADD(vm_page_family->no_of_soft_limit_hits, 1);
+    }
+    return i;
+}
+
+/* Slow path of allocate_vm_page(), the family or the instance is at a
+ * limit. Return MM_FALSE if the VM page is refused*/
+static vm_bool_t
+mm_vm_page_limits_check(vm_page_family_t *vm_page_family){
+
+    return mm_vm_pages_limits_check(vm_page_family, 1) ? MM_TRUE : MM_FALSE;
 }
 
 vm_page_family_t *
@@ -214,16 +795,17 @@ lookup_page_family_by_name(char *struct_name){
 
     vm_page_family_t *vm_page_family_curr;
 
-    ITERATE_PAGE_FAMILIES_BEGIN(gb_heap_segment_start, 
+    /*Names are kept truncated to MM_MAX_STRUCT_NAME - 1 characters*/
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, 
         vm_page_family_curr){
 
         if(strncmp(vm_page_family_curr->struct_name,
             struct_name,
-            MM_MAX_STRUCT_NAME) == 0){
+            MM_MAX_STRUCT_NAME - 1) == 0){
 
             return vm_page_family_curr;
         }
-    }ITERATE_PAGE_FAMILIES_END(gb_heap_segment_start, vm_page_family_curr);
+    }ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
     return NULL;
 }
 
@@ -255,12 +837,36 @@ mm_add_free_block_meta_data_to_free_block_list(
             &free_block->priority_thread_glue,
             free_blocks_comparison_function,
             offset_of(block_meta_data_t, priority_thread_glue));
+    MM_COUNTER_ADD(vm_page_family->no_of_free_blocks, 1);
+    MM_COUNTER_ADD(vm_page_family->total_free_memory, free_block->block_size);
+}
+
+static void
+mm_remove_free_block_meta_data_from_free_block_list(
+        vm_page_family_t *vm_page_family,
+        block_meta_data_t *free_block){
+
+    /*Block is not queued in the free block list*/
+    if(!free_block->priority_thread_glue.left)
+        return;
+
+    remove_glthread(&free_block->priority_thread_glue);
+    MM_COUNTER_SUB(vm_page_family->no_of_free_blocks, 1);
+    MM_COUNTER_SUB(vm_page_family->total_free_memory, free_block->block_size);
 }
 
 static vm_page_t *
 mm_family_new_page_add(vm_page_family_t *vm_page_family){
 
-    vm_page_t *vm_page = allocate_vm_page(vm_page_family);
+    vm_page_t *vm_page;
+    glthread_t *reserved_glue = vm_page_family->page_occupancy_list_head[
+        MM_PAGE_OCCUPANCY_EMPTY].right;
+
+    /*VM pages reserved with mm_reserve() are used up first*/
+    if(reserved_glue)
+        vm_page = glthread_to_vm_page(reserved_glue);
+    else
+        vm_page = allocate_vm_page(vm_page_family);
 
     if(!vm_page)
         return NULL;
@@ -273,310 +879,1844 @@ mm_family_new_page_add(vm_page_family_t *vm_page_family){
     return vm_page;
 }
 
-/* Fn to mark block_meta_data as being Allocated for
- * 'size' bytes of application data. Return TRUE if 
- * block allocation succeeds*/
-static vm_bool_t
-mm_allocate_free_block(
-            vm_page_family_t *vm_page_family,
-            block_meta_data_t *block_meta_data, 
-            uint32_t size){
+static void
+mm_return_vm_page_to_heap_segment(vm_page_t *vm_page);
+
+/* Fault in the system pages of [addr, addr + size) ahead of use, in one
+ * system call where the kernel can populate page tables on request*/
+static void
+mm_prefault(void *addr, size_t size){
+
+    size_t offset;
+
+#ifdef MADV_POPULATE_WRITE
+    if(!madvise(addr, size, MADV_POPULATE_WRITE))
+        return;
+#endif
+    for(offset = 0; offset < size; offset += GB_SYSTEM_PAGE_SIZE)
+        ((volatile char *)addr)[offset] = ((volatile char *)addr)[offset];
+}
+
+/* Reserved VM pages sit in the empty occupancy class, which no other VM
+ * page stays in, out of the free block list, so that a family with many
+ * of them does not pay for them on every update of the list. They are
+ * never released on the free path until a block of theirs has been
+ * allocated. Free VM pages of the heap segment are taken first, the
+ * heap segment is expanded with one sbrk() for the others*/
+int
+mm_reserve(char *struct_name, uint64_t no_of_objects, uint32_t flags){
+
+    int rc = 0;
+    uint64_t i, first_i = 0, no_of_vm_pages, no_of_vm_pages_allowed,
+        objs_per_vm_page;
+    vm_page_t *vm_page, *vm_page_first = NULL;
+    vm_page_family_t *vm_page_family = 
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family)
+        return -1;
+
+    uint32_t page_size = vm_page_family->vm_page_units * GB_SYSTEM_PAGE_SIZE;
+    uint32_t max_block_size =
+        MAX_PAGE_ALLOCATABLE_MEMORY(vm_page_family->vm_page_units);
+
+    objs_per_vm_page = 1 + (max_block_size - vm_page_family->struct_size) /
+        (sizeof(block_meta_data_t) + vm_page_family->struct_size);
+
+    MM_FAMILY_LOCK(vm_page_family);
+
+    /*VM pages reserved before and not used yet count*/
+    no_of_vm_pages = (no_of_objects + objs_per_vm_page - 1) / objs_per_vm_page;
+    if(no_of_vm_pages <= MM_COUNTER_READ(vm_page_family->no_of_reserved_vm_pages)){
+        MM_FAMILY_UNLOCK(vm_page_family);
+        return 0;
+    }
+    no_of_vm_pages -= MM_COUNTER_READ(vm_page_family->no_of_reserved_vm_pages);
+
+    /*Heap segment is expanded by a 32 bit count of VM pages*/
+    if(no_of_vm_pages > UINT32_MAX){
+        printf("Error : %s() %" PRIu64 " VM pages can not be reserved\n",
+            __FUNCTION__, no_of_vm_pages);
+        MM_FAMILY_UNLOCK(vm_page_family);
+        return -1;
+    }
+
+    /* Limits are checked for all the VM pages before any is taken, the
+     * pressure callback may allocate and free, it must not find VM pages
+     * taken from the heap segment which the family does not own yet*/
+    no_of_vm_pages_allowed =
+        mm_vm_pages_limits_check(vm_page_family, no_of_vm_pages);
+
+    if(no_of_vm_pages_allowed < no_of_vm_pages){
+        rc = -1;
+        no_of_vm_pages = no_of_vm_pages_allowed;
+    }
+
+    if(!no_of_vm_pages){
+        MM_FAMILY_UNLOCK(vm_page_family);
+        return rc;
+    }
+
+    for(i = 0; i < no_of_vm_pages; i++){
+
+#ifndef MM_MMAP_PAGE_SOURCE
+        if(!vm_page_family->page_source && !vm_page_first &&
+            IS_GLTHREAD_LIST_EMPTY(
+                &gb_free_heap_vm_pages[vm_page_family->vm_page_units])){
+
+            vm_page_first = mm_expand_heap_segment(
+                vm_page_family->vm_page_units, (uint32_t)(no_of_vm_pages - i));
+            if(!vm_page_first){
+                rc = -1;
+                break;
+            }
+            first_i = i;
+        }
+#endif
+        if(vm_page_first){
+            vm_page = (vm_page_t *)((char *)vm_page_first +
+                (i - first_i) * page_size);
+        }
+        else{
+            vm_page = vm_page_family->page_source ?
+                gb_page_source_ops->get_vm_page(
+                    vm_page_family->page_source, vm_page_family->vm_page_units) :
+                mm_get_available_page_from_heap_segment(
+                    vm_page_family->vm_page_units);
+
+            if(!vm_page){
+                rc = -1;
+                break;
+            }
+            if(flags & MM_RESERVE_PREFAULT)
+                mm_prefault(vm_page, page_size);
+        }
+
+        mm_vm_page_add_to_family(vm_page_family, vm_page);
+        mm_vm_page_update_occupancy(vm_page);
+        MM_COUNTER_ADD(vm_page_family->no_of_reserved_vm_pages, 1);
+    }
+
+    if(vm_page_first && (flags & MM_RESERVE_PREFAULT))
+        mm_prefault(vm_page_first, (no_of_vm_pages - first_i) * page_size);
+
+    MM_FAMILY_UNLOCK(vm_page_family);
+    return rc;
+}
+
+/* Carve a new free block out of the remaining_size bytes after the
+ * block, without queuing it on the free block list of the family*/
+static block_meta_data_t *
+mm_split_free_block_unlisted(block_meta_data_t *block_meta_data,
+                             uint32_t remaining_size){
+
+    block_meta_data_t *next_block_meta_data = NULL;
+
+    next_block_meta_data = NEXT_META_BLOCK_BY_SIZE(block_meta_data);
+
+    next_block_meta_data->is_free = MM_TRUE;
+
+    next_block_meta_data->block_size = 
+        remaining_size - sizeof(block_meta_data_t);
+
+    next_block_meta_data->offset = block_meta_data->offset + 
+        sizeof(block_meta_data_t) + block_meta_data->block_size;
+
+    init_glthread(&next_block_meta_data->priority_thread_glue); 
+    
+    mm_bind_blocks_for_allocation(block_meta_data, next_block_meta_data);
+
+    return next_block_meta_data;
+}
+
+/*Carve a new free block out of the remaining_size bytes after the block*/
+static void
+mm_split_free_block(vm_page_family_t *vm_page_family,
+                    block_meta_data_t *block_meta_data,
+                    uint32_t remaining_size){
+
+    mm_add_free_block_meta_data_to_free_block_list(vm_page_family,
+        mm_split_free_block_unlisted(block_meta_data, remaining_size));
+}
+
+/* Fn to mark block_meta_data as being Allocated for
+ * 'size' bytes of application data. Return TRUE if 
+ * block allocation succeeds*/
+static vm_bool_t
+mm_allocate_free_block(
+            vm_page_family_t *vm_page_family,
+            block_meta_data_t *block_meta_data, 
+            uint32_t size){
+
+    assert(block_meta_data->is_free == MM_TRUE);
+
+    assert(block_meta_data->block_size >= size);
+
+    uint32_t remaining_size = 
+            block_meta_data->block_size - size;
+
+    vm_page_t *hosting_page = MM_GET_PAGE_FROM_META_BLOCK(block_meta_data);
+
+    /*Page's largest free block shrinks only if it is the one being carved*/
+    vm_bool_t is_largest_free_block = 
+        block_meta_data->block_size == hosting_page->largest_free_block ?
+        MM_TRUE : MM_FALSE;
+
+    /* Since this block of memory is not allocated, remove it from
+     * priority list of free blocks*/
+    mm_remove_free_block_meta_data_from_free_block_list(
+            vm_page_family, block_meta_data);
+
+    block_meta_data->is_free = MM_FALSE;
+    block_meta_data->block_size = size;
+    block_meta_data->handle = MM_HANDLE_NULL;
+    hosting_page->bytes_in_use += sizeof(block_meta_data_t) + size;
+    hosting_page->no_of_pinned_blocks++;
+ 
+    /*Unchanged*/
+    //block_meta_data->offset =  ??
+
+    mm_counter_t memory_in_use = 
+        MM_COUNTER_ADD(vm_page_family->total_memory_in_use_by_app,
+            sizeof(block_meta_data_t) + size);
+    MM_COUNTER_UPDATE_PEAK(vm_page_family->peak_memory_in_use_by_app,
+        memory_in_use);
+    if(!MM_FAMILY_IS_SHARED(vm_page_family)){
+        memory_in_use = MM_COUNTER_ADD(gb_memory_in_use_by_app,
+                sizeof(block_meta_data_t) + size);
+        MM_COUNTER_UPDATE_PEAK(gb_peak_memory_in_use_by_app, memory_in_use);
+    }
+    MM_COUNTER_ADD(vm_page_family->no_of_allocated_blocks, 1);
+    MM_COUNTER_ADD(vm_page_family->no_of_allocations, 1);
+    MM_COUNTER_ADD(vm_page_family->total_memory_allocated, size);
+
+    /* Split only if the remaining memory chunk in this free block is
+     * usable. Otherwise either this block is completely used to satisfy
+     * memory request, or the remainder is unusable because of
+     * fragmentation - however this should not be possible except the
+     * boundry condition*/
+    if(remaining_size >=
+        (sizeof(block_meta_data_t) + vm_page_family->struct_size)){
+
+        mm_split_free_block(vm_page_family, block_meta_data, remaining_size);
+    }
+
+    if(is_largest_free_block)
+        mm_vm_page_compute_largest_free_block(hosting_page);
+
+    mm_vm_page_update_occupancy(hosting_page);
+    return MM_TRUE;
+}
+
+/* Allocate up to count objects of struct_size bytes back to back out
+ * of the free block, zeroed, and store them in objs. The intermediate
+ * free blocks are never queued, so the sorted free block list of the
+ * family is updated once for the whole run instead of once per object.
+ * Return the no of objects allocated, at least 1*/
+static int
+mm_carve_free_block(
+            vm_page_family_t *vm_page_family,
+            block_meta_data_t *block_meta_data,
+            void **objs,
+            int count){
+
+    int n = 0;
+    uint32_t remaining_size;
+    uint32_t size = vm_page_family->struct_size;
+    uint32_t split_threshold = sizeof(block_meta_data_t) + size;
+
+    assert(block_meta_data->is_free == MM_TRUE);
+    assert(block_meta_data->block_size >= size);
+
+    vm_page_t *hosting_page = MM_GET_PAGE_FROM_META_BLOCK(block_meta_data);
+
+    vm_bool_t is_largest_free_block = 
+        block_meta_data->block_size == hosting_page->largest_free_block ?
+        MM_TRUE : MM_FALSE;
+
+    mm_remove_free_block_meta_data_from_free_block_list(
+            vm_page_family, block_meta_data);
+
+    while(1){
+
+        remaining_size = block_meta_data->block_size - size;
+
+        block_meta_data->is_free = MM_FALSE;
+        block_meta_data->block_size = size;
+        block_meta_data->handle = MM_HANDLE_NULL;
+        memset((char *)(block_meta_data + 1), 0, size);
+        objs[n++] = (void *)(block_meta_data + 1);
+
+        if(remaining_size < split_threshold)
+            break;
+
+        if(n == count){
+            mm_split_free_block(vm_page_family, block_meta_data,
+                remaining_size);
+            break;
+        }
+
+        block_meta_data = mm_split_free_block_unlisted(block_meta_data,
+                            remaining_size);
+    }
+
+    hosting_page->bytes_in_use += n * split_threshold;
+    hosting_page->no_of_pinned_blocks += n;
+
+    mm_counter_t memory_in_use = 
+        MM_COUNTER_ADD(vm_page_family->total_memory_in_use_by_app,
+            n * split_threshold);
+    MM_COUNTER_UPDATE_PEAK(vm_page_family->peak_memory_in_use_by_app,
+        memory_in_use);
+    if(!MM_FAMILY_IS_SHARED(vm_page_family)){
+        memory_in_use = MM_COUNTER_ADD(gb_memory_in_use_by_app,
+                n * split_threshold);
+        MM_COUNTER_UPDATE_PEAK(gb_peak_memory_in_use_by_app, memory_in_use);
+    }
+    MM_COUNTER_ADD(vm_page_family->no_of_allocated_blocks, n);
+    MM_COUNTER_ADD(vm_page_family->no_of_allocations, n);
+    MM_COUNTER_ADD(vm_page_family->total_memory_allocated, n * size);
+
+    if(is_largest_free_block)
+        mm_vm_page_compute_largest_free_block(hosting_page);
+
+    mm_vm_page_update_occupancy(hosting_page);
+    return n;
+}
+
+/* Best fitting free block on the most occupied VM page which has one,
+ * so that allocations concentrate on few pages and the sparse pages
+ * drain and get returned to the kernel. skip_page, if not NULL, is not
+ * considered. Empty VM pages are reserved ones, handed out only when a
+ * VM page would be acquired*/
+static block_meta_data_t *
+mm_get_free_block_from_fullest_page(
+        vm_page_family_t *vm_page_family,
+        uint32_t req_size,
+        vm_page_t *skip_page){
+
+    int occupancy;
+    glthread_t *curr;
+    vm_page_t *vm_page;
+    block_meta_data_t *block_meta_data, *chosen_block_meta_data = NULL;
+
+    for(occupancy = MM_PAGE_OCCUPANCY_FULL - 1;
+        occupancy >= MM_PAGE_OCCUPANCY_PARTIAL;
+        occupancy--){
+
+        ITERATE_GLTHREAD_BEGIN(
+            &vm_page_family->page_occupancy_list_head[occupancy], curr){
+
+            vm_page = glthread_to_vm_page(curr);
+
+            if(vm_page->largest_free_block < req_size ||
+                vm_page == skip_page)
+                continue;
+
+            ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page, block_meta_data){
+
+                if(block_meta_data->is_free == MM_TRUE &&
+                    block_meta_data->block_size >= req_size &&
+                    (!chosen_block_meta_data ||
+                     block_meta_data->block_size <
+                        chosen_block_meta_data->block_size)){
+                    chosen_block_meta_data = block_meta_data;
+                }
+            } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page, block_meta_data);
+
+            return chosen_block_meta_data;
+
+        } ITERATE_GLTHREAD_END(
+            &vm_page_family->page_occupancy_list_head[occupancy], curr);
+    }
+    return NULL;
+}
+
+/* Pick the free block of the family to serve req_size bytes as per the
+ * placement policy of the family, NULL if no free block is big enough.
+ * Free block list is sorted by size in descending order, so the walk
+ * stops at the first block which is too small*/
+static block_meta_data_t *
+mm_get_free_block_by_placement_policy(
+        vm_page_family_t *vm_page_family,
+        uint32_t req_size){
+
+    glthread_t *curr;
+    block_meta_data_t *block_meta_data, *chosen_block_meta_data = NULL;
+
+    block_meta_data_t *biggest_block_meta_data = 
+        mm_get_biggest_free_block_page_family(vm_page_family); 
+
+    if(!biggest_block_meta_data || 
+        biggest_block_meta_data->block_size < req_size){
+        return NULL;
+    }
+
+    if(vm_page_family->placement_policy == MM_PLACEMENT_WORST_FIT)
+        return biggest_block_meta_data;
+
+    if(vm_page_family->placement_policy == MM_PLACEMENT_FULLEST_PAGE)
+        return mm_get_free_block_from_fullest_page(vm_page_family,
+                    req_size, NULL);
+
+    ITERATE_GLTHREAD_BEGIN(&vm_page_family->free_block_priority_list_head, curr){
+
+        block_meta_data = glthread_to_block_meta_data(curr);
+
+        if(block_meta_data->block_size < req_size)
+            break;
+
+        switch(vm_page_family->placement_policy){
+
+            case MM_PLACEMENT_BEST_FIT:
+                chosen_block_meta_data = block_meta_data;
+                break;
+            case MM_PLACEMENT_FIRST_FIT:
+                if(!chosen_block_meta_data ||
+                    block_meta_data < chosen_block_meta_data){
+                    chosen_block_meta_data = block_meta_data;
+                }
+                break;
+            default:
+                assert(0);
+        }
+    } ITERATE_GLTHREAD_END(&vm_page_family->free_block_priority_list_head, curr);
+
+    return chosen_block_meta_data;
+}
+
+static vm_page_t *
+mm_get_page_satisfying_request(
+        vm_page_family_t *vm_page_family,
+        uint32_t req_size, 
+        block_meta_data_t **block_meta_data/*O/P*/){
+
+    vm_bool_t status = MM_FALSE;
+    vm_page_t *vm_page = NULL;
+
+    block_meta_data_t *free_block_meta_data = 
+        mm_get_free_block_by_placement_policy(vm_page_family, req_size); 
+
+    if(!free_block_meta_data){
+
+        /*Time to add a new page to Page family to satisfy the request*/
+        vm_page = mm_family_new_page_add(vm_page_family);
+
+        if(!vm_page){
+            *block_meta_data = NULL;
+            return NULL;
+        }
+        /*Allocate the free block from this page now*/
+        status = mm_allocate_free_block(vm_page_family, 
+                    &vm_page->block_meta_data, req_size);
+
+        if(status == MM_FALSE){
+            *block_meta_data = NULL;
+             mm_vm_page_delete_and_free(vm_page);
+             return NULL;
+        }
+
+        *block_meta_data = &vm_page->block_meta_data;
+        return vm_page;
+    }
+    /*The chosen free block can satisfy the request*/
+    status = mm_allocate_free_block(vm_page_family, 
+        free_block_meta_data, req_size);
+        
+    if(status == MM_FALSE){
+        *block_meta_data = NULL;
+        return NULL;
+    }
+
+    *block_meta_data = free_block_meta_data;
+
+    return MM_GET_PAGE_FROM_META_BLOCK(free_block_meta_data);
+}
+
+/* size is 64 bit so that units * struct_size computed by the callers
+ * cannot wrap around below the page size check. Memory is not zeroed*/
+static void *
+mm_xalloc(vm_page_family_t *pg_family, uint64_t size){
+
+    if(size > 
+        MAX_PAGE_ALLOCATABLE_MEMORY(pg_family->vm_page_units)){
+        
+        printf("Error : Memory Requested Exceeds Page Size\n");
+        return NULL;
+    }
+
+    if(!pg_family->first_page){
+
+        pg_family->first_page = mm_family_new_page_add(pg_family);
+
+        if(!pg_family->first_page)
+            return NULL;
+
+        if(mm_allocate_free_block(pg_family, 
+                    &pg_family->first_page->block_meta_data, size)){
+            return (void *)pg_family->first_page->page_memory;
+        }
+    }
+    
+    /*Find the page which can satisfy the request*/
+    block_meta_data_t *free_block_meta_data;
+
+    vm_page_t *vm_page_curr = mm_get_page_satisfying_request(
+                        pg_family, size, &free_block_meta_data);
+    
+    if(free_block_meta_data){
+        /*Sanity Checks*/
+        if(free_block_meta_data->is_free == MM_TRUE ||
+                !IS_GLTHREAD_LIST_EMPTY(&free_block_meta_data->priority_thread_glue)){
+            assert(0);
+        }
+        return  (void *)(free_block_meta_data + 1);
+    }
+
+    return NULL;
+}
+
+static void *
+mm_xcalloc(vm_page_family_t *pg_family, uint64_t size){
+
+    void *result = mm_xalloc(pg_family, size);
+
+    if(result)
+        memset(result, 0, ((block_meta_data_t *)result - 1)->block_size);
+    return result;
+}
+
+/* Handle table of movable objects. Entries are allocated in chunks
+ * taken directly from the kernel, chunks never move, so the table can
+ * grow without invalidating the entries. Free entries are chained
+ * through next_free, handle is entry index + 1*/
+#define MM_HANDLE_CHUNK_ENTRIES     4096
+#define MM_HANDLE_MAX_CHUNKS        1024
+
+typedef struct mm_handle_entry_{
+
+    void *app_data;         /*NULL if the entry is free*/
+    mm_handle_t next_free;
+} mm_handle_entry_t;
+
+static mm_handle_entry_t *gb_handle_chunks[MM_HANDLE_MAX_CHUNKS];
+static uint32_t gb_no_of_handle_chunks = 0;
+static mm_handle_t gb_free_handle = MM_HANDLE_NULL;
+
+static inline mm_handle_entry_t *
+mm_handle_entry(mm_handle_t handle){
+
+    uint32_t index = handle - 1;
+
+    return &gb_handle_chunks[index / MM_HANDLE_CHUNK_ENTRIES]
+                            [index % MM_HANDLE_CHUNK_ENTRIES];
+}
+
+static mm_handle_t
+mm_handle_get(void *app_data){
+
+    uint32_t i;
+    mm_handle_t handle;
+    mm_handle_entry_t *handle_chunk;
+    mm_handle_entry_t *handle_entry;
+
+    if(gb_free_handle == MM_HANDLE_NULL){
+
+        if(gb_no_of_handle_chunks == MM_HANDLE_MAX_CHUNKS)
+            return MM_HANDLE_NULL;
+
+        handle_chunk = mmap(NULL,
+            MM_HANDLE_CHUNK_ENTRIES * sizeof(mm_handle_entry_t),
+            PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(handle_chunk == MAP_FAILED)
+            return MM_HANDLE_NULL;
+
+        handle = gb_no_of_handle_chunks * MM_HANDLE_CHUNK_ENTRIES + 1;
+
+        for(i = 0; i < MM_HANDLE_CHUNK_ENTRIES; i++){
+            handle_chunk[i].app_data = NULL;
+            handle_chunk[i].next_free = i + 1 < MM_HANDLE_CHUNK_ENTRIES ?
+                handle + i + 1 : MM_HANDLE_NULL;
+        }
+        gb_handle_chunks[gb_no_of_handle_chunks++] = handle_chunk;
+        gb_free_handle = handle;
+    }
+
+    handle = gb_free_handle;
+    handle_entry = mm_handle_entry(handle);
+    gb_free_handle = handle_entry->next_free;
+    handle_entry->app_data = app_data;
+    return handle;
+}
+
+static void
+mm_handle_put(mm_handle_t handle){
+
+    mm_handle_entry_t *handle_entry = mm_handle_entry(handle);
+
+    handle_entry->app_data = NULL;
+    handle_entry->next_free = gb_free_handle;
+    gb_free_handle = handle;
+}
+
+void *
+mm_handle_deref(mm_handle_t handle){
+
+    if(handle == MM_HANDLE_NULL ||
+        handle > gb_no_of_handle_chunks * MM_HANDLE_CHUNK_ENTRIES){
+        return NULL;
+    }
+    return mm_handle_entry(handle)->app_data;
+}
+
+/* The public fn to be invoked by the application for Dynamic 
+ * Memory Allocations.*/
+void *
+xcalloc(char *struct_name, int units){
+
+    void *result = NULL;
+    uint64_t size;
+
+    MM_LATENCY_START(alloc_start_ts);
+
+    vm_page_family_t *pg_family = 
+        lookup_page_family_by_name(struct_name);
+
+    if(!pg_family){
+        
+        printf("Error : Structure %s not registered with Memory Manager\n",
+            struct_name);
+        return NULL;
+    }
+
+    if(units < 0){
+        printf("Error : %s() Invalid number of units %d\n", __FUNCTION__, units);
+        return NULL;
+    }
+
+    size = (uint64_t)units * pg_family->struct_size;
+
+    MM_FAMILY_LOCK(pg_family);
+    result = mm_xcalloc(pg_family, size);
+    MM_FAMILY_UNLOCK(pg_family);
+
+    MM_TRACE_EVENT(pg_family, MM_TRACE_OP_ALLOC, result,
+        result ? MM_GET_PAGE_FROM_META_BLOCK(
+            ((block_meta_data_t *)result - 1)) : NULL,
+        (uint32_t)size);
+
+    MM_LATENCY_RECORD(pg_family, MM_LATENCY_OP_ALLOC, alloc_start_ts);
+    return result;
+}
+
+void *
+xcalloc_family(mm_family_handle_t family_handle, int units){
+
+    void *result = NULL;
+    uint64_t size;
+
+    MM_LATENCY_START(alloc_start_ts);
+
+    vm_page_family_t *pg_family = mm_family_handle_deref(family_handle);
+
+    if(!pg_family){
+
+        printf("Error : Family handle %u not registered with Memory Manager\n",
+            family_handle);
+        return NULL;
+    }
+
+    if(units < 0){
+        printf("Error : %s() Invalid number of units %d\n", __FUNCTION__, units);
+        return NULL;
+    }
+
+    size = (uint64_t)units * pg_family->struct_size;
+
+    MM_FAMILY_LOCK(pg_family);
+    result = mm_xcalloc(pg_family, size);
+    MM_FAMILY_UNLOCK(pg_family);
+
+    MM_TRACE_EVENT(pg_family, MM_TRACE_OP_ALLOC, result,
+        result ? MM_GET_PAGE_FROM_META_BLOCK(
+            ((block_meta_data_t *)result - 1)) : NULL,
+        (uint32_t)size);
+
+    MM_LATENCY_RECORD(pg_family, MM_LATENCY_OP_ALLOC, alloc_start_ts);
+    return result;
+}
+
+int
+xcalloc_family_bulk(mm_family_handle_t family_handle,
+                    void **objs, int count){
+
+    int n = 0;
+    vm_page_t *vm_page;
+    block_meta_data_t *free_block_meta_data;
+
+    MM_LATENCY_START(alloc_start_ts);
+
+    vm_page_family_t *pg_family = mm_family_handle_deref(family_handle);
+
+    if(!pg_family){
+
+        printf("Error : Family handle %u not registered with Memory Manager\n",
+            family_handle);
+        return 0;
+    }
+
+    MM_FAMILY_LOCK(pg_family);
+
+    while(n < count){
+
+        free_block_meta_data = mm_get_free_block_by_placement_policy(
+                                    pg_family, pg_family->struct_size);
+
+        if(!free_block_meta_data){
+
+            vm_page = mm_family_new_page_add(pg_family);
+
+            if(!vm_page)
+                break;
+
+            free_block_meta_data = &vm_page->block_meta_data;
+        }
+
+        n += mm_carve_free_block(pg_family, free_block_meta_data,
+                objs + n, count - n);
+    }
+
+    MM_FAMILY_UNLOCK(pg_family);
+
+#ifdef MM_TRACE
+    int i;
+
+    for(i = 0; i < n; i++){
+        MM_TRACE_EVENT(pg_family, MM_TRACE_OP_ALLOC, objs[i],
+            MM_GET_PAGE_FROM_META_BLOCK(((block_meta_data_t *)objs[i] - 1)),
+            pg_family->struct_size);
+    }
+#endif
+
+    MM_LATENCY_RECORD(pg_family, MM_LATENCY_OP_ALLOC, alloc_start_ts);
+    return n;
+}
+
+/* Allocation of typed allocators. The family is looked up by name only
+ * when the cached handle is stale, so that a family destroyed and
+ * registered again is picked up. struct_size is a compile-time constant
+ * of the caller, the caller zeroes the object with a memset of constant
+ * size*/
+void *
+mm_typed_alloc(mm_family_handle_t *family_handle,
+               char *struct_name,
+               uint32_t struct_size){
+
+    void *result;
+
+    MM_LATENCY_START(alloc_start_ts);
+
+    vm_page_family_t *pg_family = mm_family_handle_deref(*family_handle);
+
+    if(!pg_family){
+
+        if(!lookup_page_family_by_name(struct_name))
+            mm_instantiate_new_page_family(struct_name, struct_size);
+
+        *family_handle = mm_get_family_handle(struct_name);
+        pg_family = mm_family_handle_deref(*family_handle);
+
+        if(!pg_family)
+            return NULL;
+
+        if(pg_family->struct_size != struct_size){
+            printf("Error : %s() Family %s is registered with size %u, not %u\n",
+                __FUNCTION__, struct_name, pg_family->struct_size, struct_size);
+            *family_handle = MM_FAMILY_HANDLE_NULL;
+            return NULL;
+        }
+    }
+
+    MM_FAMILY_LOCK(pg_family);
+    result = mm_xalloc(pg_family, struct_size);
+    MM_FAMILY_UNLOCK(pg_family);
+
+    MM_TRACE_EVENT(pg_family, MM_TRACE_OP_ALLOC, result,
+        result ? MM_GET_PAGE_FROM_META_BLOCK(
+            ((block_meta_data_t *)result - 1)) : NULL,
+        struct_size);
+
+    MM_LATENCY_RECORD(pg_family, MM_LATENCY_OP_ALLOC, alloc_start_ts);
+    return result;
+}
+
+/* Page families of buffers are registered like any other, so that they
+ * show up in the statistics. The family of large buffers has VM pages
+ * as big as possible, and its struct_size is the smallest large buffer,
+ * so that a block is split only if the remainder can serve a buffer*/
+static vm_page_family_t *
+mm_get_buff_page_family(uint32_t buff_class){
+
+    char struct_name[MM_MAX_STRUCT_NAME];
+    mm_buff_cache_t *buff_cache;
+    vm_page_family_t *vm_page_family = gb_buff_page_families[buff_class];
+
+    if(vm_page_family)
+        return vm_page_family;
+
+    if(buff_class == MM_BUFF_NO_OF_CLASSES){
+        snprintf(struct_name, sizeof(struct_name), "%slarge",
+            MM_BUFF_FAMILY_PREFIX);
+    }
+    else{
+        snprintf(struct_name, sizeof(struct_name), "%s%u",
+            MM_BUFF_FAMILY_PREFIX, mm_buff_class_sizes[buff_class]);
+    }
+
+    vm_page_family = lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family){
+        if(buff_class == MM_BUFF_NO_OF_CLASSES){
+            vm_page_family = mm_instantiate_page_family(struct_name,
+                MM_BUFF_MAX_CLASS_SIZE + MM_BUFF_GRANULE,
+                MM_MAX_SYS_PAGES_PER_VM_PAGE, NULL);
+        }
+        else{
+            vm_page_family = mm_instantiate_page_family(struct_name,
+                mm_buff_class_sizes[buff_class],
+                mm_compute_optimal_vm_page_units(
+                    mm_buff_class_sizes[buff_class]), NULL);
+        }
+    }
+
+    if(vm_page_family && buff_class < MM_BUFF_NO_OF_CLASSES){
+
+        buff_cache = &gb_buff_caches[buff_class];
+        init_glthread(&buff_cache->buff_list_head);
+        buff_cache->no_of_buffs = 0;
+        buff_cache->max_buffs =
+            MM_BUFF_CACHE_MAX_BYTES / mm_buff_class_sizes[buff_class];
+        vm_page_family->buff_cache = buff_cache;
+    }
+
+    gb_buff_page_families[buff_class] = vm_page_family;
+    return vm_page_family;
+}
+
+static inline vm_bool_t
+mm_buff_cache_push(vm_page_family_t *vm_page_family,
+                   block_meta_data_t *block_meta_data){
+
+    mm_buff_cache_t *buff_cache = vm_page_family->buff_cache;
+
+    if(buff_cache->no_of_buffs == buff_cache->max_buffs)
+        return MM_FALSE;
+
+    glthread_add_next(&buff_cache->buff_list_head,
+        &block_meta_data->priority_thread_glue);
+    buff_cache->no_of_buffs++;
+    MM_COUNTER_ADD(vm_page_family->no_of_idle_blocks, 1);
+    /*Cached buffers stay in use, only the cumulative counters see the free*/
+    MM_COUNTER_ADD(vm_page_family->no_of_deallocations, 1);
+    return MM_TRUE;
+}
+
+static inline block_meta_data_t *
+mm_buff_cache_pop(uint32_t buff_class){
+
+    vm_page_family_t *vm_page_family = gb_buff_page_families[buff_class];
+    glthread_t *glue = gb_buff_caches[buff_class].buff_list_head.right;
+
+    if(!glue)
+        return NULL;
+
+    remove_glthread(glue);
+    gb_buff_caches[buff_class].no_of_buffs--;
+    MM_COUNTER_SUB(vm_page_family->no_of_idle_blocks, 1);
+    MM_COUNTER_ADD(vm_page_family->no_of_allocations, 1);
+    MM_COUNTER_ADD(vm_page_family->total_memory_allocated,
+        mm_buff_class_sizes[buff_class]);
+    return glthread_to_block_meta_data(glue);
+}
+
+/*Buffers of the cache go away with the VM pages of the family*/
+static void
+mm_buff_cache_drop(vm_page_family_t *vm_page_family){
+
+    mm_buff_cache_t *buff_cache = vm_page_family->buff_cache;
+
+    if(!buff_cache)
+        return;
+
+    init_glthread(&buff_cache->buff_list_head);
+    buff_cache->no_of_buffs = 0;
+}
+
+/*Keep the cached buffer families in sync with mm_family_destroy()*/
+static void
+mm_buff_page_family_relocated(vm_page_family_t *vm_page_family,
+                              vm_page_family_t *new_vm_page_family){
+
+    uint32_t buff_class;
+
+    for(buff_class = 0; buff_class <= MM_BUFF_NO_OF_CLASSES; buff_class++){
+        if(gb_buff_page_families[buff_class] == vm_page_family)
+            gb_buff_page_families[buff_class] = new_vm_page_family;
+    }
+}
+
+uint32_t
+mm_get_buff_max_size(){
+
+    return MAX_PAGE_ALLOCATABLE_MEMORY(MM_MAX_SYS_PAGES_PER_VM_PAGE);
+}
+
+void *
+xcalloc_buff(uint32_t bytes){
+
+    void *result = NULL;
+    uint32_t buff_class, size;
+    vm_page_family_t *pg_family;
+    block_meta_data_t *block_meta_data;
+
+    MM_LATENCY_START(alloc_start_ts);
+
+    /*Rounding up must not wrap around*/
+    if(bytes > mm_get_buff_max_size()){
+        printf("Error : %s() Buffer of %u bytes exceeds max buffer size\n",
+            __FUNCTION__, bytes);
+        return NULL;
+    }
+
+    if(bytes <= MM_BUFF_MAX_CLASS_SIZE){
+        buff_class = mm_buff_class_index[
+            (bytes + MM_BUFF_GRANULE - 1) / MM_BUFF_GRANULE];
+        size = mm_buff_class_sizes[buff_class];
+    }
+    else{
+        buff_class = MM_BUFF_NO_OF_CLASSES;
+        size = (bytes + MM_BUFF_GRANULE - 1) & ~(MM_BUFF_GRANULE - 1);
+    }
+
+    pg_family = mm_get_buff_page_family(buff_class);
+
+    if(!pg_family)
+        return NULL;
+
+    if(buff_class < MM_BUFF_NO_OF_CLASSES &&
+        (block_meta_data = mm_buff_cache_pop(buff_class))){
+
+        result = (void *)(block_meta_data + 1);
+        memset(result, 0, size);
+    }
+    else{
+        result = mm_xcalloc(pg_family, size);
+    }
+
+    MM_TRACE_EVENT(pg_family, MM_TRACE_OP_ALLOC, result,
+        result ? MM_GET_PAGE_FROM_META_BLOCK(
+            ((block_meta_data_t *)result - 1)) : NULL, size);
+
+    MM_LATENCY_RECORD(pg_family, MM_LATENCY_OP_ALLOC, alloc_start_ts);
+    return result;
+}
+
+mm_handle_t
+xcalloc_movable(char *struct_name, int units){
+
+    mm_handle_t handle;
+    block_meta_data_t *block_meta_data;
+    void *app_data = xcalloc(struct_name, units);
+
+    if(!app_data)
+        return MM_HANDLE_NULL;
+
+    handle = mm_handle_get(app_data);
+
+    if(handle == MM_HANDLE_NULL){
+        printf("Error : Handle Table of Movable Objects is Full\n");
+        xfree(app_data);
+        return MM_HANDLE_NULL;
+    }
+
+    block_meta_data = (block_meta_data_t *)app_data - 1;
+    block_meta_data->handle = handle;
+    MM_GET_PAGE_FROM_META_BLOCK(block_meta_data)->no_of_pinned_blocks--;
+    MM_COUNTER_ADD(MM_GET_PAGE_FROM_META_BLOCK(block_meta_data)->\
+        pg_family->no_of_movable_blocks, 1);
+    return handle;
+}
+
+static void
+mm_union_free_blocks(block_meta_data_t *first,
+        block_meta_data_t *second){
+
+    assert(first->is_free == MM_TRUE &&
+        second->is_free == MM_TRUE);
+
+    vm_page_family_t *vm_page_family = 
+        MM_GET_PAGE_FROM_META_BLOCK(first)->pg_family;
+
+    mm_remove_free_block_meta_data_from_free_block_list(
+            vm_page_family, first);
+    mm_remove_free_block_meta_data_from_free_block_list(
+            vm_page_family, second);
+    first->block_size += sizeof(block_meta_data_t) +
+            second->block_size;
+    mm_bind_blocks_for_deallocation(first, second);
+}
+
+static void
+mm_return_vm_page_to_heap_segment(vm_page_t *vm_page){
+
+    MARK_VM_PAGE_EMPTY(vm_page);
+    vm_page->pg_family = NULL;
+
+#ifdef MM_MMAP_PAGE_SOURCE
+    munmap((void *)vm_page, vm_page->page_size);
+#else
+
+    /* If this VM page is the top-most page of Heap Memory
+     * Segment, then lower down the heap memory segment.
+     * Note that, once you lower down the heap memory segment
+     * this page shall be out of allotted valid virtual address 
+     * of a process, and any access to it shall result in
+     * segmentation fault*/
+    /* Also note that, if the VM page is the top-most page of Heap Memory
+     * then it could be possible there are free contiguous pages below
+     * this VM page. We need to lowered down break pointer freeing all
+     * contiguous VM pages lying below this VM page*/
+    if(vm_page != gb_heap_top_vm_page ||
+        (void *)vm_page != 
+            (void *)((char *)sbrk(0) - vm_page->page_size)){
+        if(IS_GLTHREAD_LIST_EMPTY(&vm_page->occupancy_glue)){
+            glthread_add_next(
+                &gb_free_heap_vm_pages[vm_page->page_size / GB_SYSTEM_PAGE_SIZE],
+                &vm_page->occupancy_glue);
+        }
+        return;
+    }
+
+    vm_page_t *vm_page_curr = NULL;
+    vm_page_t *bottom_most_free_page = NULL;
+
+    ITERATE_HEAP_SEGMENT_PAGE_WISE_BEGIN(vm_page, vm_page_curr){
+
+        if(!mm_is_vm_page_free_in_heap_segment(vm_page_curr))
+            break;
+        remove_glthread(&vm_page_curr->occupancy_glue);
+        bottom_most_free_page = vm_page_curr;
+    } ITERATE_HEAP_SEGMENT_PAGE_WISE_END(vm_page, vm_page_curr);
+
+#if 0
+    printf("No of Contiguous Bytes to be freed from Heap Segment = %lu\n",
+        (unsigned long)sbrk(0) - (unsigned long)bottom_most_free_page);
+#endif
+    gb_heap_top_vm_page = 
+        MM_GET_PREV_PAGE_IN_HEAP_SEGMENT(bottom_most_free_page);
+
+    /*Now lower down the break pointer*/
+    assert(!brk((void *)bottom_most_free_page));
+#endif
+}
+
+void
+mm_vm_page_delete_and_free(
+        vm_page_t *vm_page){
+
+    MM_LATENCY_START(page_release_start_ts);
+
+    vm_page_family_t *vm_page_family = 
+        vm_page->pg_family;
+
+    assert(vm_page_family->first_page);
+
+    if(vm_page->occupancy == MM_PAGE_OCCUPANCY_EMPTY)
+        MM_COUNTER_SUB(vm_page_family->no_of_reserved_vm_pages, 1);
+    remove_glthread(&vm_page->occupancy_glue);
+    MM_COUNTER_SUB(vm_page_family->no_of_vm_pages, 1);
+    if(!MM_FAMILY_IS_SHARED(vm_page_family))
+        MM_COUNTER_SUB(gb_vm_page_memory, vm_page->page_size);
+
+    if(vm_page_family->first_page == vm_page){
+        vm_page_family->first_page = vm_page->next;
+        if(vm_page->next)
+            vm_page->next->prev = NULL;
+    }
+    else{
+        if(vm_page->next)
+            vm_page->next->prev = vm_page->prev;
+        vm_page->prev->next = vm_page->next;
+    }
+    MM_COUNTER_ADD(vm_page_family->no_of_system_calls_to_alloc_dealloc_vm_pages, 1);
+    MM_TRACE_EVENT(vm_page_family, MM_TRACE_OP_PAGE_RELEASE,
+        vm_page, vm_page, vm_page->page_size);
+    if(vm_page_family->page_source){
+        MARK_VM_PAGE_EMPTY(vm_page);
+        gb_page_source_ops->put_vm_page(vm_page_family->page_source, vm_page);
+    }
+    else{
+        mm_return_vm_page_to_heap_segment(vm_page);
+    }
+    MM_LATENCY_RECORD(vm_page_family, MM_LATENCY_OP_PAGE_RELEASE,
+        page_release_start_ts);
+}
+
+static block_meta_data_t *
+mm_free_blocks(block_meta_data_t *to_be_free_block){
+
+    block_meta_data_t *return_block = NULL;
+
+    assert(to_be_free_block->is_free == MM_FALSE);
+    
+    vm_page_t *hosting_page = 
+        MM_GET_PAGE_FROM_META_BLOCK(to_be_free_block);
+
+    vm_page_family_t *vm_page_family = hosting_page->pg_family;
+
+    MM_COUNTER_SUB(vm_page_family->total_memory_in_use_by_app,
+        sizeof(block_meta_data_t) + to_be_free_block->block_size);
+    if(!MM_FAMILY_IS_SHARED(vm_page_family)){
+        MM_COUNTER_SUB(gb_memory_in_use_by_app,
+            sizeof(block_meta_data_t) + to_be_free_block->block_size);
+    }
+    MM_COUNTER_SUB(vm_page_family->no_of_allocated_blocks, 1);
+    MM_COUNTER_ADD(vm_page_family->no_of_deallocations, 1);
+    hosting_page->bytes_in_use -=
+        sizeof(block_meta_data_t) + to_be_free_block->block_size;
+    if(to_be_free_block->handle == MM_HANDLE_NULL)
+        hosting_page->no_of_pinned_blocks--;
+    
+    to_be_free_block->is_free = MM_TRUE;
+    
+    return_block = to_be_free_block;
+
+    block_meta_data_t *next_block = NEXT_META_BLOCK(to_be_free_block);
+
+    if(next_block && next_block->is_free == MM_TRUE){
+        /*Union two free blocks*/
+        mm_union_free_blocks(to_be_free_block, next_block);
+        return_block = to_be_free_block;
+    }
+    /*Check the previous block if it was free*/
+    block_meta_data_t *prev_block = PREV_META_BLOCK(to_be_free_block);
+    
+    if(prev_block && prev_block->is_free){
+        mm_union_free_blocks(prev_block, to_be_free_block);
+        return_block = prev_block;
+    }
+    
+    if(mm_is_vm_page_empty(hosting_page)){
+        mm_vm_page_delete_and_free(hosting_page);
+        return NULL;
+    }
+    mm_add_free_block_meta_data_to_free_block_list(
+            hosting_page->pg_family, return_block);
+
+    /*Coalescing only grows free blocks*/
+    if(return_block->block_size > hosting_page->largest_free_block)
+        hosting_page->largest_free_block = return_block->block_size;
+    mm_vm_page_update_occupancy(hosting_page);
+    
+    return return_block;
+}
+
+void
+xfree(void *app_data){
+
+    MM_LATENCY_START(free_start_ts);
+
+    block_meta_data_t *block_meta_data = 
+        (block_meta_data_t *)((char *)app_data - sizeof(block_meta_data_t));
+    /*Hosting page may be returned to kernel, remember the family*/
+    vm_page_family_t *vm_page_family = 
+        MM_GET_PAGE_FROM_META_BLOCK(block_meta_data)->pg_family;
+   
+    MM_FAMILY_LOCK(vm_page_family);
+
+    /*An allocated block is queued only while cached or deferred*/
+    if(block_meta_data->is_free == MM_TRUE ||
+        !IS_GLTHREAD_LIST_EMPTY(&block_meta_data->priority_thread_glue)){
+        printf("!Double Free detected\n");
+        assert(0);
+    }
+    if(block_meta_data->handle != MM_HANDLE_NULL){
+        mm_handle_put(block_meta_data->handle);
+        MM_COUNTER_SUB(MM_GET_PAGE_FROM_META_BLOCK(block_meta_data)->\
+            pg_family->no_of_movable_blocks, 1);
+    }
+    MM_TRACE_EVENT(vm_page_family, MM_TRACE_OP_FREE, app_data,
+        MM_GET_PAGE_FROM_META_BLOCK(block_meta_data),
+        block_meta_data->block_size);
+    if(!vm_page_family->buff_cache ||
+        !mm_buff_cache_push(vm_page_family, block_meta_data)){
+        mm_free_blocks(block_meta_data);
+    }
+    MM_FAMILY_UNLOCK(vm_page_family);
+    MM_LATENCY_RECORD(vm_page_family, MM_LATENCY_OP_FREE, free_start_ts);
+}
+
+/* Release the blocks of one VM page handed to xfree_bulk(), in address
+ * order. A block freed next to the block coalesced last joins it, and
+ * the coalesced block is queued in the free block list only once no more
+ * block of the batch joins it, so that a run of blocks freed together
+ * costs one update of the free block list rather than one per block*/
+static void
+mm_free_blocks_of_vm_page(vm_page_t *vm_page, void **objs, int count){
+
+    int i;
+    uint64_t bytes_freed = 0;
+    vm_page_family_t *vm_page_family = vm_page->pg_family;
+    block_meta_data_t *block_meta_data, *coalesced_block = NULL;
+
+    for(i = 0; i < count; i++){
+
+        block_meta_data = (block_meta_data_t *)objs[i] - 1;
+
+        /*An allocated block is queued only while cached or deferred*/
+        if(block_meta_data->is_free == MM_TRUE ||
+            !IS_GLTHREAD_LIST_EMPTY(&block_meta_data->priority_thread_glue)){
+            printf("!Double Free detected\n");
+            assert(0);
+        }
+        if(block_meta_data->handle != MM_HANDLE_NULL){
+            mm_handle_put(block_meta_data->handle);
+            MM_COUNTER_SUB(vm_page_family->no_of_movable_blocks, 1);
+        }
+        else{
+            vm_page->no_of_pinned_blocks--;
+        }
+        MM_TRACE_EVENT(vm_page_family, MM_TRACE_OP_FREE, objs[i], vm_page,
+            block_meta_data->block_size);
+        bytes_freed += sizeof(block_meta_data_t) + block_meta_data->block_size;
+        block_meta_data->is_free = MM_TRUE;
+        init_glthread(&block_meta_data->priority_thread_glue);
+
+        if(coalesced_block && block_meta_data->prev_block != coalesced_block){
+            mm_add_free_block_meta_data_to_free_block_list(vm_page_family,
+                coalesced_block);
+            if(coalesced_block->block_size > vm_page->largest_free_block)
+                vm_page->largest_free_block = coalesced_block->block_size;
+        }
+
+        if(block_meta_data->prev_block &&
+            block_meta_data->prev_block->is_free == MM_TRUE){
+            coalesced_block = block_meta_data->prev_block;
+            mm_union_free_blocks(coalesced_block, block_meta_data);
+        }
+        else{
+            coalesced_block = block_meta_data;
+        }
+
+        /*Blocks of the batch further up are not free yet*/
+        if(coalesced_block->next_block &&
+            coalesced_block->next_block->is_free == MM_TRUE){
+            mm_union_free_blocks(coalesced_block, coalesced_block->next_block);
+        }
+    }
+
+    MM_COUNTER_SUB(vm_page_family->total_memory_in_use_by_app, bytes_freed);
+    if(!MM_FAMILY_IS_SHARED(vm_page_family))
+        MM_COUNTER_SUB(gb_memory_in_use_by_app, bytes_freed);
+    MM_COUNTER_SUB(vm_page_family->no_of_allocated_blocks, count);
+    MM_COUNTER_ADD(vm_page_family->no_of_deallocations, count);
+    vm_page->bytes_in_use -= bytes_freed;
+
+    if(mm_is_vm_page_empty(vm_page)){
+        mm_vm_page_delete_and_free(vm_page);
+        return;
+    }
+
+    mm_add_free_block_meta_data_to_free_block_list(vm_page_family,
+        coalesced_block);
+    if(coalesced_block->block_size > vm_page->largest_free_block)
+        vm_page->largest_free_block = coalesced_block->block_size;
+    mm_vm_page_update_occupancy(vm_page);
+}
+
+static int
+mm_addr_comparison_function(const void *addr1, const void *addr2){
+
+    uintptr_t a1 = (uintptr_t)*(void * const *)addr1;
+    uintptr_t a2 = (uintptr_t)*(void * const *)addr2;
+
+    return a1 < a2 ? -1 : a1 > a2 ? 1 : 0;
+}
+
+/* Objects are sorted by address, which groups them by VM page, and every
+ * VM page is released in one go*/
+void
+xfree_bulk(void **objs, int count){
+
+    int i, j;
+    vm_page_t *vm_page;
+    vm_page_family_t *vm_page_family;
+
+    if(count <= 0)
+        return;
+
+    qsort(objs, count, sizeof(void *), mm_addr_comparison_function);
+
+    /*Objects of a VM page are of one family, latency is recorded per VM page*/
+    for(i = 0; i < count; i = j){
+
+        MM_LATENCY_START(free_start_ts);
+
+        vm_page = MM_GET_PAGE_FROM_META_BLOCK(((block_meta_data_t *)objs[i] - 1));
+
+        for(j = i + 1; j < count &&
+            MM_GET_PAGE_FROM_META_BLOCK(((block_meta_data_t *)objs[j] - 1)) ==
+                vm_page; j++);
+
+        /*VM page may be returned to kernel, remember the family*/
+        vm_page_family = vm_page->pg_family;
+        MM_FAMILY_LOCK(vm_page_family);
+        mm_free_blocks_of_vm_page(vm_page, objs + i, j - i);
+        MM_FAMILY_UNLOCK(vm_page_family);
+        MM_LATENCY_RECORD(vm_page_family, MM_LATENCY_OP_FREE, free_start_ts);
+    }
+}
+
+void
+xfree_movable(mm_handle_t handle){
+
+    void *app_data = mm_handle_deref(handle);
+
+    if(!app_data){
+        printf("!Free of unused handle %u detected\n", handle);
+        assert(0);
+    }
+    xfree(app_data);
+}
+
+/* Family can not have fewer VM pages than what is needed to hold the
+ * memory in use by application with zero fragmentation*/
+static vm_bool_t
+mm_is_page_family_compact(vm_page_family_t *vm_page_family){
+
+    uint64_t vm_page_capacity = 
+        MAX_PAGE_ALLOCATABLE_MEMORY(vm_page_family->vm_page_units) +
+        sizeof(block_meta_data_t);
+
+    uint64_t min_no_of_vm_pages = 
+        (MM_COUNTER_READ(vm_page_family->total_memory_in_use_by_app) +
+         vm_page_capacity - 1) / vm_page_capacity;
+
+    return MM_COUNTER_READ(vm_page_family->no_of_vm_pages) <= min_no_of_vm_pages ?
+        MM_TRUE : MM_FALSE;
+}
+
+/* Least occupied partial VM page of the family holding movable blocks
+ * only, NULL if there is none. Occupancy classes are ordered by
+ * bytes_in_use, so the first class having such a page has the sparsest*/
+static vm_page_t *
+mm_get_vm_page_to_evacuate(vm_page_family_t *vm_page_family){
+
+    int occupancy;
+    glthread_t *curr;
+    vm_page_t *vm_page, *chosen_vm_page;
+
+    for(occupancy = MM_PAGE_OCCUPANCY_PARTIAL;
+        occupancy < MM_PAGE_OCCUPANCY_FULL;
+        occupancy++){
+
+        chosen_vm_page = NULL;
+
+        ITERATE_GLTHREAD_BEGIN(
+            &vm_page_family->page_occupancy_list_head[occupancy], curr){
+
+            vm_page = glthread_to_vm_page(curr);
+
+            if(vm_page->no_of_pinned_blocks)
+                continue;
+
+            if(!chosen_vm_page ||
+                vm_page->bytes_in_use < chosen_vm_page->bytes_in_use){
+                chosen_vm_page = vm_page;
+            }
+        } ITERATE_GLTHREAD_END(
+            &vm_page_family->page_occupancy_list_head[occupancy], curr);
+
+        if(chosen_vm_page)
+            return chosen_vm_page;
+    }
+    return NULL;
+}
+
+/* Move the allocated movable block into free_block lying on another VM
+ * page and point its handle to the new location. Return TRUE if the VM
+ * page which hosted the block became empty and got released*/
+static vm_bool_t
+mm_move_block(vm_page_family_t *vm_page_family,
+              block_meta_data_t *block_meta_data,
+              block_meta_data_t *free_block){
+
+    uint32_t size = block_meta_data->block_size;
+    vm_page_t *new_hosting_page = MM_GET_PAGE_FROM_META_BLOCK(free_block);
+
+    mm_allocate_free_block(vm_page_family, free_block, size);
+    memcpy((char *)(free_block + 1), (char *)(block_meta_data + 1), size);
+
+    free_block->handle = block_meta_data->handle;
+    new_hosting_page->no_of_pinned_blocks--;
+    mm_handle_entry(free_block->handle)->app_data = (void *)(free_block + 1);
+
+    MM_TRACE_EVENT(vm_page_family, MM_TRACE_OP_ALLOC, free_block + 1,
+        new_hosting_page, size);
+    MM_TRACE_EVENT(vm_page_family, MM_TRACE_OP_FREE, block_meta_data + 1,
+        MM_GET_PAGE_FROM_META_BLOCK(block_meta_data), size);
+
+    /*A move is neither an allocation nor a de-allocation by application*/
+    MM_COUNTER_SUB(vm_page_family->no_of_allocations, 1);
+    MM_COUNTER_SUB(vm_page_family->total_memory_allocated, size);
+    MM_COUNTER_SUB(vm_page_family->no_of_deallocations, 1);
+
+    return mm_free_blocks(block_meta_data) ? MM_FALSE : MM_TRUE;
+}
+
+int
+mm_compact_step(char *struct_name, uint32_t max_bytes,
+                mm_compaction_stats_t *stats){
+
+    vm_page_t *vm_page = NULL;
+    block_meta_data_t *block_meta_data, *free_block;
+    mm_compaction_stats_t step_stats;
+
+    vm_page_family_t *vm_page_family = 
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family)
+        return -1;
+
+    /*Handles are per process, other processes would keep the old addresses*/
+    if(MM_FAMILY_IS_SHARED(vm_page_family)){
+        printf("Error : %s() Family %s is shared with other processes\n",
+            __FUNCTION__, struct_name);
+        return -1;
+    }
+
+    memset(&step_stats, 0, sizeof(mm_compaction_stats_t));
+
+    if(!vm_page_family->compaction_in_progress){
+        vm_page_family->compaction_in_progress = MM_TRUE;
+        MM_COUNTER_SET(vm_page_family->pass_pages_reclaimed, 0);
+    }
+
+    while(!step_stats.bytes_moved || step_stats.bytes_moved < max_bytes){
+
+        if(!vm_page){
+
+            if(!mm_is_page_family_compact(vm_page_family))
+                vm_page = mm_get_vm_page_to_evacuate(vm_page_family);
+
+            if(!vm_page){
+                step_stats.pass_complete = 1;
+                break;
+            }
+        }
+
+        /*Evacuate the blocks of the page top to bottom*/
+        ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page, block_meta_data){
+
+            if(block_meta_data->is_free == MM_FALSE)
+                break;
+        } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page, block_meta_data);
+
+        assert(block_meta_data && block_meta_data->handle != MM_HANDLE_NULL);
+
+        free_block = mm_get_free_block_from_fullest_page(vm_page_family,
+                        block_meta_data->block_size, vm_page);
+
+        /*Rest of the pages are too full to take the page's blocks*/
+        if(!free_block){
+            step_stats.pass_complete = 1;
+            break;
+        }
+
+        step_stats.blocks_moved++;
+        step_stats.bytes_moved += 
+            sizeof(block_meta_data_t) + block_meta_data->block_size;
+
+        if(mm_move_block(vm_page_family, block_meta_data, free_block)){
+            step_stats.pages_reclaimed++;
+            vm_page = NULL;
+        }
+    }
+
+    MM_COUNTER_ADD(vm_page_family->compaction_bytes_moved,
+        step_stats.bytes_moved);
+    MM_COUNTER_ADD(vm_page_family->compaction_pages_reclaimed,
+        step_stats.pages_reclaimed);
+    step_stats.pass_pages_reclaimed = 
+        MM_COUNTER_ADD(vm_page_family->pass_pages_reclaimed,
+            step_stats.pages_reclaimed);
+
+    if(step_stats.pass_complete){
+        vm_page_family->compaction_in_progress = MM_FALSE;
+        MM_COUNTER_ADD(vm_page_family->no_of_compaction_passes, 1);
+        MM_COUNTER_SET(vm_page_family->last_pass_pages_reclaimed,
+            step_stats.pass_pages_reclaimed);
+    }
 
-    assert(block_meta_data->is_free == MM_TRUE);
+    if(stats)
+        *stats = step_stats;
 
-    assert(block_meta_data->block_size >= size);
+    return step_stats.pass_complete ? 0 : 1;
+}
 
-    uint32_t remaining_size = 
-            block_meta_data->block_size - size;
+int
+mm_compact(char *struct_name){
 
-    block_meta_data->is_free = MM_FALSE;
-    block_meta_data->block_size = size;
- 
-    /*Unchanged*/
-    //block_meta_data->offset =  ??
-    
-    /* Since this block of memory is not allocated, remove it from
-     * priority list of free blocks*/
-    remove_glthread(&block_meta_data->priority_thread_glue);
+    int rc;
+    mm_compaction_stats_t stats;
 
-    vm_page_family->total_memory_in_use_by_app += 
-        sizeof(block_meta_data_t) + size;
-    /* No need to do anything else if this block is completely used
-     * to satisfy memory request*/
-    if(!remaining_size)
-        return MM_TRUE;
+    do{
+        rc = mm_compact_step(struct_name, UINT32_MAX, &stats);
+    } while(rc == 1);
 
-    /* If the remaining memory chunk in this free block is unusable
-     * because of fragmentation - however this should not be possible
-     * except the boundry condition*/
-    if(remaining_size < 
-        (sizeof(block_meta_data_t) + vm_page_family->struct_size)){
-        /*printf("Warning : %uB Memory Unusable at page bottom\n", 
-            remaining_size);*/
-        return MM_TRUE;
+    return rc < 0 ? -1 : (int)stats.pass_pages_reclaimed;
+}
+
+/* Arenas and object caches reset and destroy their own families
+ * through these, the by name versions refuse their families*/
+int
+mm_vm_page_family_reset(vm_page_family_t *vm_page_family){
+
+    vm_page_t *vm_page;
+    block_meta_data_t *block_meta_data;
+    mm_counter_t no_of_allocated_blocks, memory_in_use;
+
+    /* Limbo lists of the threads would keep the deferred objects linked
+     * into the released VM pages*/
+    if(MM_COUNTER_READ(vm_page_family->no_of_deferred_blocks)){
+        printf("Error : %s() Family %s has objects deferred by "
+            "xfree_deferred(), call mm_epoch_barrier() first\n",
+            __FUNCTION__, vm_page_family->struct_name);
+        return -1;
     }
 
-    block_meta_data_t *next_block_meta_data = NULL;
+    MM_FAMILY_LOCK(vm_page_family);
 
-    next_block_meta_data = NEXT_META_BLOCK_BY_SIZE(block_meta_data);
+    no_of_allocated_blocks = 
+        MM_COUNTER_READ(vm_page_family->no_of_allocated_blocks);
+    memory_in_use = 
+        MM_COUNTER_READ(vm_page_family->total_memory_in_use_by_app);
 
-    next_block_meta_data->is_free = MM_TRUE;
+    MM_TRACE_EVENT(vm_page_family, MM_TRACE_OP_FAMILY_RESET, NULL, NULL,
+        (uint32_t)no_of_allocated_blocks);
+    mm_buff_cache_drop(vm_page_family);
 
-    next_block_meta_data->block_size = 
-        remaining_size - sizeof(block_meta_data_t);
+    ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family, vm_page){
 
-    next_block_meta_data->offset = block_meta_data->offset + 
-        sizeof(block_meta_data_t) + block_meta_data->block_size;
+        /*Only the pages of families having movable objects are walked*/
+        if(MM_COUNTER_READ(vm_page_family->no_of_movable_blocks)){
 
-    init_glthread(&next_block_meta_data->priority_thread_glue); 
-    
-    mm_bind_blocks_for_allocation(block_meta_data, next_block_meta_data);
-    
-    mm_add_free_block_meta_data_to_free_block_list(
-            vm_page_family, next_block_meta_data);
+            ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page, block_meta_data){
 
-    return MM_TRUE;
-}
+                if(block_meta_data->is_free == MM_FALSE &&
+                    block_meta_data->handle != MM_HANDLE_NULL){
+                    mm_handle_put(block_meta_data->handle);
+                    MM_COUNTER_SUB(vm_page_family->no_of_movable_blocks, 1);
+                }
+            } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page, block_meta_data);
+        }
+        mm_vm_page_delete_and_free(vm_page);
 
-static vm_page_t *
-mm_get_page_satisfying_request(
-        vm_page_family_t *vm_page_family,
-        uint32_t req_size, 
-        block_meta_data_t **block_meta_data/*O/P*/){
+    } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family, vm_page);
 
-    vm_bool_t status = MM_FALSE;
-    vm_page_t *vm_page = NULL;
+    /* Free blocks of the released pages are dropped all together rather
+     * than unlinked one by one*/
+    init_glthread(&vm_page_family->free_block_priority_list_head);
+    MM_COUNTER_SET(vm_page_family->no_of_free_blocks, 0);
+    MM_COUNTER_SET(vm_page_family->total_free_memory, 0);
+    MM_COUNTER_SET(vm_page_family->no_of_allocated_blocks, 0);
+    MM_COUNTER_SET(vm_page_family->no_of_idle_blocks, 0);
+    MM_COUNTER_SET(vm_page_family->total_memory_in_use_by_app, 0);
+    if(!MM_FAMILY_IS_SHARED(vm_page_family))
+        MM_COUNTER_SUB(gb_memory_in_use_by_app, memory_in_use);
+    MM_COUNTER_ADD(vm_page_family->no_of_deallocations, no_of_allocated_blocks);
+    MM_FAMILY_UNLOCK(vm_page_family);
+
+    /* Pages are released in page index order, not address order, the
+     * empty pages left below the top most one are trimmed now*/
+    if(gb_heap_top_vm_page &&
+        mm_is_vm_page_free_in_heap_segment(gb_heap_top_vm_page)){
+        mm_return_vm_page_to_heap_segment(gb_heap_top_vm_page);
+    }
 
-    block_meta_data_t *biggest_block_meta_data = 
-        mm_get_biggest_free_block_page_family(vm_page_family); 
+    return 0;
+}
 
-    if(!biggest_block_meta_data || 
-        biggest_block_meta_data->block_size < req_size){
+/*Arena or object cache would keep pointers into the released VM pages*/
+static vm_bool_t
+mm_is_page_family_owned(vm_page_family_t *vm_page_family,
+                        const char *caller){
 
-        /*Time to add a new page to Page family to satisfy the request*/
-        vm_page = mm_family_new_page_add(vm_page_family);
-        /*Allocate the free block from this page now*/
-        status = mm_allocate_free_block(vm_page_family, 
-                    &vm_page->block_meta_data, req_size);
+    if(!vm_page_family->owner)
+        return MM_FALSE;
 
-        if(status == MM_FALSE){
-            *block_meta_data = NULL;
-             mm_vm_page_delete_and_free(vm_page);
-             return NULL;
-        }
+    printf("Error : %s() Family %s belongs to an arena or an object cache\n",
+        caller, vm_page_family->struct_name);
+    return MM_TRUE;
+}
 
-        *block_meta_data = &vm_page->block_meta_data;
-        return vm_page;
-    }
-    /*The biggest block meta data can satisfy the request*/
-    status = mm_allocate_free_block(vm_page_family, 
-        biggest_block_meta_data, req_size);
-        
-    if(status == MM_FALSE){
-        *block_meta_data = NULL;
-        return NULL;
+int
+mm_family_reset(char *struct_name){
+
+    vm_page_family_t *vm_page_family = 
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family ||
+        mm_is_page_family_owned(vm_page_family, __FUNCTION__)){
+        return -1;
     }
 
-    *block_meta_data = biggest_block_meta_data;
+    /* Arena, object cache and deferred families are refused above and by
+     * mm_vm_page_family_reset(), the pressure callback as well. The family
+     * acquiring a VM page goes on with its free blocks and limits after
+     * the callback*/
+    if(gb_pressure_cb_running &&
+        vm_page_family == gb_pressure_vm_page_family){
+        printf("Error : %s() Family %s is under pressure, it can not be "
+            "reset by the pressure callback\n", __FUNCTION__,
+            vm_page_family->struct_name);
+        return -1;
+    }
 
-    return MM_GET_PAGE_FROM_META_BLOCK(biggest_block_meta_data);
+    return mm_vm_page_family_reset(vm_page_family);
 }
 
-/* The public fn to be invoked by the application for Dynamic 
- * Memory Allocations.*/
-void *
-xcalloc(char *struct_name, int units){
+/* Move the page family to a new slot, VM pages and list heads of the
+ * family point back to it*/
+static void
+mm_relocate_page_family(vm_page_family_t *new_vm_page_family,
+                        vm_page_family_t *vm_page_family){
 
-    void *result = NULL;
+    uint32_t i;
+    vm_page_t *vm_page;
 
-    vm_page_family_t *pg_family = 
-        lookup_page_family_by_name(struct_name);
+    memcpy(new_vm_page_family, vm_page_family, sizeof(vm_page_family_t));
 
-    if(!pg_family){
-        
-        printf("Error : Structure %s not registered with Memory Manager\n",
-            struct_name);
-        return NULL;
+    mm_family_handle_table_set(new_vm_page_family->family_id,
+        new_vm_page_family);
+
+    ITERATE_VM_PAGE_PER_FAMILY_BEGIN(new_vm_page_family, vm_page){
+
+        vm_page->pg_family = new_vm_page_family;
+    } ITERATE_VM_PAGE_PER_FAMILY_END(new_vm_page_family, vm_page);
+
+    if(new_vm_page_family->free_block_priority_list_head.right){
+        new_vm_page_family->free_block_priority_list_head.right->left =
+            &new_vm_page_family->free_block_priority_list_head;
     }
-    
-    if(units * pg_family->struct_size > MAX_PAGE_ALLOCATABLE_MEMORY){
-        
-        printf("Error : Memory Requested Exceeds Page Size\n");
-        return NULL;
+
+    for(i = 0; i < MM_PAGE_OCCUPANCY_MAX; i++){
+        if(new_vm_page_family->page_occupancy_list_head[i].right){
+            new_vm_page_family->page_occupancy_list_head[i].right->left =
+                &new_vm_page_family->page_occupancy_list_head[i];
+        }
     }
+}
 
-    if(!pg_family->first_page){
+/* Families are kept packed in the family pages, the last registered
+ * family of the same page source takes over the slot of the destroyed
+ * one. Family ids are not reused, so that traces stay unambiguous*/
+int
+mm_vm_page_family_destroy(vm_page_family_t *vm_page_family){
+
+    vm_page_family_t *last_vm_page_family;
+    vm_page_for_families_t *vm_page_for_families_curr;
+    vm_page_for_families_t *vm_page_for_families_last = NULL;
+
+    /* The family acquiring a VM page could be the one moved into the
+     * slot of the destroyed family*/
+    if(gb_pressure_cb_running){
+        printf("Error : %s() Family %s can not be destroyed by the pressure "
+            "callback\n", __FUNCTION__, vm_page_family->struct_name);
+        return -1;
+    }
 
-        pg_family->first_page = mm_family_new_page_add(pg_family);
+    /*Other processes would keep using the family where it was*/
+    if(MM_FAMILY_IS_SHARED(vm_page_family)){
+        printf("Error : %s() Family %s is shared with other processes\n",
+            __FUNCTION__, vm_page_family->struct_name);
+        return -1;
+    }
 
-        if(mm_allocate_free_block(pg_family, 
-                    &pg_family->first_page->block_meta_data, 
-                    units * pg_family->struct_size)){
-            memset((char *)pg_family->first_page->page_memory, 0,
-                units * pg_family->struct_size);
-            return (void *)pg_family->first_page->page_memory;
-        }
+    if(mm_vm_page_family_reset(vm_page_family) < 0)
+        return -1;
+
+    mm_family_handle_table_set(vm_page_family->family_id, NULL);
+
+    if(vm_page_family->page_source){
+        vm_page_for_families_last =
+            vm_page_family->page_source->vm_page_for_families;
     }
-    
-    /*Find the page which can satisfy the request*/
-    block_meta_data_t *free_block_meta_data;
+    else{
+        for(vm_page_for_families_curr = gb_first_vm_page_for_families;
+            vm_page_for_families_curr;
+            vm_page_for_families_curr = vm_page_for_families_curr->next){
 
-    vm_page_t *vm_page_curr = mm_get_page_satisfying_request(
-                        pg_family, units * pg_family->struct_size,
-                        &free_block_meta_data);
-    
-    if(free_block_meta_data){
-        /*Sanity Checks*/
-        if(free_block_meta_data->is_free == MM_TRUE ||
-                !IS_GLTHREAD_LIST_EMPTY(&free_block_meta_data->priority_thread_glue)){
-            assert(0);
+            if(vm_page_for_families_curr->no_of_families)
+                vm_page_for_families_last = vm_page_for_families_curr;
         }
-        memset((char *)(free_block_meta_data + 1), 0, 
-            free_block_meta_data->block_size);
-        return  (void *)(free_block_meta_data + 1);
     }
 
-    return NULL;
-}
+    last_vm_page_family = &vm_page_for_families_last->vm_page_family[
+        vm_page_for_families_last->no_of_families - 1];
 
-static void
-mm_union_free_blocks(block_meta_data_t *first,
-        block_meta_data_t *second){
+    mm_buff_page_family_relocated(vm_page_family, NULL);
 
-    assert(first->is_free == MM_TRUE &&
-        second->is_free == MM_TRUE);
+    if(vm_page_family != last_vm_page_family){
+        mm_relocate_page_family(vm_page_family, last_vm_page_family);
+        mm_buff_page_family_relocated(last_vm_page_family, vm_page_family);
+    }
 
-    first->block_size += sizeof(block_meta_data_t) +
-            second->block_size;
-    remove_glthread(&first->priority_thread_glue);
-    remove_glthread(&second->priority_thread_glue);
-    mm_bind_blocks_for_deallocation(first, second);
+    memset(last_vm_page_family, 0, sizeof(vm_page_family_t));
+    vm_page_for_families_last->no_of_families--;
+    return 0;
 }
 
-static void
-mm_return_vm_page_to_heap_segment(vm_page_t *vm_page){
+int
+mm_family_destroy(char *struct_name){
 
-    MARK_VM_PAGE_EMPTY(vm_page);
+    vm_page_family_t *vm_page_family = 
+        lookup_page_family_by_name(struct_name);
 
-    /* If this VM page is the top-most page of Heap Memory
-     * Segment, then lower down the heap memory segment.
-     * Note that, once you lower down the heap memory segment
-     * this page shall be out of allotted valid virtual address 
-     * of a process, and any access to it shall result in
-     * segmentation fault*/
-    /* Also note that, if the VM page is the top-most page of Heap Memory
-     * then it could be possible there are free contiguous pages below
-     * this VM page. We need to lowered down break pointer freeing all
-     * contiguous VM pages lying below this VM page*/
-    if((void *)vm_page != 
-            (void *)((char *)sbrk(0) - GB_SYSTEM_PAGE_SIZE)){
-        return;
+    if(!vm_page_family ||
+        mm_is_page_family_owned(vm_page_family, __FUNCTION__)){
+        return -1;
     }
 
-    vm_page_t *bottom_most_free_page = NULL;
+    return mm_vm_page_family_destroy(vm_page_family);
+}
 
-    for(bottom_most_free_page = 
-            MM_GET_NEXT_PAGE_IN_HEAP_SEGMENT(vm_page, '-');
-        mm_is_vm_page_empty(bottom_most_free_page);
-        bottom_most_free_page = 
-            MM_GET_NEXT_PAGE_IN_HEAP_SEGMENT(bottom_most_free_page, '-')){
-        
-        if((void *)bottom_most_free_page == gb_hsba)
-            break;
+int
+mm_attach_page_source(mm_page_source_t *page_source){
+
+    uint32_t i;
+    vm_page_t *vm_page;
+    vm_page_family_t *vm_page_family;
+    mm_counter_t memory_in_use;
+    vm_page_for_families_t *vm_page_for_families =
+        page_source->vm_page_for_families;
+
+    if(gb_no_of_page_sources == MM_MAX_PAGE_SOURCES){
+        printf("Error : %s() Too many page sources\n", __FUNCTION__);
+        return -1;
     }
+    gb_page_sources[gb_no_of_page_sources++] = page_source;
+    vm_page_for_families->page_source = page_source;
+
+    for(i = 0; i < vm_page_for_families->no_of_families; i++){
+
+        vm_page_family = &vm_page_for_families->vm_page_family[i];
+        vm_page_family->page_source = page_source;
+
+        /*Families of a shared heap keep the ids given when registered*/
+        if(MM_FAMILY_IS_SHARED(vm_page_family)){
+            mm_family_handle_table_set(vm_page_family->family_id,
+                vm_page_family);
+            continue;
+        }
+
+        vm_page_family->family_id = gb_no_of_vm_families_registered++;
+        mm_family_handle_table_set(vm_page_family->family_id,
+            vm_page_family);
+
+        memory_in_use = MM_COUNTER_ADD(gb_memory_in_use_by_app,
+            MM_COUNTER_READ(vm_page_family->total_memory_in_use_by_app));
+        MM_COUNTER_UPDATE_PEAK(gb_peak_memory_in_use_by_app, memory_in_use);
 
-    if((void *)bottom_most_free_page != gb_hsba){
-        bottom_most_free_page = 
-            MM_GET_NEXT_PAGE_IN_HEAP_SEGMENT(bottom_most_free_page, '+');
+        ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family, vm_page){
+
+            MM_COUNTER_UPDATE_PEAK(gb_peak_vm_page_memory,
+                MM_COUNTER_ADD(gb_vm_page_memory, vm_page->page_size));
+        } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family, vm_page);
     }
-#if 0
-    printf("No of Contiguous pages to be freed from Heap Segment = %lu\n",
-        (((char *)vm_page - (char *)bottom_most_free_page)/GB_SYSTEM_PAGE_SIZE)+ 1);
-#endif
-    /*Now lower down the break pointer*/
-    assert(!brk((void *)bottom_most_free_page));
+    return 0;
 }
 
+/*Families of the source stay intact in its pages*/
 void
-mm_vm_page_delete_and_free(
-        vm_page_t *vm_page){
+mm_detach_page_source(mm_page_source_t *page_source){
 
-    vm_page_family_t *vm_page_family = 
-        vm_page->pg_family;
+    uint32_t i;
+    vm_page_t *vm_page;
+    vm_page_family_t *vm_page_family;
+    vm_page_for_families_t *vm_page_for_families =
+        page_source->vm_page_for_families;
 
-    assert(vm_page_family->first_page);
+    for(i = 0; i < vm_page_for_families->no_of_families; i++){
 
-    if(vm_page_family->first_page == vm_page){
-        vm_page_family->first_page = vm_page->next;
-        if(vm_page->next)
-            vm_page->next->prev = NULL;
-        vm_page_family->no_of_system_calls_to_alloc_dealloc_vm_pages++;
-        mm_return_vm_page_to_heap_segment(vm_page);
-        return;
-    }
+        vm_page_family = &vm_page_for_families->vm_page_family[i];
+        mm_family_handle_table_set(vm_page_family->family_id, NULL);
 
-    if(vm_page->next)
-        vm_page->next->prev = vm_page->prev;
-    vm_page->prev->next = vm_page->next;
-    vm_page_family->no_of_system_calls_to_alloc_dealloc_vm_pages++;
-    mm_return_vm_page_to_heap_segment(vm_page);
-}
+        if(MM_FAMILY_IS_SHARED(vm_page_family))
+            continue;
 
-static block_meta_data_t *
-mm_free_blocks(block_meta_data_t *to_be_free_block){
+        MM_COUNTER_SUB(gb_memory_in_use_by_app,
+            MM_COUNTER_READ(vm_page_family->total_memory_in_use_by_app));
 
-    block_meta_data_t *return_block = NULL;
+        ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family, vm_page){
 
-    assert(to_be_free_block->is_free == MM_FALSE);
-    
-    vm_page_t *hosting_page = 
-        MM_GET_PAGE_FROM_META_BLOCK(to_be_free_block);
+            MM_COUNTER_SUB(gb_vm_page_memory, vm_page->page_size);
+        } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family, vm_page);
+    }
 
-    vm_page_family_t *vm_page_family = hosting_page->pg_family;
+    for(i = 0; i < gb_no_of_page_sources; i++){
 
-    vm_page_family->total_memory_in_use_by_app -= 
-        sizeof(block_meta_data_t) + to_be_free_block->block_size;
-    
-    to_be_free_block->is_free = MM_TRUE;
-    
-    return_block = to_be_free_block;
+        if(gb_page_sources[i] == page_source){
+            memmove(&gb_page_sources[i], &gb_page_sources[i + 1],
+                (gb_no_of_page_sources - i - 1) * sizeof(mm_page_source_t *));
+            gb_no_of_page_sources--;
+            break;
+        }
+    }
+}
 
-    block_meta_data_t *next_block = NEXT_META_BLOCK(to_be_free_block);
+vm_page_for_families_t *
+mm_get_first_vm_page_for_families(
+    vm_page_for_families_t *first_vm_page_for_families){
 
-    if(next_block && next_block->is_free == MM_TRUE){
-        /*Union two free blocks*/
-        mm_union_free_blocks(to_be_free_block, next_block);
-        return_block = to_be_free_block;
-    }
-    /*Check the previous block if it was free*/
-    block_meta_data_t *prev_block = PREV_META_BLOCK(to_be_free_block);
-    
-    if(prev_block && prev_block->is_free){
-        mm_union_free_blocks(prev_block, to_be_free_block);
-        return_block = prev_block;
+    if(first_vm_page_for_families)
+        return first_vm_page_for_families;
+    return gb_no_of_page_sources ?
+        gb_page_sources[0]->vm_page_for_families : NULL;
+}
+
+vm_page_for_families_t *
+mm_get_next_vm_page_for_families(
+    vm_page_for_families_t *vm_page_for_families){
+
+    uint32_t i = 0;
+
+    if(!vm_page_for_families->page_source){
+        if(vm_page_for_families->next)
+            return vm_page_for_families->next;
     }
-    
-    if(mm_is_vm_page_empty(hosting_page)){
-        mm_vm_page_delete_and_free(hosting_page);
-        return NULL;
+    else{
+        while(gb_page_sources[i]->vm_page_for_families !=
+                vm_page_for_families){
+            i++;
+        }
+        i++;
     }
-    mm_add_free_block_meta_data_to_free_block_list(
-            hosting_page->pg_family, return_block);
-    
-    return return_block;
+    return i < gb_no_of_page_sources ?
+        gb_page_sources[i]->vm_page_for_families : NULL;
 }
 
+/* Owner of a lock dying with it held leaves the heap as it was at that
+ * moment, the lock is taken over as is*/
 void
-xfree(void *app_data){
+mm_page_source_lock(mm_page_source_t *page_source){
 
-    block_meta_data_t *block_meta_data = 
-        (block_meta_data_t *)((char *)app_data - sizeof(block_meta_data_t));
-   
-    if(block_meta_data->is_free == MM_TRUE){
-        printf("!Double Free detected\n");
-        assert(0);
+    if(pthread_mutex_lock(page_source->lock) == EOWNERDEAD){
+        printf("Warning : %s() Owner of a shared heap lock died\n",
+            __FUNCTION__);
+        pthread_mutex_consistent(page_source->lock);
     }
-    mm_free_blocks(block_meta_data);
 }
 
 vm_bool_t
@@ -596,7 +2736,10 @@ mm_print_vm_page_details(vm_page_t *vm_page, uint32_t i){
 
     printf("\tPage Index : %u , address = %p\n", vm_page->page_index, vm_page);
     printf("\t\t next = %p, prev = %p\n", vm_page->next, vm_page->prev);
-    printf("\t\t page family = %s\n", vm_page->pg_family->struct_name);
+    printf("\t\t page family = %s, page_size = %uB, bytes in use = %uB, "
+        "pinned blocks = %u\n", 
+        vm_page->pg_family->struct_name, vm_page->page_size,
+        vm_page->bytes_in_use, vm_page->no_of_pinned_blocks);
 
     uint32_t j = 0;
     block_meta_data_t *curr;
@@ -619,12 +2762,13 @@ mm_print_memory_usage(char *struct_name){
     vm_page_t *vm_page = NULL;
     vm_page_family_t *vm_page_family_curr; 
     uint32_t number_of_struct_families = 0;
-    uint32_t total_memory_in_use_by_application = 0;
-    uint32_t cumulative_vm_pages_claimed_from_kernel = 0;
+    uint64_t total_memory_in_use_by_application = 0;
+    uint64_t cumulative_vm_pages_claimed_from_kernel = 0;
+    uint64_t cumulative_vm_page_bytes_claimed_from_kernel = 0;
 
     printf("\nPage Size = %zu Bytes\n", GB_SYSTEM_PAGE_SIZE);
 
-    ITERATE_PAGE_FAMILIES_BEGIN(gb_heap_segment_start, vm_page_family_curr){
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, vm_page_family_curr){
         
         if(struct_name){
             if(strncmp(struct_name, vm_page_family_curr->struct_name,
@@ -635,55 +2779,104 @@ mm_print_memory_usage(char *struct_name){
 
         number_of_struct_families++;
 
-        printf(ANSI_COLOR_GREEN "vm_page_family : %s, struct size = %u\n" 
+        printf(ANSI_COLOR_GREEN "vm_page_family : %s, struct size = %u, "
+                "placement = %s\n" 
                 ANSI_COLOR_RESET,
                 vm_page_family_curr->struct_name,
-                vm_page_family_curr->struct_size);
-        printf(ANSI_COLOR_CYAN "\tApp Used Memory %uB, #Sys Calls %u\n"
+                vm_page_family_curr->struct_size,
+                mm_placement_policy_str(vm_page_family_curr->placement_policy));
+        printf(ANSI_COLOR_CYAN "\tVM Page Size %zuB (%u sys pages), Tail Waste %uB (%.2f%%)\n"
                 ANSI_COLOR_RESET,
-                vm_page_family_curr->total_memory_in_use_by_app,
-                vm_page_family_curr->\
-                no_of_system_calls_to_alloc_dealloc_vm_pages);
-        
-        total_memory_in_use_by_application += 
-            vm_page_family_curr->total_memory_in_use_by_app;
+                vm_page_family_curr->vm_page_units * GB_SYSTEM_PAGE_SIZE,
+                vm_page_family_curr->vm_page_units,
+                vm_page_family_curr->page_tail_waste,
+                mm_page_tail_waste_pct(vm_page_family_curr->page_tail_waste,
+                    vm_page_family_curr->vm_page_units));
+        printf(ANSI_COLOR_CYAN "\tApp Used Memory %" PRIu64 "B, Peak %" PRIu64 "B, "
+                "#Sys Calls %" PRIu64 "\n"
+                ANSI_COLOR_RESET,
+                MM_COUNTER_READ(vm_page_family_curr->total_memory_in_use_by_app),
+                MM_COUNTER_READ(vm_page_family_curr->peak_memory_in_use_by_app),
+                MM_COUNTER_READ(vm_page_family_curr->\
+                no_of_system_calls_to_alloc_dealloc_vm_pages));
+        printf(ANSI_COLOR_CYAN "\t#Allocs %" PRIu64 ", #Frees %" PRIu64 ", "
+                "Cumulative Bytes Allocated %" PRIu64 "B\n"
+                ANSI_COLOR_RESET,
+                MM_COUNTER_READ(vm_page_family_curr->no_of_allocations),
+                MM_COUNTER_READ(vm_page_family_curr->no_of_deallocations),
+                MM_COUNTER_READ(vm_page_family_curr->total_memory_allocated));
+        printf(ANSI_COLOR_CYAN "\t#Compaction Passes %" PRIu64 ", Pages Reclaimed %" PRIu64
+                " (Last Pass %" PRIu64 "), Bytes Moved %" PRIu64 "B\n"
+                ANSI_COLOR_RESET,
+                MM_COUNTER_READ(vm_page_family_curr->no_of_compaction_passes),
+                MM_COUNTER_READ(vm_page_family_curr->compaction_pages_reclaimed),
+                MM_COUNTER_READ(vm_page_family_curr->last_pass_pages_reclaimed),
+                MM_COUNTER_READ(vm_page_family_curr->compaction_bytes_moved));
+        if(vm_page_family_curr->page_limit_check != MM_NO_LIMIT){
+            printf(ANSI_COLOR_CYAN "\tVM Page Limits Soft %" PRIu64 ", Hard %" PRIu64
+                    ", #Soft Hits %" PRIu64 ", #Hard Failures %" PRIu64 "\n"
+                    ANSI_COLOR_RESET,
+                    vm_page_family_curr->soft_page_limit == MM_NO_LIMIT ?
+                        0 : vm_page_family_curr->soft_page_limit,
+                    vm_page_family_curr->hard_page_limit == MM_NO_LIMIT ?
+                        0 : vm_page_family_curr->hard_page_limit,
+                    MM_COUNTER_READ(vm_page_family_curr->no_of_soft_limit_hits),
+                    MM_COUNTER_READ(vm_page_family_curr->no_of_hard_limit_failures));
+        }
+        if(MM_COUNTER_READ(vm_page_family_curr->no_of_reserved_vm_pages)){
+            printf(ANSI_COLOR_CYAN "\tVM Pages Reserved %" PRIu64 ", Used %" PRIu64 "\n"
+                    ANSI_COLOR_RESET,
+                    MM_COUNTER_READ(vm_page_family_curr->no_of_reserved_vm_pages),
+                    MM_COUNTER_READ(vm_page_family_curr->no_of_vm_pages) -
+                    MM_COUNTER_READ(vm_page_family_curr->no_of_reserved_vm_pages));
+        }
 
+        total_memory_in_use_by_application +=
+            MM_COUNTER_READ(vm_page_family_curr->total_memory_in_use_by_app);
+
+#ifdef MM_LATENCY_STATS
+        mm_print_family_latency_stats(vm_page_family_curr);
+#endif
         i = 0;
 
         ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family_curr, vm_page){
       
             cumulative_vm_pages_claimed_from_kernel++;
+            cumulative_vm_page_bytes_claimed_from_kernel += vm_page->page_size;
             mm_print_vm_page_details(vm_page, i++);
 
         } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family_curr, vm_page);
         printf("\n");
-    } ITERATE_PAGE_FAMILIES_END(gb_heap_segment_start, vm_page_family_curr);
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
 
-    printf(ANSI_COLOR_MAGENTA "\nTotal Applcation Memory Usage : %u Bytes\n"
-        ANSI_COLOR_RESET, total_memory_in_use_by_application);
+    printf(ANSI_COLOR_MAGENTA "\nTotal Applcation Memory Usage : %" PRIu64 " Bytes "
+        "(Peak %" PRIu64 " Bytes)\n"
+        ANSI_COLOR_RESET, total_memory_in_use_by_application,
+        MM_COUNTER_READ(gb_peak_memory_in_use_by_app));
 
-    printf(ANSI_COLOR_MAGENTA "# Of VM Pages in Use : %u (%lu Bytes).\n" \
+    printf(ANSI_COLOR_MAGENTA "# Of VM Pages in Use : %" PRIu64 " (%" PRIu64 " Bytes, "
+        "Peak %" PRIu64 " Bytes).\n" \
         "Heap Segment Start ptr = %p, sbrk(0) = %p , gb_hsba = %p, diff = %lu\n" \
         ANSI_COLOR_RESET,
         cumulative_vm_pages_claimed_from_kernel, 
-        GB_SYSTEM_PAGE_SIZE * cumulative_vm_pages_claimed_from_kernel,
+        cumulative_vm_page_bytes_claimed_from_kernel,
+        MM_COUNTER_READ(gb_peak_vm_page_memory),
         gb_heap_segment_start, sbrk(0), gb_hsba,
         (unsigned long)sbrk(0) - (unsigned long)gb_hsba);
 
-    float memory_app_use_to_total_memory_ratio = 0.0;
+    double memory_app_use_to_total_memory_ratio = 0.0;
     
     if(cumulative_vm_pages_claimed_from_kernel){
         memory_app_use_to_total_memory_ratio = 
-        (float)(total_memory_in_use_by_application * 100)/\
-        (float)(cumulative_vm_pages_claimed_from_kernel * GB_SYSTEM_PAGE_SIZE);
+        (double)(total_memory_in_use_by_application * 100)/\
+        (double)(cumulative_vm_page_bytes_claimed_from_kernel);
     }
     printf(ANSI_COLOR_MAGENTA "Memory In Use by Application = %f%%\n"
         ANSI_COLOR_RESET,
         memory_app_use_to_total_memory_ratio);
 
-    printf("Total Memory being used by Memory Manager = %lu Bytes\n",
-        ((cumulative_vm_pages_claimed_from_kernel *\
-        GB_SYSTEM_PAGE_SIZE) + 
+    printf("Total Memory being used by Memory Manager = %" PRIu64 " Bytes\n",
+        (cumulative_vm_page_bytes_claimed_from_kernel + 
         (number_of_struct_families * sizeof(vm_page_family_t))));
 }
 
@@ -693,26 +2886,30 @@ mm_print_block_usage(){
     vm_page_t *vm_page_curr;
     vm_page_family_t *vm_page_family_curr;
     block_meta_data_t *block_meta_data_curr;
-    uint32_t total_block_count, free_block_count,
-             occupied_block_count;
-    uint32_t application_memory_usage;
+    uint64_t total_block_count, free_block_count,
+             occupied_block_count, idle_block_count;
+    uint64_t application_memory_usage;
 
-    ITERATE_PAGE_FAMILIES_BEGIN(gb_heap_segment_start, vm_page_family_curr){
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, vm_page_family_curr){
 
         total_block_count = 0;
         free_block_count = 0;
         application_memory_usage = 0;
         occupied_block_count = 0;
+        idle_block_count = 0;
         ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family_curr, vm_page_curr){
 
             ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page_curr, block_meta_data_curr){
         
                 total_block_count++;
                 
-                /*Sanity Checks*/
-                if(block_meta_data_curr->is_free == MM_FALSE){
-                    assert(IS_GLTHREAD_LIST_EMPTY(&block_meta_data_curr->\
-                                priority_thread_glue));
+                /* Sanity Checks, an allocated block is queued only by
+                 * an object cache, a buffer cache or a limbo list of
+                 * deferred frees, all counted as idle*/
+                if(block_meta_data_curr->is_free == MM_FALSE &&
+                    !IS_GLTHREAD_LIST_EMPTY(&block_meta_data_curr->\
+                        priority_thread_glue)){
+                    idle_block_count++;
                 }
                 if(block_meta_data_curr->is_free == MM_TRUE){
                     assert(!IS_GLTHREAD_LIST_EMPTY(&block_meta_data_curr->\
@@ -731,9 +2928,39 @@ mm_print_block_usage(){
             } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page_curr, block_meta_data_curr);
         } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family_curr, vm_page_curr);
 
-        printf("%-20s   TBC : %-4u    FBC : %-4u    OBC : %-4u AppMemUsage : %u\n",
+        /*Sanity Checks, incrementally maintained counters must agree*/
+        assert(free_block_count == 
+                MM_COUNTER_READ(vm_page_family_curr->no_of_free_blocks));
+        assert(occupied_block_count == 
+                MM_COUNTER_READ(vm_page_family_curr->no_of_allocated_blocks));
+        assert(application_memory_usage == 
+                MM_COUNTER_READ(vm_page_family_curr->total_memory_in_use_by_app));
+        assert(idle_block_count == 
+                MM_COUNTER_READ(vm_page_family_curr->no_of_idle_blocks));
+
+        printf("%-20s   TBC : %-4" PRIu64 "    FBC : %-4" PRIu64 "    OBC : %-4" PRIu64
+            " AppMemUsage : %" PRIu64 "\n",
             vm_page_family_curr->struct_name, total_block_count,
             free_block_count, occupied_block_count, application_memory_usage);
     
-    } ITERATE_PAGE_FAMILIES_END(gb_heap_segment_start, vm_page_family_curr); 
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr); 
+}
+
+void
+mm_print_registered_page_families(){
+
+    vm_page_family_t *vm_page_family_curr = NULL;
+
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, vm_page_family_curr){
+
+        printf("Page Family : %-20s Size = %-6u VM Page Size = %-6zu "
+            "Tail Waste = %uB (%.2f%%)\n",
+            vm_page_family_curr->struct_name,
+            vm_page_family_curr->struct_size,
+            vm_page_family_curr->vm_page_units * GB_SYSTEM_PAGE_SIZE,
+            vm_page_family_curr->page_tail_waste,
+            mm_page_tail_waste_pct(vm_page_family_curr->page_tail_waste,
+                vm_page_family_curr->vm_page_units));
+
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
 }
@@ -32,8 +32,16 @@
 #define __MM__
 
 #include <stdint.h>
+#include <pthread.h>
 #include "gluethread/glthread.h"
 #include <stddef.h> /*for size_t*/
+#include "uapi_mm.h"
+#ifdef MM_LATENCY_STATS
+#include <time.h>
+#if defined(MM_LATENCY_USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+#endif
 
 
 typedef enum{
@@ -47,6 +55,7 @@ typedef struct block_meta_data_{
     vm_bool_t is_free;
     uint32_t block_size;
     uint32_t offset;    /*offset from the start of the page*/
+    mm_handle_t handle; /*Handle of movable allocated block, else MM_HANDLE_NULL*/
     glthread_t priority_thread_glue;
     struct block_meta_data_ *prev_block;
     struct block_meta_data_ *next_block;
@@ -59,15 +68,43 @@ GLTHREAD_TO_STRUCT(glthread_to_block_meta_data,
 
 /*Forward Declaration*/
 struct vm_page_family_;
+struct mm_buff_cache_;
+
+/* Every VM page of a family is queued in one of the occupancy class
+ * lists of the family. Partial pages are classed by the fraction of the
+ * VM page in use, in steps of 1/MM_PAGE_OCCUPANCY_PARTIAL_CLASSES. A
+ * page is full if its largest free block can not hold even one object
+ * of the family*/
+#ifndef MM_PAGE_OCCUPANCY_PARTIAL_CLASSES
+#define MM_PAGE_OCCUPANCY_PARTIAL_CLASSES   16
+#endif
+
+typedef enum{
+
+    MM_PAGE_OCCUPANCY_EMPTY,
+    MM_PAGE_OCCUPANCY_PARTIAL,  /*least occupied partial class*/
+    MM_PAGE_OCCUPANCY_FULL = 
+        MM_PAGE_OCCUPANCY_PARTIAL + MM_PAGE_OCCUPANCY_PARTIAL_CLASSES,
+    MM_PAGE_OCCUPANCY_MAX
+} mm_page_occupancy_t;
 
 typedef struct vm_page_{
     struct vm_page_ *next;
     struct vm_page_ *prev;
     struct vm_page_family_ *pg_family; /*back pointer*/
     uint32_t page_index;
+    uint32_t page_size; /*size of this VM page in bytes, multiple of system page size*/
+    uint32_t prev_page_size; /*size of the VM page lying just below in heap segment, 0 if none*/
+    uint32_t bytes_in_use;   /*data and meta blocks of allocated blocks*/
+    uint32_t largest_free_block;
+    uint16_t occupancy;      /*mm_page_occupancy_t*/
+    uint16_t no_of_pinned_blocks;   /*Allocated blocks which are not movable*/
+    glthread_t occupancy_glue;
     block_meta_data_t block_meta_data;
     char page_memory[0];
 } vm_page_t;
+GLTHREAD_TO_STRUCT(glthread_to_vm_page,
+    vm_page_t, occupancy_glue, glthread_ptr);
 
 #define MM_GET_PAGE_FROM_META_BLOCK(block_meta_data_ptr)    \
     ((vm_page_t *)((char *)block_meta_data_ptr - block_meta_data_ptr->offset))
@@ -97,17 +134,158 @@ typedef struct vm_page_{
 vm_bool_t
 mm_is_vm_page_empty(vm_page_t *vm_page);
 
-#define MM_MAX_STRUCT_NAME 32
+/* Upper bound on the no of system pages that make up one logical
+ * VM page of a page family*/
+#define MM_MAX_SYS_PAGES_PER_VM_PAGE    8
+
+/* Statistics counters are 64 bit so that they never wrap. Compile with
+ * -DMM_ATOMIC_STATS if the counters are to be read by other threads
+ * (e.g. a metrics exporter) while the application allocates*/
+typedef uint64_t mm_counter_t;
+
+#ifdef MM_ATOMIC_STATS
+#define MM_COUNTER_ADD(counter, val)    \
+    __atomic_add_fetch(&(counter), (val), __ATOMIC_RELAXED)
+#define MM_COUNTER_SUB(counter, val)    \
+    __atomic_sub_fetch(&(counter), (val), __ATOMIC_RELAXED)
+#define MM_COUNTER_READ(counter)        \
+    __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define MM_COUNTER_SET(counter, val)    \
+    __atomic_store_n(&(counter), (val), __ATOMIC_RELAXED)
+#else
+#define MM_COUNTER_ADD(counter, val)    ((counter) += (val))
+#define MM_COUNTER_SUB(counter, val)    ((counter) -= (val))
+#define MM_COUNTER_READ(counter)        (counter)
+#define MM_COUNTER_SET(counter, val)    ((counter) = (val))
+#endif
+
+/*Raise the high water mark 'peak' to 'val' if 'val' is higher*/
+#define MM_COUNTER_UPDATE_PEAK(peak, val)                       \
+    do{                                                         \
+        mm_counter_t _new_val = (val);                          \
+        mm_counter_t _curr_peak = MM_COUNTER_READ(peak);        \
+        while(_new_val > _curr_peak){                           \
+            if(mm_counter_cas(&(peak), &_curr_peak, _new_val))  \
+                break;                                          \
+        }                                                       \
+    }while(0)
+
+static inline int
+mm_counter_cas(mm_counter_t *counter, mm_counter_t *expected,
+               mm_counter_t desired){
+#ifdef MM_ATOMIC_STATS
+    return __atomic_compare_exchange_n(counter, expected, desired, 0,
+                __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#else
+    (void)expected;
+    *counter = desired;
+    return 1;
+#endif
+}
+
+/* A bigger logical VM page is chosen for a page family only if it
+ * reduces the tail waste by at least this much percentage*/
+#define MM_PAGE_TAIL_WASTE_TOLERANCE_PCT    1.0
+
+#ifdef MM_LATENCY_STATS
+typedef struct mm_latency_hist_{
+
+    mm_counter_t count;
+    mm_counter_t total;
+    mm_counter_t max;
+    mm_counter_t bucket[MM_LATENCY_HIST_BUCKETS];
+} mm_latency_hist_t;
+
+#if defined(MM_LATENCY_USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+#define MM_LATENCY_UNIT "cycles"
+#else
+#define MM_LATENCY_UNIT "ns"
+#endif
+
+static inline uint64_t
+mm_latency_now(void){
+
+#if defined(MM_LATENCY_USE_TSC) && (defined(__x86_64__) || defined(__i386__))
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline void
+mm_latency_record(mm_latency_hist_t *latency_hist, uint64_t ticks){
+
+    uint32_t bucket = ticks ? 64 - __builtin_clzll(ticks) : 0;
+
+    if(bucket >= MM_LATENCY_HIST_BUCKETS)
+        bucket = MM_LATENCY_HIST_BUCKETS - 1;
+
+    MM_COUNTER_ADD(latency_hist->bucket[bucket], 1);
+    MM_COUNTER_ADD(latency_hist->count, 1);
+    MM_COUNTER_ADD(latency_hist->total, ticks);
+    MM_COUNTER_UPDATE_PEAK(latency_hist->max, ticks);
+}
+
+#define MM_LATENCY_START(ts)    \
+    uint64_t ts = mm_latency_now()
+
+#define MM_LATENCY_RECORD(vm_page_family_ptr, op, ts)   \
+    mm_latency_record(&(vm_page_family_ptr)->latency_hist[op],  \
+        mm_latency_now() - (ts))
+#else
+#define MM_LATENCY_START(ts)
+#define MM_LATENCY_RECORD(vm_page_family_ptr, op, ts)
+#endif
+
 typedef struct vm_page_family_{
 
     char struct_name[MM_MAX_STRUCT_NAME];
     uint32_t struct_size;
+    uint32_t family_id;         /*Registration order, identifies family in traces*/
+    uint32_t vm_page_units;     /*logical VM page size in system pages*/
+    uint32_t page_tail_waste;   /*Bytes unusable at the bottom of a packed VM page*/
+    mm_placement_policy_t placement_policy;
     vm_page_t *first_page;
+    struct mm_page_source_ *page_source;   /*NULL if VM pages come from heap segment*/
     glthread_t free_block_priority_list_head;
+    glthread_t page_occupancy_list_head[MM_PAGE_OCCUPANCY_MAX];
     
     /*Statistics*/
-    uint32_t total_memory_in_use_by_app;
-    uint32_t no_of_system_calls_to_alloc_dealloc_vm_pages;
+    mm_counter_t total_memory_in_use_by_app;
+    mm_counter_t no_of_system_calls_to_alloc_dealloc_vm_pages;
+    mm_counter_t no_of_vm_pages;
+    mm_counter_t no_of_free_blocks;
+    mm_counter_t no_of_allocated_blocks;
+    mm_counter_t no_of_idle_blocks;     /*Allocated, queued on the idle list of an object cache,
+                                          on the cache of freed buffers of a size class
+                                          or on a limbo list of deferred frees*/
+    mm_counter_t no_of_deferred_blocks; /*Of no_of_idle_blocks, on a limbo list*/
+    mm_counter_t total_free_memory;     /*Sum of sizes of all free data blocks*/
+    mm_counter_t peak_memory_in_use_by_app;
+    mm_counter_t no_of_allocations;     /*Cumulative*/
+    mm_counter_t no_of_deallocations;   /*Cumulative*/
+    mm_counter_t total_memory_allocated;/*Cumulative application bytes, excluding meta blocks*/
+    mm_counter_t no_of_compaction_passes;
+    mm_counter_t compaction_pages_reclaimed;   /*Cumulative*/
+    mm_counter_t compaction_bytes_moved;       /*Cumulative*/
+    mm_counter_t pass_pages_reclaimed;         /*By the compaction pass in progress*/
+    mm_counter_t last_pass_pages_reclaimed;
+    vm_bool_t compaction_in_progress;
+    mm_counter_t no_of_movable_blocks;
+    /*Limits in VM pages of the family, MM_NO_LIMIT if none*/
+    uint64_t soft_page_limit;
+    uint64_t hard_page_limit;
+    uint64_t page_limit_check;      /*Lower of both, compared on page acquisition*/
+    mm_counter_t no_of_soft_limit_hits;
+    mm_counter_t no_of_hard_limit_failures;
+    mm_counter_t no_of_reserved_vm_pages;   /*Reserved by mm_reserve(), not used yet*/
+    struct mm_buff_cache_ *buff_cache;      /*Freed buffers of a size class family, else NULL*/
+    void *owner;    /*Arena or object cache built on the family, else NULL*/
+#ifdef MM_LATENCY_STATS
+    mm_latency_hist_t latency_hist[MM_LATENCY_OP_MAX];
+#endif
 } vm_page_family_t;
 
 static inline block_meta_data_t *
@@ -124,40 +302,158 @@ mm_get_biggest_free_block_page_family(
 }
 
 vm_page_t *
-allocate_vm_page();
+allocate_vm_page(vm_page_family_t *vm_page_family);
 
 #define MARK_VM_PAGE_EMPTY(vm_page_t_ptr)                                 \
     vm_page_t_ptr->block_meta_data.next_block = NULL;                     \
     vm_page_t_ptr->block_meta_data.prev_block = NULL;                     \
     vm_page_t_ptr->block_meta_data.is_free = MM_TRUE
 
-#define MM_GET_NEXT_PAGE_IN_HEAP_SEGMENT(vm_page_t_ptr, incr)   \
-    ((incr == '+') ? ((vm_page_t *)((char *)vm_page_t_ptr + GB_SYSTEM_PAGE_SIZE)): \
-                     ((vm_page_t *)((char *)vm_page_t_ptr - GB_SYSTEM_PAGE_SIZE)))
+/* VM pages in heap segment are of variable size, every VM page records
+ * the size of the VM page lying just below it, so that heap segment
+ * can be walked downwards from the top most VM page*/
+#define MM_GET_PREV_PAGE_IN_HEAP_SEGMENT(vm_page_t_ptr)   \
+    ((vm_page_t_ptr)->prev_page_size ?                     \
+        (vm_page_t *)((char *)(vm_page_t_ptr) - (vm_page_t_ptr)->prev_page_size) : \
+        NULL)
 
 void
 mm_init();
 
-#define N_PAGE_FAMILY_PER_VM_PAGE   \
-    (GB_SYSTEM_PAGE_SIZE/sizeof(vm_page_family_t))
-
-#define VM_PAGE_FAMILY_RESIDUAL_SPACE   \
-    (GB_SYSTEM_PAGE_SIZE - (N_PAGE_FAMILY_PER_VM_PAGE * sizeof(vm_page_family_t)))
-
-#define ITERATE_PAGE_FAMILIES_BEGIN(first_vm_page_family_ptr, curr)   \
-{                                                                     \
-    uint32_t count = 0; curr = NULL;                                  \
-    for(curr = (vm_page_family_t *)first_vm_page_family_ptr;          \
-        count != gb_no_of_vm_families_registered;                     \
-        count++, curr++){                                             \
-        if(count == N_PAGE_FAMILY_PER_VM_PAGE){                       \
-            curr = (vm_page_family_t *)((char *)curr +                \
-                VM_PAGE_FAMILY_RESIDUAL_SPACE);                       \
-            count = 0;                                                \
-        }
-
-#define ITERATE_PAGE_FAMILIES_END(first_vm_page_family_ptr, curr) \
-    }}
+/*Library Globals*/
+extern void       *gb_heap_segment_start;
+extern size_t      GB_SYSTEM_PAGE_SIZE;
+extern uint32_t    gb_no_of_vm_families_registered;
+extern mm_counter_t gb_memory_in_use_by_app;
+extern mm_counter_t gb_peak_memory_in_use_by_app;
+extern mm_counter_t gb_vm_page_memory;
+extern mm_counter_t gb_peak_vm_page_memory;
+
+#define MM_NO_LIMIT     UINT64_MAX
+extern uint64_t    gb_soft_vm_page_memory_limit;    /*Bytes*/
+extern uint64_t    gb_hard_vm_page_memory_limit;
+/*Families can not be destroyed meanwhile, their records would move*/
+extern vm_bool_t   gb_pressure_cb_running;
+
+/* Page families are stored in dedicated VM pages chained together, so
+ * that families can be registered at any time, even after the heap
+ * segment has grown past the first family page*/
+typedef struct vm_page_for_families_{
+
+    struct vm_page_for_families_ *next;
+    struct mm_page_source_ *page_source;   /*Owner of the families, NULL for heap segment*/
+    uint32_t no_of_families;
+    vm_page_family_t vm_page_family[0];
+} vm_page_for_families_t;
+
+extern vm_page_for_families_t *gb_first_vm_page_for_families;
+
+/* A page source other than the heap segment (e.g. a persistent heap
+ * file, a shared memory heap) owns one page of families and serves the
+ * VM pages of those families. Families never move between page sources.
+ * The page source lives in the memory it describes, so that processes
+ * sharing it see the same families*/
+typedef struct mm_page_source_ mm_page_source_t;
+
+struct mm_page_source_{
+
+    vm_page_for_families_t *vm_page_for_families;
+    /* Process shared lock of a heap used by several processes at once,
+     * taken by xcalloc() and xfree() on its families. NULL if private*/
+    pthread_mutex_t *lock;
+    uint32_t no_of_families_registered;    /*Ids of families of a shared heap*/
+};
+
+/* Page sources are served by one implementation per process, which
+ * installs itself in gb_page_source_ops before attaching a page source*/
+typedef struct mm_page_source_ops_{
+
+    /*VM page of units system pages with page_size set, NULL if exhausted*/
+    vm_page_t *(*get_vm_page)(mm_page_source_t *page_source, uint32_t units);
+    void (*put_vm_page)(mm_page_source_t *page_source, vm_page_t *vm_page);
+} mm_page_source_ops_t;
+
+extern const mm_page_source_ops_t *gb_page_source_ops;
+
+/* Families of shared heaps take ids from the upper half of the family
+ * handle range, counted in the heap, so that a handle names the same
+ * family in every process*/
+#define MM_MAX_FAMILY_HANDLES       65536
+#define MM_SHARED_FAMILY_ID_BASE    (MM_MAX_FAMILY_HANDLES / 2)
+
+/* Families of shared heaps are left out of the process wide counters,
+ * other processes allocate and free on them too*/
+#define MM_FAMILY_IS_SHARED(vm_page_family_ptr)         \
+    ((vm_page_family_ptr)->page_source &&               \
+     (vm_page_family_ptr)->page_source->lock)
+
+void
+mm_page_source_lock(mm_page_source_t *page_source);
+
+#define MM_FAMILY_LOCK(vm_page_family_ptr)                              \
+    do{                                                                 \
+        if(MM_FAMILY_IS_SHARED(vm_page_family_ptr))                     \
+            mm_page_source_lock((vm_page_family_ptr)->page_source);     \
+    }while(0)
+
+#define MM_FAMILY_UNLOCK(vm_page_family_ptr)                            \
+    do{                                                                 \
+        if(MM_FAMILY_IS_SHARED(vm_page_family_ptr))                     \
+            pthread_mutex_unlock((vm_page_family_ptr)->page_source->lock); \
+    }while(0)
+
+/*Return NULL if the page of families of the source is full*/
+vm_page_family_t *
+mm_instantiate_page_family_in_page_source(char *struct_name,
+                                          uint32_t struct_size,
+                                          mm_page_source_t *page_source);
+
+/* Add the families of the source, as found in its page of families, to
+ * the families of the process and account their pages and objects in
+ * the global statistics. Return -1 if too many sources are attached*/
+int
+mm_attach_page_source(mm_page_source_t *page_source);
+
+void
+mm_detach_page_source(mm_page_source_t *page_source);
+
+/* mm_family_reset() and mm_family_destroy() of a registered family, with
+ * no check of its owner, for arenas and object caches to use on their own
+ * families*/
+int
+mm_vm_page_family_reset(vm_page_family_t *vm_page_family);
+
+int
+mm_vm_page_family_destroy(vm_page_family_t *vm_page_family);
+
+/* Pages of families of the heap segment are chained through next, the
+ * pages of attached page sources follow them. The next pointer of a page
+ * source's page is never used, it may be shared with other processes*/
+vm_page_for_families_t *
+mm_get_first_vm_page_for_families(vm_page_for_families_t *first_vm_page_for_families);
+
+vm_page_for_families_t *
+mm_get_next_vm_page_for_families(vm_page_for_families_t *vm_page_for_families);
+
+#define MAX_FAMILIES_PER_VM_PAGE   \
+    ((GB_SYSTEM_PAGE_SIZE - sizeof(vm_page_for_families_t))/sizeof(vm_page_family_t))
+
+/* break inside this loop leaves only the current page of families*/
+#define ITERATE_PAGE_FAMILIES_BEGIN(first_vm_page_for_families_ptr, curr)   \
+{                                                                           \
+    vm_page_for_families_t *_vm_page_for_families;                          \
+    uint32_t _count;                                                        \
+    for(_vm_page_for_families =                                             \
+            mm_get_first_vm_page_for_families(first_vm_page_for_families_ptr); \
+        _vm_page_for_families;                                              \
+        _vm_page_for_families =                                             \
+            mm_get_next_vm_page_for_families(_vm_page_for_families)){       \
+        for(_count = 0, curr = &_vm_page_for_families->vm_page_family[0];   \
+            _count < _vm_page_for_families->no_of_families;                 \
+            _count++, curr++){
+
+#define ITERATE_PAGE_FAMILIES_END(first_vm_page_for_families_ptr, curr) \
+    }}}
 
 vm_page_family_t *
 lookup_page_family_by_name(char *struct_name);
@@ -182,15 +478,32 @@ lookup_page_family_by_name(char *struct_name);
 #define ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page_ptr, curr)   \
     }}
 
-#define ITERATE_HEAP_SEGMENT_PAGE_WISE_BEGIN(vm_page_begin_ptr, curr)   \
+#define ITERATE_HEAP_SEGMENT_PAGE_WISE_BEGIN(vm_page_top_ptr, curr)   \
 {                                                               \
-    void *heap_segment_end = sbrk(0);                           \
-    for(curr = (vm_page_t *)vm_page_begin_ptr;                  \
-        (void *)curr != heap_segment_end;                       \
-        curr = MM_GET_NEXT_PAGE_IN_HEAP_SEGMENT(curr, '+')){    \
+    for(curr = (vm_page_t *)vm_page_top_ptr;                    \
+        curr;                                                   \
+        curr = MM_GET_PREV_PAGE_IN_HEAP_SEGMENT(curr)){         \
 
-#define ITERATE_HEAP_SEGMENT_PAGE_WISE_END(vm_page_begin_ptr, curr) \
+#define ITERATE_HEAP_SEGMENT_PAGE_WISE_END(vm_page_top_ptr, curr) \
     }}   
 
 void mm_vm_page_delete_and_free(vm_page_t *vm_page);
+
+#ifdef MM_TRACE
+#ifndef MM_TRACE_RING_RECORDS
+#define MM_TRACE_RING_RECORDS   (1 << 16)   /*per thread, power of 2*/
+#endif
+void
+mm_trace_record(vm_page_family_t *vm_page_family, mm_trace_op_t op,
+                void *addr, void *page, uint32_t size);
+#define MM_TRACE_EVENT(vm_page_family_ptr, op, addr, page, size)    \
+    mm_trace_record(vm_page_family_ptr, op, addr, page, size)
+#else
+#define MM_TRACE_EVENT(vm_page_family_ptr, op, addr, page, size)
+#endif
+
+#ifdef MM_LATENCY_STATS
+void
+mm_print_family_latency_stats(vm_page_family_t *vm_page_family);
+#endif
 #endif /**/
@@ -0,0 +1,173 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_arena.c
+ *
+ *    Description:  This file implements the arena (region) allocator of Memory Manager
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 06:12:37 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "mm.h"
+
+/* Every VM page of an arena is one object of the arena's page family,
+ * the object spans the whole VM page. So VM pages are acquired through
+ * the regular xcalloc() path, and the family statistics account for
+ * them. mm_arena_reset() xfree()s every VM page but the current one,
+ * which is kept for the next round, mm_arena_destroy() releases them
+ * all with the family*/
+#define MM_ARENA_VM_PAGE_UNITS  MM_MAX_SYS_PAGES_PER_VM_PAGE
+
+struct mm_arena_{
+
+    char arena_name[MM_MAX_STRUCT_NAME];
+    char *alloc_ptr;    /*Next free byte on the current VM page*/
+    char *alloc_end;    /*End of the current VM page*/
+};
+
+#define MM_ARENA_ALIGN(size)    \
+    (((size) + MM_ARENA_ALIGNMENT - 1) & ~((uintptr_t)MM_ARENA_ALIGNMENT - 1))
+
+static inline uint32_t
+mm_arena_vm_page_capacity(){
+
+    return (uint32_t)((GB_SYSTEM_PAGE_SIZE * MM_ARENA_VM_PAGE_UNITS) -
+        offset_of(vm_page_t, page_memory));
+}
+
+/* Arena descriptors are taken directly from kernel, so that they stay
+ * put when families are relocated by mm_family_destroy()*/
+mm_arena_t *
+mm_arena_create(char *arena_name){
+
+    mm_arena_t *arena;
+    vm_page_family_t *vm_page_family;
+
+    if(lookup_page_family_by_name(arena_name)){
+        printf("Error : %s() Page family %s already exists\n",
+            __FUNCTION__, arena_name);
+        return NULL;
+    }
+
+    arena = mmap(NULL, sizeof(mm_arena_t), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(arena == MAP_FAILED)
+        return NULL;
+
+    mm_instantiate_new_page_family(arena_name, mm_arena_vm_page_capacity());
+
+    vm_page_family = lookup_page_family_by_name(arena_name);
+
+    if(!vm_page_family){
+        munmap(arena, sizeof(mm_arena_t));
+        return NULL;
+    }
+
+    vm_page_family->owner = arena;
+
+    strncpy(arena->arena_name, arena_name, MM_MAX_STRUCT_NAME - 1);
+    arena->arena_name[MM_MAX_STRUCT_NAME - 1] = '\0';
+    arena->alloc_ptr = NULL;
+    arena->alloc_end = NULL;
+    return arena;
+}
+
+static vm_bool_t
+mm_arena_add_vm_page(mm_arena_t *arena){
+
+    char *page_memory = xcalloc(arena->arena_name, 1);
+
+    if(!page_memory)
+        return MM_FALSE;
+
+    arena->alloc_ptr = (char *)MM_ARENA_ALIGN((uintptr_t)page_memory);
+    arena->alloc_end = page_memory + mm_arena_vm_page_capacity();
+    return MM_TRUE;
+}
+
+void *
+mm_arena_alloc(mm_arena_t *arena, uint32_t size){
+
+    char *ptr;
+    uintptr_t aligned_size = MM_ARENA_ALIGN((uintptr_t)(size ? size : 1));
+
+    if(aligned_size > (uintptr_t)(arena->alloc_end - arena->alloc_ptr)){
+
+        if(aligned_size > mm_arena_vm_page_capacity()){
+            printf("Error : Memory Requested Exceeds Arena Page Size\n");
+            return NULL;
+        }
+
+        /*Rest of the current VM page is abandoned till reset*/
+        if(!mm_arena_add_vm_page(arena))
+            return NULL;
+    }
+
+    ptr = arena->alloc_ptr;
+    arena->alloc_ptr += aligned_size;
+    return ptr;
+}
+
+/* The current VM page is kept and rewound, and only the part of it which
+ * was handed out is zeroed, so that an arena reset once per request does
+ * not return its VM page to kernel and fault it in again on the next
+ * request. Every other VM page is released*/
+void
+mm_arena_reset(mm_arena_t *arena){
+
+    char *page_memory;
+    vm_page_t *vm_page, *kept_vm_page;
+
+    if(!arena->alloc_ptr){
+        mm_vm_page_family_reset(lookup_page_family_by_name(arena->arena_name));
+        return;
+    }
+
+    page_memory = arena->alloc_end - mm_arena_vm_page_capacity();
+    kept_vm_page = MM_GET_PAGE_FROM_META_BLOCK(
+        ((block_meta_data_t *)page_memory - 1));
+
+    ITERATE_VM_PAGE_PER_FAMILY_BEGIN(kept_vm_page->pg_family, vm_page){
+
+        if(vm_page != kept_vm_page)
+            xfree(vm_page->page_memory);
+    } ITERATE_VM_PAGE_PER_FAMILY_END(kept_vm_page->pg_family, vm_page);
+
+    memset(page_memory, 0, arena->alloc_ptr - page_memory);
+    arena->alloc_ptr = (char *)MM_ARENA_ALIGN((uintptr_t)page_memory);
+}
+
+int
+mm_arena_destroy(mm_arena_t *arena){
+
+    if(mm_vm_page_family_destroy(
+            lookup_page_family_by_name(arena->arena_name)) < 0){
+        return -1;
+    }
+    munmap(arena, sizeof(mm_arena_t));
+    return 0;
+}
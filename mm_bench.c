@@ -0,0 +1,658 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_bench.c
+ *
+ *    Description:  This file implements the micro benchmarks of Memory Manager,
+ *                  every benchmark is run against xcalloc/xfree and glibc calloc/free
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 06:03:18 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "uapi_mm.h"
+
+typedef enum{
+
+    BENCH_ALLOCATOR_LMM,
+    BENCH_ALLOCATOR_GLIBC,
+    BENCH_ALLOCATOR_ARENA,  /*mm_arena_alloc(), cases with bulk teardown only*/
+    BENCH_ALLOCATOR_TYPED,  /*bench_obj_t_alloc(), cases of bench_obj_t only*/
+    BENCH_ALLOCATOR_OBJ_CACHE,  /*mm_obj_cache_alloc(), cases of objects with ctor only*/
+    BENCH_ALLOCATOR_MAX
+} bench_allocator_t;
+
+static const char *bench_allocator_names[] =
+    {"xcalloc", "calloc", "arena", "typed", "objcache"};
+
+#define BENCH_MAX_FAMILIES  256
+#define BENCH_DEFAULT_OBJECTS   20000
+
+typedef struct bench_family_{
+
+    char struct_name[MM_MAX_STRUCT_NAME];
+    uint32_t struct_size;
+} bench_family_t;
+
+typedef struct bench_ctx_{
+
+    bench_allocator_t allocator;
+    mm_arena_t *arena;
+    mm_obj_cache_t *obj_cache;
+    uint32_t no_of_objects;     /*Working set size of a benchmark*/
+    bench_family_t families[BENCH_MAX_FAMILIES];
+    uint32_t no_of_families;
+    void **objs;
+    uint64_t no_of_ops;
+    uint64_t peak_footprint;    /*Sampled for glibc*/
+    uint64_t untimed_ns;        /*Benchmark setup excluded from ns/op*/
+} bench_ctx_t;
+
+typedef struct bench_case_{
+
+    const char *name;
+    void (*run)(bench_ctx_t *ctx);
+    int arena;      /*Frees everything with bench_free_all(), run on arena too*/
+    int typed;      /*Allocates bench_obj_t only, run on typed allocator too*/
+    int obj_cache;  /*Allocates objects with a ctor only, run on object cache too*/
+} bench_case_t;
+
+static uint64_t
+bench_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*xorshift, so that glibc rand() state does not differ between runs*/
+static uint32_t
+bench_rand(){
+
+    static uint32_t seed = 2463534242U;
+
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+typedef struct bench_obj_{
+
+    char data[64];
+} bench_obj_t;
+
+MM_DEFINE_TYPED_ALLOCATOR(bench_obj_t)
+
+static void
+bench_add_family(bench_ctx_t *ctx, const char *struct_name,
+                 uint32_t struct_size){
+
+    bench_family_t *family = &ctx->families[ctx->no_of_families++];
+
+    strncpy(family->struct_name, struct_name, MM_MAX_STRUCT_NAME - 1);
+    family->struct_size = struct_size;
+
+    if(ctx->allocator == BENCH_ALLOCATOR_LMM ||
+        ctx->allocator == BENCH_ALLOCATOR_TYPED)
+        mm_instantiate_new_page_family(family->struct_name, struct_size);
+}
+
+static inline void *
+bench_alloc(bench_ctx_t *ctx, uint32_t family_index, uint32_t units){
+
+    bench_family_t *family = &ctx->families[family_index];
+
+    ctx->no_of_ops++;
+    if(ctx->allocator == BENCH_ALLOCATOR_LMM)
+        return xcalloc(family->struct_name, units);
+    if(ctx->allocator == BENCH_ALLOCATOR_ARENA)
+        return mm_arena_alloc(ctx->arena, units * family->struct_size);
+    if(ctx->allocator == BENCH_ALLOCATOR_TYPED)
+        return bench_obj_t_alloc();
+    if(ctx->allocator == BENCH_ALLOCATOR_OBJ_CACHE)
+        return mm_obj_cache_alloc(ctx->obj_cache);
+    return calloc(units, family->struct_size);
+}
+
+static inline void *
+bench_alloc_buff(bench_ctx_t *ctx, uint32_t size){
+
+    ctx->no_of_ops++;
+    if(ctx->allocator == BENCH_ALLOCATOR_LMM)
+        return xcalloc_buff(size);
+    return calloc(1, size);
+}
+
+static inline void
+bench_free(bench_ctx_t *ctx, void *ptr){
+
+    ctx->no_of_ops++;
+    if(ctx->allocator == BENCH_ALLOCATOR_LMM)
+        xfree(ptr);
+    else if(ctx->allocator == BENCH_ALLOCATOR_TYPED)
+        bench_obj_t_free(ptr);
+    else if(ctx->allocator == BENCH_ALLOCATOR_OBJ_CACHE)
+        mm_obj_cache_free(ctx->obj_cache, ptr);
+    else
+        free(ptr);
+}
+
+/* Free the first n objects of ctx->objs, arena drops them with one
+ * reset, which is still counted as n operations*/
+static void
+bench_free_all(bench_ctx_t *ctx, uint32_t n){
+
+    uint32_t i;
+
+    if(ctx->allocator == BENCH_ALLOCATOR_ARENA){
+        ctx->no_of_ops += n;
+        mm_arena_reset(ctx->arena);
+        return;
+    }
+    for(i = 0; i < n; i++)
+        bench_free(ctx, ctx->objs[i]);
+}
+
+/* Called by benchmarks at their high water marks. Memory Manager keeps
+ * its own exact peak, glibc footprint can only be sampled*/
+static void
+bench_sample_footprint(bench_ctx_t *ctx){
+
+    uint64_t footprint;
+
+    if(ctx->allocator != BENCH_ALLOCATOR_GLIBC){
+        mm_stats_t stats;
+        mm_get_stats(&stats);
+        footprint = stats.peak_vm_page_memory;
+    }
+    else{
+        struct mallinfo2 mi = mallinfo2();
+        footprint = mi.arena + mi.hblkhd;
+    }
+    if(footprint > ctx->peak_footprint)
+        ctx->peak_footprint = footprint;
+}
+
+static void
+bench_shuffle(void **objs, uint32_t n){
+
+    uint32_t i, j;
+    void *tmp;
+
+    for(i = n - 1; i > 0; i--){
+        j = bench_rand() % (i + 1);
+        tmp = objs[i];
+        objs[i] = objs[j];
+        objs[j] = tmp;
+    }
+}
+
+/*Allocate and immediately free one object*/
+static void
+bench_single(bench_ctx_t *ctx){
+
+    uint32_t i;
+
+    bench_add_family(ctx, "bench_obj_t", sizeof(bench_obj_t));
+
+    for(i = 0; i < ctx->no_of_objects; i++)
+        bench_free(ctx, bench_alloc(ctx, 0, 1));
+    bench_sample_footprint(ctx);
+}
+
+static void
+bench_alloc_all(bench_ctx_t *ctx){
+
+    uint32_t i;
+
+    bench_add_family(ctx, "bench_obj_t", sizeof(bench_obj_t));
+
+    for(i = 0; i < ctx->no_of_objects; i++)
+        ctx->objs[i] = bench_alloc(ctx, 0, 1);
+    bench_sample_footprint(ctx);
+}
+
+static void
+bench_lifo(bench_ctx_t *ctx){
+
+    uint32_t i;
+
+    bench_alloc_all(ctx);
+    for(i = ctx->no_of_objects; i > 0; i--)
+        bench_free(ctx, ctx->objs[i - 1]);
+}
+
+static void
+bench_fifo(bench_ctx_t *ctx){
+
+    uint32_t i;
+
+    bench_alloc_all(ctx);
+    for(i = 0; i < ctx->no_of_objects; i++)
+        bench_free(ctx, ctx->objs[i]);
+}
+
+static void
+bench_random(bench_ctx_t *ctx){
+
+    uint32_t i;
+    uint64_t t0;
+
+    bench_alloc_all(ctx);
+
+    t0 = bench_now_ns();
+    bench_shuffle(ctx->objs, ctx->no_of_objects);
+    ctx->untimed_ns += bench_now_ns() - t0;
+
+    for(i = 0; i < ctx->no_of_objects; i++)
+        bench_free(ctx, ctx->objs[i]);
+}
+
+/* Random replacement in a working set of objects of 5 different sizes,
+ * sizes chosen to straddle the VM page size selection of Memory Manager*/
+static void
+bench_mixed_sizes(bench_ctx_t *ctx){
+
+    uint32_t i, slot;
+    static const uint32_t sizes[] = {16, 72, 200, 1000, 3000};
+    char struct_name[MM_MAX_STRUCT_NAME];
+
+    for(i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++){
+        snprintf(struct_name, sizeof(struct_name), "bench_mixed_%u", sizes[i]);
+        bench_add_family(ctx, struct_name, sizes[i]);
+    }
+
+    memset(ctx->objs, 0, ctx->no_of_objects * sizeof(void *));
+
+    for(i = 0; i < ctx->no_of_objects * 4; i++){
+        slot = bench_rand() % ctx->no_of_objects;
+        if(ctx->objs[slot]){
+            bench_free(ctx, ctx->objs[slot]);
+            ctx->objs[slot] = NULL;
+            continue;
+        }
+        ctx->objs[slot] = bench_alloc(ctx, bench_rand() % ctx->no_of_families, 1);
+    }
+    bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        if(ctx->objs[i])
+            bench_free(ctx, ctx->objs[i]);
+    }
+}
+
+/* Arrays of 1 to 16 units, every other array is freed first so that
+ * the free blocks can not coalesce until the second pass*/
+static void
+bench_multi_unit(bench_ctx_t *ctx){
+
+    uint32_t i;
+
+    bench_add_family(ctx, "bench_elem_t", 24);
+
+    for(i = 0; i < ctx->no_of_objects; i++)
+        ctx->objs[i] = bench_alloc(ctx, 0, 1 + (bench_rand() % 16));
+    bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        if(i % 2)
+            bench_free(ctx, ctx->objs[i]);
+    }
+    for(i = 0; i < ctx->no_of_objects; i++){
+        if(!(i % 2))
+            bench_free(ctx, ctx->objs[i]);
+    }
+}
+
+/* Objects are sized so that a 4KB VM page holds just one of them, with
+ * the first page pinned every alloc/free pair acquires and releases a
+ * VM page above it*/
+static void
+bench_page_ping_pong(bench_ctx_t *ctx){
+
+    uint32_t i;
+    void *pinned, *obj;
+
+    bench_add_family(ctx, "bench_page_t", 4000);
+
+    pinned = bench_alloc(ctx, 0, 1);
+    for(i = 0; i < ctx->no_of_objects; i++){
+        obj = bench_alloc(ctx, 0, 1);
+        bench_free(ctx, obj);
+    }
+    bench_sample_footprint(ctx);
+    bench_free(ctx, pinned);
+}
+
+/*Round robin over all families, stresses the family lookup by name*/
+static void
+bench_many_families(bench_ctx_t *ctx){
+
+    uint32_t i;
+    char struct_name[MM_MAX_STRUCT_NAME];
+
+    for(i = 0; i < BENCH_MAX_FAMILIES; i++){
+        snprintf(struct_name, sizeof(struct_name), "bench_family_%03u", i);
+        bench_add_family(ctx, struct_name, 16 + (i % 32) * 8);
+    }
+
+    for(i = 0; i < ctx->no_of_objects; i++)
+        ctx->objs[i] = bench_alloc(ctx, i % BENCH_MAX_FAMILIES, 1);
+    bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects; i++)
+        bench_free(ctx, ctx->objs[i]);
+}
+
+/* Random replacement in a working set of byte buffers, sizes spread
+ * evenly over powers of 2 up to 8KB, so most buffers are small*/
+static void
+bench_buffers(bench_ctx_t *ctx){
+
+    uint32_t i, slot, size;
+
+    memset(ctx->objs, 0, ctx->no_of_objects * sizeof(void *));
+
+    for(i = 0; i < ctx->no_of_objects * 4; i++){
+        slot = bench_rand() % ctx->no_of_objects;
+        if(ctx->objs[slot]){
+            bench_free(ctx, ctx->objs[slot]);
+            ctx->objs[slot] = NULL;
+            continue;
+        }
+        size = 1 << (3 + bench_rand() % 10);
+        size += bench_rand() % size;
+        ctx->objs[slot] = bench_alloc_buff(ctx, size);
+    }
+    bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        if(ctx->objs[i])
+            bench_free(ctx, ctx->objs[i]);
+    }
+}
+
+typedef struct bench_node_{
+
+    struct bench_node_ *child[4];
+    uint32_t type;
+    uint32_t no_of_children;
+} bench_node_t;
+
+#define BENCH_PARSE_TREE_REQUESTS   10
+
+/* Every request builds a parse tree of identifier, expression and list
+ * nodes (all at least sizeof(bench_node_t)), every node hangs under a
+ * random earlier node, then the whole tree is torn down at once*/
+static void
+bench_parse_tree(bench_ctx_t *ctx){
+
+    uint32_t i, r, parent;
+    bench_node_t *node;
+    static const uint32_t node_sizes[] = {48, 64, 112};
+
+    bench_add_family(ctx, "bench_ident_t", node_sizes[0]);
+    bench_add_family(ctx, "bench_expr_t", node_sizes[1]);
+    bench_add_family(ctx, "bench_list_t", node_sizes[2]);
+
+    for(r = 0; r < BENCH_PARSE_TREE_REQUESTS; r++){
+
+        for(i = 0; i < ctx->no_of_objects; i++){
+
+            node = bench_alloc(ctx, bench_rand() % 3, 1);
+            node->type = i;
+            ctx->objs[i] = node;
+
+            if(!i)
+                continue;
+            parent = bench_rand() % i;
+            node = ctx->objs[parent];
+            if(node->no_of_children < 4)
+                node->child[node->no_of_children++] = ctx->objs[i];
+        }
+        bench_sample_footprint(ctx);
+        bench_free_all(ctx, ctx->no_of_objects);
+    }
+}
+
+typedef struct bench_session_{
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    char *scratch;      /*Preallocated sub-buffer*/
+    uint64_t no_of_requests;
+} bench_session_t;
+
+#define BENCH_SESSION_SCRATCH_SIZE  512
+
+static void
+bench_session_ctor(void *obj){
+
+    bench_session_t *session = obj;
+
+    pthread_mutex_init(&session->lock, NULL);
+    pthread_cond_init(&session->cond, NULL);
+    session->scratch = calloc(1, BENCH_SESSION_SCRATCH_SIZE);
+}
+
+static void
+bench_session_dtor(void *obj){
+
+    bench_session_t *session = obj;
+
+    pthread_mutex_destroy(&session->lock);
+    pthread_cond_destroy(&session->cond);
+    free(session->scratch);
+}
+
+/* Random replacement in a working set of sessions, which embed a mutex,
+ * a condition variable and a sub-buffer. Object cache hands sessions
+ * out constructed, the others construct every session they allocate
+ * and destruct every session they free*/
+static void
+bench_ctor_obj(bench_ctx_t *ctx){
+
+    uint32_t i, slot;
+    bench_session_t *session;
+    int obj_cache = ctx->allocator == BENCH_ALLOCATOR_OBJ_CACHE;
+
+    if(obj_cache){
+        ctx->obj_cache = mm_obj_cache_create("bench_session_t",
+            sizeof(bench_session_t), bench_session_ctor, bench_session_dtor);
+    }
+    else{
+        bench_add_family(ctx, "bench_session_t", sizeof(bench_session_t));
+    }
+
+    memset(ctx->objs, 0, ctx->no_of_objects * sizeof(void *));
+
+    for(i = 0; i < ctx->no_of_objects * 4; i++){
+
+        slot = bench_rand() % ctx->no_of_objects;
+        session = ctx->objs[slot];
+
+        if(session){
+            if(!obj_cache)
+                bench_session_dtor(session);
+            bench_free(ctx, session);
+            ctx->objs[slot] = NULL;
+            continue;
+        }
+
+        session = bench_alloc(ctx, 0, 1);
+        if(!obj_cache)
+            bench_session_ctor(session);
+        pthread_mutex_lock(&session->lock);
+        session->no_of_requests++;
+        session->scratch[0] = (char)i;
+        pthread_mutex_unlock(&session->lock);
+        ctx->objs[slot] = session;
+    }
+    bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        if(!ctx->objs[i])
+            continue;
+        if(!obj_cache)
+            bench_session_dtor(ctx->objs[i]);
+        bench_free(ctx, ctx->objs[i]);
+    }
+
+    if(obj_cache)
+        mm_obj_cache_destroy(ctx->obj_cache);
+}
+
+static bench_case_t bench_cases[] = {
+
+    {"single",          bench_single,           0, 1, 0},
+    {"lifo",            bench_lifo,             0, 1, 0},
+    {"fifo",            bench_fifo,             0, 1, 0},
+    {"random",          bench_random,           0, 1, 0},
+    {"mixed_sizes",     bench_mixed_sizes,      0, 0, 0},
+    {"multi_unit",      bench_multi_unit,       0, 0, 0},
+    {"page_ping_pong",  bench_page_ping_pong,   0, 0, 0},
+    {"many_families",   bench_many_families,    0, 0, 0},
+    {"parse_tree",      bench_parse_tree,       1, 0, 0},
+    {"buffers",         bench_buffers,          0, 0, 0},
+    {"ctor_obj",        bench_ctor_obj,         0, 0, 1},
+};
+
+#define BENCH_NO_OF_CASES   (sizeof(bench_cases)/sizeof(bench_cases[0]))
+
+static void
+bench_run_case(bench_case_t *bench_case, bench_allocator_t allocator,
+               uint32_t no_of_objects){
+
+    bench_ctx_t ctx;
+    uint64_t t0, elapsed_ns;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.allocator = allocator;
+    ctx.no_of_objects = no_of_objects;
+    ctx.objs = mmap(NULL, no_of_objects * sizeof(void *),
+                    PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(ctx.objs == MAP_FAILED){
+        printf("Error : %s() mmap failed\n", __FUNCTION__);
+        return;
+    }
+
+    if(allocator != BENCH_ALLOCATOR_GLIBC)
+        mm_init();
+
+    if(allocator == BENCH_ALLOCATOR_ARENA)
+        ctx.arena = mm_arena_create("bench_arena");
+
+    t0 = bench_now_ns();
+    bench_case->run(&ctx);
+    elapsed_ns = bench_now_ns() - t0 - ctx.untimed_ns;
+
+    printf("%-16s %-8s %12" PRIu64 " %10.1f %12" PRIu64 "\n",
+        bench_case->name, bench_allocator_names[allocator],
+        ctx.no_of_ops,
+        ctx.no_of_ops ? (double)elapsed_ns / (double)ctx.no_of_ops : 0.0,
+        ctx.peak_footprint / getpagesize());
+}
+
+static void
+bench_usage(const char *prog_name){
+
+    printf("Usage : %s [-n no_of_objects] [case ...]\n\tcases :", prog_name);
+    for(uint32_t i = 0; i < BENCH_NO_OF_CASES; i++)
+        printf(" %s", bench_cases[i].name);
+    printf("\n");
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, i, j;
+    uint32_t k, no_of_objects = BENCH_DEFAULT_OBJECTS;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1){
+        switch(opt){
+            case 'n':
+                no_of_objects = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                bench_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(!no_of_objects){
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    printf("%-16s %-8s %12s %10s %12s\n",
+        "benchmark", "alloc", "ops", "ns/op", "peak pages");
+
+    for(k = 0; k < BENCH_NO_OF_CASES; k++){
+
+        if(optind < argc){
+            for(i = optind; i < argc; i++){
+                if(!strcmp(argv[i], bench_cases[k].name))
+                    break;
+            }
+            if(i == argc)
+                continue;
+        }
+
+        /* Every run gets a fresh process, so that heap left behind by
+         * one run does not distort the next one*/
+        for(j = 0; j < BENCH_ALLOCATOR_MAX; j++){
+
+            if((j == BENCH_ALLOCATOR_ARENA && !bench_cases[k].arena) ||
+                (j == BENCH_ALLOCATOR_TYPED && !bench_cases[k].typed) ||
+                (j == BENCH_ALLOCATOR_OBJ_CACHE && !bench_cases[k].obj_cache))
+                continue;
+
+            fflush(stdout);
+            pid_t pid = fork();
+
+            if(pid < 0){
+                printf("Error : fork failed\n");
+                return 1;
+            }
+            if(!pid){
+                bench_run_case(&bench_cases[k], (bench_allocator_t)j,
+                    no_of_objects);
+                fflush(stdout);
+                _exit(0);
+            }
+            waitpid(pid, NULL, 0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,417 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_cpp_bench.cpp
+ *
+ *    Description:  This file implements the benchmarks of the C++ interface of Memory
+ *                  Manager, every benchmark is run against std::allocator too, pmr ones
+ *                  against new_delete_resource() and monotonic_buffer_resource
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 06:41:15 PM
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <ctime>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <malloc.h>
+#include <sys/wait.h>
+#include "uapi_mm.hpp"
+
+#define CPP_BENCH_DEFAULT_OBJECTS   20000
+
+typedef enum{
+
+    CPP_BENCH_ALLOCATOR_STD,        /*std::allocator, new_delete_resource() or new*/
+    CPP_BENCH_ALLOCATOR_LMM,        /*mm::family_allocator, mm::memory_resource or mm::pooled*/
+    CPP_BENCH_ALLOCATOR_MONOTONIC,  /*std::pmr::monotonic_buffer_resource*/
+    CPP_BENCH_ALLOCATOR_ARENA,      /*mm::memory_resource in arena mode*/
+    CPP_BENCH_ALLOCATOR_MAX
+} cpp_bench_allocator_t;
+
+static const char *cpp_bench_allocator_names[CPP_BENCH_ALLOCATOR_MAX] =
+    {"std", "lmm", "monotonic", "arena"};
+
+typedef struct cpp_bench_ctx_{
+
+    cpp_bench_allocator_t allocator;
+    uint32_t no_of_objects;     /*Working set size of a benchmark*/
+    uint64_t no_of_ops;         /*Container operations*/
+    uint64_t peak_footprint;    /*Sampled for glibc*/
+} cpp_bench_ctx_t;
+
+typedef struct cpp_bench_case_{
+
+    const char *name;
+    void (*run[CPP_BENCH_ALLOCATOR_MAX])(cpp_bench_ctx_t *ctx);    /*NULL if not run*/
+} cpp_bench_case_t;
+
+static uint64_t
+cpp_bench_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*xorshift, so that both runs see the same keys*/
+static uint32_t
+cpp_bench_rand(){
+
+    static uint32_t seed = 2463534242U;
+
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static void
+cpp_bench_sample_footprint(cpp_bench_ctx_t *ctx){
+
+    uint64_t footprint;
+
+    if(ctx->allocator == CPP_BENCH_ALLOCATOR_LMM ||
+        ctx->allocator == CPP_BENCH_ALLOCATOR_ARENA){
+        mm_stats_t stats;
+        mm_get_stats(&stats);
+        footprint = stats.peak_vm_page_memory;
+    }
+    else{
+        struct mallinfo2 mi = mallinfo2();
+        footprint = mi.arena + mi.hblkhd;
+    }
+    if(footprint > ctx->peak_footprint)
+        ctx->peak_footprint = footprint;
+}
+
+/* Fill the map with random keys, then erase a random key and insert
+ * another one, no_of_objects * 10 times, then erase all*/
+template <typename Alloc>
+static void
+cpp_bench_map(cpp_bench_ctx_t *ctx){
+
+    std::map<uint32_t, uint64_t, std::less<uint32_t>, Alloc> map;
+    uint32_t i;
+
+    while(map.size() < ctx->no_of_objects){
+        map.emplace(cpp_bench_rand(), 0);
+        ctx->no_of_ops++;
+    }
+    cpp_bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects * 10; i++){
+        auto it = map.lower_bound(cpp_bench_rand());
+        if(it == map.end())
+            it = map.begin();
+        map.erase(it);
+        map.emplace(cpp_bench_rand(), i);
+        ctx->no_of_ops += 2;
+    }
+
+    ctx->no_of_ops += map.size();
+    map.clear();
+}
+
+template <typename Alloc>
+static void
+cpp_bench_unordered_map(cpp_bench_ctx_t *ctx){
+
+    std::unordered_map<uint32_t, uint64_t, std::hash<uint32_t>,
+        std::equal_to<uint32_t>, Alloc> map;
+    uint32_t i, key;
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        map.emplace(i, 0);
+        ctx->no_of_ops++;
+    }
+    cpp_bench_sample_footprint(ctx);
+
+    /*Keys stay in [0, 2 * no_of_objects)*/
+    for(i = 0; i < ctx->no_of_objects * 10; i++){
+        key = cpp_bench_rand() % (2 * ctx->no_of_objects);
+        if(!map.erase(key))
+            map.emplace(key, i);
+        ctx->no_of_ops++;
+    }
+
+    ctx->no_of_ops += map.size();
+    map.clear();
+}
+
+/*Queue of messages, pushed at the back and popped from the front*/
+template <typename Alloc>
+static void
+cpp_bench_list(cpp_bench_ctx_t *ctx){
+
+    std::list<std::pair<uint64_t, uint64_t>, Alloc> list;
+    uint32_t i;
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        list.emplace_back(i, i);
+        ctx->no_of_ops++;
+    }
+    cpp_bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects * 10; i++){
+        list.pop_front();
+        list.emplace_back(i, i);
+        ctx->no_of_ops += 2;
+    }
+
+    ctx->no_of_ops += list.size();
+    list.clear();
+}
+
+/*Session objects allocated and freed by new and delete*/
+typedef struct cpp_bench_session_{
+
+    uint64_t id;
+    uint64_t last_seen;
+    char peer[48];
+} cpp_bench_session_t;
+
+struct cpp_bench_pooled_session : public cpp_bench_session_t,
+                                  public mm::pooled<cpp_bench_pooled_session>{
+};
+
+/*Random replacement in a working set of sessions, then delete all*/
+template <typename Session>
+static void
+cpp_bench_new_delete(cpp_bench_ctx_t *ctx){
+
+    uint32_t i, j;
+    Session **sessions = new Session *[ctx->no_of_objects];
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        sessions[i] = new Session();
+        ctx->no_of_ops++;
+    }
+    cpp_bench_sample_footprint(ctx);
+
+    for(i = 0; i < ctx->no_of_objects * 10; i++){
+        j = cpp_bench_rand() % ctx->no_of_objects;
+        delete sessions[j];
+        sessions[j] = new Session();
+        ctx->no_of_ops += 2;
+    }
+
+    for(i = 0; i < ctx->no_of_objects; i++){
+        delete sessions[i];
+        ctx->no_of_ops++;
+    }
+    delete[] sessions;
+}
+
+/* Request scoped trees : a map of strings and a vector of ints per
+ * request, built and thrown away all at once, no_of_objects / 10
+ * requests of 100 entries each. The resource is released after every
+ * request, which frees nothing but the arena and the monotonic buffer*/
+static void
+cpp_bench_pmr_tree(cpp_bench_ctx_t *ctx, std::pmr::memory_resource *resource,
+                   void (*release)(std::pmr::memory_resource *resource)){
+
+    uint32_t i, k, len;
+    char str[64];
+
+    for(i = 0; i < ctx->no_of_objects / 10; i++){
+
+        {
+            std::pmr::map<uint32_t, std::pmr::string> map(resource);
+            std::pmr::vector<uint32_t> vector(resource);
+
+            for(k = 0; k < 100; k++){
+                len = 24 + cpp_bench_rand() % 40;
+                memset(str, 'a' + k % 26, len);
+                str[len] = '\0';
+                map.emplace(cpp_bench_rand(), str);
+                vector.push_back(k);
+                ctx->no_of_ops += 2;
+            }
+            if(i == 0)
+                cpp_bench_sample_footprint(ctx);
+        }
+        if(release)
+            release(resource);
+    }
+}
+
+static void
+cpp_bench_pmr_tree_std(cpp_bench_ctx_t *ctx){
+
+    cpp_bench_pmr_tree(ctx, std::pmr::new_delete_resource(), NULL);
+}
+
+static void
+cpp_bench_pmr_tree_lmm(cpp_bench_ctx_t *ctx){
+
+    mm::memory_resource resource;
+
+    cpp_bench_pmr_tree(ctx, &resource, NULL);
+}
+
+static void
+cpp_bench_pmr_tree_monotonic(cpp_bench_ctx_t *ctx){
+
+    std::pmr::monotonic_buffer_resource resource;
+
+    cpp_bench_pmr_tree(ctx, &resource, [](std::pmr::memory_resource *r){
+        static_cast<std::pmr::monotonic_buffer_resource *>(r)->release();
+    });
+}
+
+static void
+cpp_bench_pmr_tree_arena(cpp_bench_ctx_t *ctx){
+
+    mm::memory_resource resource("cpp_bench_arena");
+
+    cpp_bench_pmr_tree(ctx, &resource, [](std::pmr::memory_resource *r){
+        static_cast<mm::memory_resource *>(r)->release();
+    });
+}
+
+typedef std::pair<const uint32_t, uint64_t> cpp_bench_map_value_t;
+typedef std::pair<uint64_t, uint64_t> cpp_bench_list_value_t;
+
+static cpp_bench_case_t cpp_bench_cases[] = {
+
+    {"map",             {cpp_bench_map<std::allocator<cpp_bench_map_value_t>>,
+                         cpp_bench_map<mm::family_allocator<cpp_bench_map_value_t>>}},
+    {"unordered_map",   {cpp_bench_unordered_map<std::allocator<cpp_bench_map_value_t>>,
+                         cpp_bench_unordered_map<mm::family_allocator<cpp_bench_map_value_t>>}},
+    {"list",            {cpp_bench_list<std::allocator<cpp_bench_list_value_t>>,
+                         cpp_bench_list<mm::family_allocator<cpp_bench_list_value_t>>}},
+    {"new_delete",      {cpp_bench_new_delete<cpp_bench_session_t>,
+                         cpp_bench_new_delete<cpp_bench_pooled_session>}},
+    {"pmr_tree",        {cpp_bench_pmr_tree_std, cpp_bench_pmr_tree_lmm,
+                         cpp_bench_pmr_tree_monotonic, cpp_bench_pmr_tree_arena}},
+};
+
+#define CPP_BENCH_NO_OF_CASES   (sizeof(cpp_bench_cases)/sizeof(cpp_bench_cases[0]))
+
+static void
+cpp_bench_run_case(cpp_bench_case_t *bench_case,
+                   cpp_bench_allocator_t allocator, uint32_t no_of_objects){
+
+    cpp_bench_ctx_t ctx;
+    uint64_t t0, elapsed_ns;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.allocator = allocator;
+    ctx.no_of_objects = no_of_objects;
+
+    if(allocator == CPP_BENCH_ALLOCATOR_LMM ||
+        allocator == CPP_BENCH_ALLOCATOR_ARENA){
+        mm_init();
+    }
+
+    t0 = cpp_bench_now_ns();
+    bench_case->run[allocator](&ctx);
+    elapsed_ns = cpp_bench_now_ns() - t0;
+
+    printf("%-16s %-8s %12" PRIu64 " %10.1f %12" PRIu64 "\n",
+        bench_case->name, cpp_bench_allocator_names[allocator],
+        ctx.no_of_ops,
+        ctx.no_of_ops ? (double)elapsed_ns / (double)ctx.no_of_ops : 0.0,
+        ctx.peak_footprint / getpagesize());
+}
+
+static void
+cpp_bench_usage(const char *prog_name){
+
+    printf("Usage : %s [-n no_of_objects] [benchmark ...]\n\tbenchmarks :",
+        prog_name);
+    for(uint32_t i = 0; i < CPP_BENCH_NO_OF_CASES; i++)
+        printf(" %s", cpp_bench_cases[i].name);
+    printf("\n");
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, i, j;
+    uint32_t k, no_of_objects = CPP_BENCH_DEFAULT_OBJECTS;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1){
+        switch(opt){
+            case 'n':
+                no_of_objects = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                cpp_bench_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(!no_of_objects){
+        cpp_bench_usage(argv[0]);
+        return 1;
+    }
+
+    printf("%-16s %-8s %12s %10s %12s\n",
+        "benchmark", "alloc", "ops", "ns/op", "peak pages");
+
+    for(k = 0; k < CPP_BENCH_NO_OF_CASES; k++){
+
+        if(optind < argc){
+            for(i = optind; i < argc; i++){
+                if(!strcmp(argv[i], cpp_bench_cases[k].name))
+                    break;
+            }
+            if(i == argc)
+                continue;
+        }
+
+        /*Every run gets a fresh process, as in mm_bench*/
+        for(j = 0; j < CPP_BENCH_ALLOCATOR_MAX; j++){
+
+            if(!cpp_bench_cases[k].run[j])
+                continue;
+
+            fflush(stdout);
+            pid_t pid = fork();
+
+            if(pid < 0){
+                printf("Error : fork failed\n");
+                return 1;
+            }
+            if(!pid){
+                cpp_bench_run_case(&cpp_bench_cases[k],
+                    (cpp_bench_allocator_t)j, no_of_objects);
+                fflush(stdout);
+                _exit(0);
+            }
+            waitpid(pid, NULL, 0);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_epoch.c
+ *
+ *    Description:  This file implements the epoch based deferred frees of Memory
+ *                  Manager, for objects which lock free readers may still be reading
+ *
+ *        Version:  1.0
+ *        Created:  10/20/2026 12:36:18 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "mm.h"
+
+/* Global epoch only advances once every thread inside a read side
+ * critical section has observed the current epoch. An object deferred
+ * at epoch e was unlinked before, readers which may still hold it
+ * entered at epoch e at the latest, so it is freed once the global epoch
+ * reaches e + 2. Deferred objects of a thread are queued on one of
+ * MM_EPOCH_LIMBO_LISTS lists by epoch, through the priority thread glue
+ * of their meta blocks which is unused while a block is allocated*/
+#define MM_EPOCH_LIMBO_LISTS        3
+/*Deferred frees of a thread between two attempts to advance the epoch*/
+#define MM_EPOCH_ADVANCE_INTERVAL   64
+/*Objects handed to xfree_bulk() at once*/
+#define MM_EPOCH_FREE_BATCH         256
+
+/*Deferred objects are counted as idle blocks by their family*/
+#define MM_EPOCH_GET_FAMILY(block_meta_data)    \
+    (MM_GET_PAGE_FROM_META_BLOCK(block_meta_data)->pg_family)
+
+/*Epoch announced by a thread in a critical section is epoch << 1 | 1*/
+#define MM_EPOCH_ACTIVE             1ULL
+
+typedef struct mm_epoch_thread_{
+
+    struct mm_epoch_thread_ *next;
+    uint64_t local_epoch;       /*0 outside of critical sections*/
+    uint32_t nesting;
+    uint32_t in_use;            /*Owned by a live thread*/
+    uint32_t no_of_deferred;    /*Since the last attempt to advance the epoch*/
+    glthread_t limbo_list_head[MM_EPOCH_LIMBO_LISTS];
+    uint64_t limbo_epoch[MM_EPOCH_LIMBO_LISTS];
+} mm_epoch_thread_t;
+
+/*Starts past the epochs limbo lists of new records are tagged with*/
+static uint64_t gb_epoch = MM_EPOCH_LIMBO_LISTS;
+
+/* Records are never freed, the record of an exited thread is taken over
+ * with its deferred objects by the next thread needing one*/
+static mm_epoch_thread_t *gb_epoch_threads = NULL;
+static __thread mm_epoch_thread_t *mm_epoch_thread_self = NULL;
+static pthread_key_t mm_epoch_thread_key;
+static pthread_once_t mm_epoch_thread_key_once = PTHREAD_ONCE_INIT;
+
+static void
+mm_epoch_thread_exit(void *arg){
+
+    mm_epoch_thread_t *epoch_thread = arg;
+
+    __atomic_store_n(&epoch_thread->local_epoch, 0, __ATOMIC_RELEASE);
+    epoch_thread->nesting = 0;
+    __atomic_store_n(&epoch_thread->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void
+mm_epoch_thread_key_create(){
+
+    pthread_key_create(&mm_epoch_thread_key, mm_epoch_thread_exit);
+}
+
+/* Records are taken directly from the kernel, not from heap segment, as
+ * trace rings are*/
+static mm_epoch_thread_t *
+mm_epoch_get_thread(){
+
+    uint32_t i, in_use;
+    mm_epoch_thread_t *epoch_thread = mm_epoch_thread_self;
+
+    if(epoch_thread)
+        return epoch_thread;
+
+    pthread_once(&mm_epoch_thread_key_once, mm_epoch_thread_key_create);
+
+    for(epoch_thread = __atomic_load_n(&gb_epoch_threads, __ATOMIC_ACQUIRE);
+        epoch_thread; epoch_thread = epoch_thread->next){
+
+        in_use = 0;
+        if(__atomic_compare_exchange_n(&epoch_thread->in_use, &in_use, 1,
+            0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)){
+            break;
+        }
+    }
+
+    if(!epoch_thread){
+
+        epoch_thread = mmap(NULL, sizeof(mm_epoch_thread_t),
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(epoch_thread == MAP_FAILED)
+            return NULL;
+
+        epoch_thread->in_use = 1;
+        for(i = 0; i < MM_EPOCH_LIMBO_LISTS; i++)
+            init_glthread(&epoch_thread->limbo_list_head[i]);
+
+        epoch_thread->next = __atomic_load_n(&gb_epoch_threads, __ATOMIC_ACQUIRE);
+        while(!__atomic_compare_exchange_n(&gb_epoch_threads,
+                &epoch_thread->next, epoch_thread,
+                0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+    }
+
+    pthread_setspecific(mm_epoch_thread_key, epoch_thread);
+    mm_epoch_thread_self = epoch_thread;
+    return epoch_thread;
+}
+
+void
+mm_epoch_enter(){
+
+    mm_epoch_thread_t *epoch_thread = mm_epoch_get_thread();
+
+    if(!epoch_thread || epoch_thread->nesting++)
+        return;
+
+    /*Announcement must be visible before any shared object is read*/
+    __atomic_store_n(&epoch_thread->local_epoch,
+        __atomic_load_n(&gb_epoch, __ATOMIC_ACQUIRE) << 1 | MM_EPOCH_ACTIVE,
+        __ATOMIC_SEQ_CST);
+}
+
+void
+mm_epoch_exit(){
+
+    mm_epoch_thread_t *epoch_thread = mm_epoch_thread_self;
+
+    if(!epoch_thread || !epoch_thread->nesting || --epoch_thread->nesting)
+        return;
+
+    __atomic_store_n(&epoch_thread->local_epoch, 0, __ATOMIC_RELEASE);
+}
+
+/*Advance the global epoch if every active thread has observed it*/
+static uint64_t
+mm_epoch_try_advance(){
+
+    uint64_t local_epoch;
+    mm_epoch_thread_t *epoch_thread;
+    uint64_t epoch = __atomic_load_n(&gb_epoch, __ATOMIC_SEQ_CST);
+
+    for(epoch_thread = __atomic_load_n(&gb_epoch_threads, __ATOMIC_ACQUIRE);
+        epoch_thread; epoch_thread = epoch_thread->next){
+
+        local_epoch = __atomic_load_n(&epoch_thread->local_epoch,
+                        __ATOMIC_SEQ_CST);
+
+        if((local_epoch & MM_EPOCH_ACTIVE) && (local_epoch >> 1) != epoch)
+            return epoch;
+    }
+
+    if(__atomic_compare_exchange_n(&gb_epoch, &epoch, epoch + 1,
+        0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)){
+        epoch++;
+    }
+    return epoch;
+}
+
+/* Objects are pulled off the limbo list in batches and freed with
+ * xfree_bulk(), so that objects deferred together, which tend to share
+ * VM pages, release their VM pages in one go*/
+static void
+mm_epoch_free_limbo_list(glthread_t *limbo_list_head){
+
+    int count;
+    glthread_t *curr;
+    block_meta_data_t *block_meta_data;
+    void *objs[MM_EPOCH_FREE_BATCH];
+
+    while(!IS_GLTHREAD_LIST_EMPTY(limbo_list_head)){
+
+        count = 0;
+        while(count < MM_EPOCH_FREE_BATCH && (curr = BASE(limbo_list_head))){
+            remove_glthread(curr);
+            block_meta_data = glthread_to_block_meta_data(curr);
+            MM_COUNTER_SUB(MM_EPOCH_GET_FAMILY(block_meta_data)->
+                no_of_idle_blocks, 1);
+            MM_COUNTER_SUB(MM_EPOCH_GET_FAMILY(block_meta_data)->
+                no_of_deferred_blocks, 1);
+            objs[count++] = (void *)(block_meta_data + 1);
+        }
+        xfree_bulk(objs, count);
+    }
+}
+
+/*Free the limbo lists of the thread deferred 2 epochs ago or before*/
+static void
+mm_epoch_reclaim(mm_epoch_thread_t *epoch_thread, uint64_t epoch){
+
+    uint32_t i;
+
+    for(i = 0; i < MM_EPOCH_LIMBO_LISTS; i++){
+
+        if(epoch_thread->limbo_epoch[i] + 2 <= epoch)
+            mm_epoch_free_limbo_list(&epoch_thread->limbo_list_head[i]);
+    }
+}
+
+void
+xfree_deferred(void *app_data){
+
+    uint32_t limbo_list;
+    uint64_t epoch;
+    block_meta_data_t *block_meta_data = (block_meta_data_t *)app_data - 1;
+    mm_epoch_thread_t *epoch_thread = mm_epoch_get_thread();
+
+    /*Without a record, nothing tells when the object is unused*/
+    if(!epoch_thread){
+        printf("Error : %s() No epoch record, object %p is leaked\n",
+            __FUNCTION__, app_data);
+        return;
+    }
+
+    if(block_meta_data->is_free == MM_TRUE ||
+        !IS_GLTHREAD_LIST_EMPTY(&block_meta_data->priority_thread_glue)){
+        printf("!Double Free detected\n");
+        assert(0);
+    }
+
+    if(++epoch_thread->no_of_deferred >= MM_EPOCH_ADVANCE_INTERVAL){
+        epoch_thread->no_of_deferred = 0;
+        epoch = mm_epoch_try_advance();
+    }
+    else{
+        epoch = __atomic_load_n(&gb_epoch, __ATOMIC_SEQ_CST);
+    }
+
+    limbo_list = epoch % MM_EPOCH_LIMBO_LISTS;
+
+    /*List of the epoch was last used 3 epochs ago or before*/
+    if(epoch_thread->limbo_epoch[limbo_list] != epoch){
+        mm_epoch_reclaim(epoch_thread, epoch);
+        epoch_thread->limbo_epoch[limbo_list] = epoch;
+    }
+
+    glthread_add_next(&epoch_thread->limbo_list_head[limbo_list],
+        &block_meta_data->priority_thread_glue);
+    MM_COUNTER_ADD(MM_EPOCH_GET_FAMILY(block_meta_data)->no_of_idle_blocks, 1);
+    MM_COUNTER_ADD(MM_EPOCH_GET_FAMILY(block_meta_data)->
+        no_of_deferred_blocks, 1);
+}
+
+int
+mm_epoch_barrier(){
+
+    uint32_t i;
+    vm_bool_t pending;
+    mm_epoch_thread_t *epoch_thread = mm_epoch_get_thread();
+
+    /*The epoch would never get past the one of the caller*/
+    if(!epoch_thread || epoch_thread->nesting)
+        return -1;
+
+    do{
+        mm_epoch_reclaim(epoch_thread, mm_epoch_try_advance());
+
+        pending = MM_FALSE;
+        for(i = 0; i < MM_EPOCH_LIMBO_LISTS; i++){
+            if(!IS_GLTHREAD_LIST_EMPTY(&epoch_thread->limbo_list_head[i]))
+                pending = MM_TRUE;
+        }
+        if(pending)
+            sched_yield();
+    } while(pending);
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_epoch_bench.c
+ *
+ *    Description:  This file implements the benchmark of epoch based deferred frees, a
+ *                  writer replaces the nodes of a table which lock free readers scan
+ *
+ *        Version:  1.0
+ *        Created:  10/20/2026 01:12:54 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include "uapi_mm.h"
+
+typedef struct epoch_node_{
+
+    uint64_t key;
+    uint64_t check;     /*A node zeroed by reuse does not check*/
+    char payload[48];
+} epoch_node_t;
+
+#define EPOCH_BENCH_DEFAULT_SLOTS       4096
+#define EPOCH_BENCH_DEFAULT_UPDATES     2000000
+#define EPOCH_BENCH_DEFAULT_READERS     4
+#define EPOCH_BENCH_MAX_READERS         64
+
+#define EPOCH_BENCH_CHECK(key)  ((key) * 0x9E3779B97F4A7C15ULL + 1)
+
+typedef enum{
+
+    EPOCH_BENCH_XFREE,          /*Reference only, unsafe with readers*/
+    EPOCH_BENCH_XFREE_DEFERRED
+} epoch_bench_mode_t;
+
+static epoch_node_t **epoch_bench_slots;
+static uint32_t epoch_bench_no_of_slots = EPOCH_BENCH_DEFAULT_SLOTS;
+static int epoch_bench_stop;
+
+typedef struct epoch_bench_reader_{
+
+    pthread_t thread;
+    uint64_t no_of_nodes;
+    uint64_t no_of_violations;
+} epoch_bench_reader_t;
+
+static uint64_t
+epoch_bench_now_ns(clockid_t clock_id){
+
+    struct timespec ts;
+    clock_gettime(clock_id, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void *
+epoch_bench_reader_fn(void *arg){
+
+    uint32_t i;
+    epoch_node_t *node;
+    epoch_bench_reader_t *reader = arg;
+
+    while(!__atomic_load_n(&epoch_bench_stop, __ATOMIC_RELAXED)){
+
+        mm_epoch_enter();
+        for(i = 0; i < epoch_bench_no_of_slots; i++){
+
+            node = __atomic_load_n(&epoch_bench_slots[i], __ATOMIC_ACQUIRE);
+            if(node->check != EPOCH_BENCH_CHECK(node->key))
+                reader->no_of_violations++;
+        }
+        mm_epoch_exit();
+        reader->no_of_nodes += epoch_bench_no_of_slots;
+    }
+    return NULL;
+}
+
+static epoch_node_t *
+epoch_bench_node_new(uint64_t key){
+
+    epoch_node_t *node = XCALLOC(1, epoch_node_t);
+
+    if(!node){
+        printf("Error : Out of memory\n");
+        exit(1);
+    }
+    node->key = key;
+    node->check = EPOCH_BENCH_CHECK(key);
+    return node;
+}
+
+static int
+epoch_bench_run(epoch_bench_mode_t mode, uint64_t no_of_updates,
+                int no_of_readers){
+
+    int i;
+    uint64_t n, t0, cpu_t0, writer_ns, elapsed_ns, seed = 88172645463325252ULL;
+    uint64_t no_of_nodes = 0, no_of_violations = 0;
+    epoch_node_t *old_node;
+    mm_family_stats_t family_stats;
+    epoch_bench_reader_t readers[EPOCH_BENCH_MAX_READERS];
+
+    __atomic_store_n(&epoch_bench_stop, 0, __ATOMIC_RELAXED);
+    for(i = 0; i < no_of_readers; i++){
+        readers[i].no_of_nodes = 0;
+        readers[i].no_of_violations = 0;
+        pthread_create(&readers[i].thread, NULL, epoch_bench_reader_fn,
+            &readers[i]);
+    }
+
+    /*Writer cost is its CPU time, readers may share its CPU*/
+    t0 = epoch_bench_now_ns(CLOCK_MONOTONIC);
+    cpu_t0 = epoch_bench_now_ns(CLOCK_THREAD_CPUTIME_ID);
+    for(n = 0; n < no_of_updates; n++){
+
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        old_node = __atomic_exchange_n(
+            &epoch_bench_slots[seed % epoch_bench_no_of_slots],
+            epoch_bench_node_new(n), __ATOMIC_ACQ_REL);
+
+        if(mode == EPOCH_BENCH_XFREE)
+            xfree(old_node);
+        else
+            xfree_deferred(old_node);
+    }
+    writer_ns = epoch_bench_now_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_t0;
+
+    __atomic_store_n(&epoch_bench_stop, 1, __ATOMIC_RELAXED);
+    for(i = 0; i < no_of_readers; i++){
+        pthread_join(readers[i].thread, NULL);
+        no_of_nodes += readers[i].no_of_nodes;
+        no_of_violations += readers[i].no_of_violations;
+    }
+    elapsed_ns = epoch_bench_now_ns(CLOCK_MONOTONIC) - t0;
+
+    if(mode == EPOCH_BENCH_XFREE_DEFERRED)
+        mm_epoch_barrier();
+
+    if(mm_get_family_stats("epoch_node_t", &family_stats) < 0)
+        return 1;
+
+    printf("%-14s %7d %10.1f %12.1f %10" PRIu64 " %10" PRIu64 "\n",
+        mode == EPOCH_BENCH_XFREE ? "xfree" : "xfree_deferred",
+        no_of_readers, (double)writer_ns / no_of_updates,
+        (double)no_of_nodes / elapsed_ns * 1e3,
+        no_of_violations, family_stats.no_of_vm_pages);
+
+    /*Only the nodes in the table are left once deferred frees are done*/
+    return no_of_violations ||
+        family_stats.no_of_allocated_blocks != epoch_bench_no_of_slots;
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, rc = 0;
+    uint32_t i;
+    int no_of_updates = EPOCH_BENCH_DEFAULT_UPDATES;
+    int no_of_readers = EPOCH_BENCH_DEFAULT_READERS;
+
+    while((opt = getopt(argc, argv, "n:r:s:h")) != -1){
+        switch(opt){
+            case 'n':
+                no_of_updates = atoi(optarg);
+                break;
+            case 'r':
+                no_of_readers = atoi(optarg);
+                break;
+            case 's':
+                epoch_bench_no_of_slots = atoi(optarg);
+                break;
+            default:
+                printf("Usage : %s [-n no_of_updates] [-r no_of_readers] "
+                    "[-s no_of_slots]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(no_of_updates < 1 || no_of_readers < 0 ||
+        no_of_readers > EPOCH_BENCH_MAX_READERS || !epoch_bench_no_of_slots){
+        return 1;
+    }
+
+    mm_init();
+    MM_REG_STRUCT(epoch_node_t);
+
+    epoch_bench_slots = calloc(epoch_bench_no_of_slots, sizeof(epoch_node_t *));
+    if(!epoch_bench_slots)
+        return 1;
+    for(i = 0; i < epoch_bench_no_of_slots; i++)
+        epoch_bench_slots[i] = epoch_bench_node_new(i);
+
+    printf("%-14s %7s %10s %12s %10s %10s\n", "free", "readers",
+        "cpu ns/upd", "Mnodes/s", "violations", "VM pages");
+
+    /*xfree() is only safe without readers*/
+    rc |= epoch_bench_run(EPOCH_BENCH_XFREE, no_of_updates, 0);
+    rc |= epoch_bench_run(EPOCH_BENCH_XFREE_DEFERRED, no_of_updates, 0);
+    rc |= epoch_bench_run(EPOCH_BENCH_XFREE_DEFERRED, no_of_updates,
+            no_of_readers);
+    return rc;
+}
@@ -0,0 +1,426 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_frag_stress.c
+ *
+ *    Description:  This file implements the long running fragmentation stress of
+ *                  Memory Manager, it prints the fragmentation metrics computed from
+ *                  the VM page and block lists as a CSV time series
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 07:22:40 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "uapi_mm.h"
+
+typedef struct stress_family_{
+
+    char struct_name[MM_MAX_STRUCT_NAME];
+    uint32_t struct_size;
+} stress_family_t;
+
+static stress_family_t stress_families[] = {
+
+    {"stress_24_t",     24},
+    {"stress_56_t",     56},
+    {"stress_120_t",    120},
+    {"stress_400_t",    400},
+    {"stress_1500_t",   1500},
+};
+
+#define STRESS_NO_OF_FAMILIES   \
+    (sizeof(stress_families)/sizeof(stress_families[0]))
+
+#define STRESS_MAX_UNITS    4
+
+typedef struct stress_obj_{
+
+    void *ptr;
+    mm_handle_t handle;     /*Movable objects, with -c*/
+    uint32_t size;
+} stress_obj_t;
+
+typedef enum{
+
+    STRESS_WORKLOAD_SAW_TOOTH,  /*live set ramps 25% -> 100%, 4 times*/
+    STRESS_WORKLOAD_CHURN       /*live set grows to 100%, drops to 10% and churns*/
+} stress_workload_t;
+
+typedef struct stress_config_{
+
+    stress_workload_t workload;
+    uint64_t no_of_ops;
+    uint64_t interval;
+    uint64_t max_live_objs;
+    uint32_t seed;
+    uint32_t compact_bytes; /*Budget of a compaction step, 0 if off*/
+    int print_series;
+} stress_config_t;
+
+/*Averages are over the samples taken every 'interval' operations*/
+typedef struct stress_summary_{
+
+    uint64_t elapsed_ns;    /*Excludes the sampling*/
+    uint64_t peak_vm_page_memory;
+    uint64_t end_vm_page_memory;    /*Before freeing the live set*/
+    uint64_t no_of_samples;
+    uint64_t sum_vm_page_memory;
+    double sum_page_utilization;
+    double sum_external_fragmentation;
+    uint64_t no_of_failures;
+    uint64_t pages_reclaimed;   /*By compaction*/
+} stress_summary_t;
+
+static uint32_t stress_seed;
+
+static uint32_t
+stress_rand(){
+
+    stress_seed ^= stress_seed << 13;
+    stress_seed ^= stress_seed >> 17;
+    stress_seed ^= stress_seed << 5;
+    return stress_seed;
+}
+
+static uint64_t
+stress_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+stress_sample(stress_config_t *config, stress_summary_t *summary,
+              uint64_t op_index, uint64_t no_of_live_objs,
+              uint64_t live_bytes){
+
+    mm_frag_stats_t frag_stats;
+
+    mm_get_frag_stats(&frag_stats);
+
+    summary->no_of_samples++;
+    summary->sum_vm_page_memory += frag_stats.vm_page_memory;
+    summary->sum_page_utilization += frag_stats.page_utilization;
+    summary->sum_external_fragmentation += frag_stats.external_fragmentation;
+
+    if(!config->print_series)
+        return;
+
+    printf("%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+        ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+        ",%.4f,%.4f,%.4f\n",
+        op_index, no_of_live_objs, live_bytes,
+        frag_stats.no_of_vm_pages, frag_stats.vm_page_memory,
+        frag_stats.app_data_bytes, frag_stats.meta_data_bytes,
+        frag_stats.free_bytes, frag_stats.unusable_bytes,
+        frag_stats.largest_free_block,
+        frag_stats.page_utilization, frag_stats.external_fragmentation,
+        frag_stats.internal_waste);
+}
+
+/*One compaction step per family, once every 'interval' operations*/
+static void
+stress_compact(stress_config_t *config, stress_summary_t *summary){
+
+    uint32_t i;
+    mm_compaction_stats_t compaction_stats;
+
+    for(i = 0; i < STRESS_NO_OF_FAMILIES; i++){
+        mm_compact_step(stress_families[i].struct_name, config->compact_bytes,
+            &compaction_stats);
+        summary->pages_reclaimed += compaction_stats.pages_reclaimed;
+    }
+}
+
+static void
+stress_obj_free(stress_obj_t *obj){
+
+    if(obj->handle)
+        xfree_movable(obj->handle);
+    else
+        xfree(obj->ptr);
+    obj->ptr = NULL;
+    obj->handle = MM_HANDLE_NULL;
+}
+
+static void
+stress_run(stress_config_t *config, mm_placement_policy_t placement_policy,
+           stress_summary_t *summary){
+
+    uint32_t i, slot, units, free_pct;
+    uint64_t op_index, target, period, t0;
+    uint64_t no_of_live_objs = 0, live_bytes = 0;
+    stress_obj_t *objs;
+    stress_family_t *family;
+    mm_stats_t stats;
+
+    memset(summary, 0, sizeof(stress_summary_t));
+    stress_seed = config->seed;
+
+    /*Not from heap segment, so that it does not sit among the VM pages*/
+    objs = mmap(NULL, config->max_live_objs * sizeof(stress_obj_t),
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(objs == MAP_FAILED){
+        printf("Error : mmap failed\n");
+        return;
+    }
+
+    mm_init();
+    for(i = 0; i < STRESS_NO_OF_FAMILIES; i++){
+        mm_instantiate_new_page_family(stress_families[i].struct_name,
+            stress_families[i].struct_size);
+        mm_set_page_family_placement_policy(stress_families[i].struct_name,
+            placement_policy);
+    }
+
+    if(config->print_series){
+        printf("ops,live_objects,live_bytes,vm_pages,vm_page_memory,app_data_bytes,"
+            "meta_data_bytes,free_bytes,unusable_bytes,largest_free_block,"
+            "page_utilization,external_fragmentation,internal_waste\n");
+    }
+
+    period = config->no_of_ops / 4 ? config->no_of_ops / 4 : 1;
+    t0 = stress_now_ns();
+
+    for(op_index = 1; op_index <= config->no_of_ops; op_index++){
+
+        if(config->workload == STRESS_WORKLOAD_SAW_TOOTH){
+            target = config->max_live_objs / 4 +
+                ((config->max_live_objs * 3 / 4) * (op_index % period)) / period;
+        }
+        else{
+            target = op_index < period ?
+                config->max_live_objs : config->max_live_objs / 10;
+        }
+
+        slot = stress_rand() % config->max_live_objs;
+
+        /*Lean towards alloc below the target, towards free above it*/
+        free_pct = no_of_live_objs < target ? 25 : 75;
+
+        if(stress_rand() % 100 < free_pct){
+            /*free, or nothing if the slot is empty*/
+            if(objs[slot].ptr || objs[slot].handle){
+                stress_obj_free(&objs[slot]);
+                live_bytes -= objs[slot].size;
+                no_of_live_objs--;
+            }
+        }
+        else if(!objs[slot].ptr && !objs[slot].handle){
+            family = &stress_families[stress_rand() % STRESS_NO_OF_FAMILIES];
+            units = 1 + (stress_rand() % STRESS_MAX_UNITS);
+            if(config->compact_bytes)
+                objs[slot].handle = xcalloc_movable(family->struct_name, units);
+            else
+                objs[slot].ptr = xcalloc(family->struct_name, units);
+            if(!objs[slot].ptr && !objs[slot].handle){
+                summary->no_of_failures++;
+            }
+            else{
+                objs[slot].size = units * family->struct_size;
+                live_bytes += objs[slot].size;
+                no_of_live_objs++;
+            }
+        }
+
+        if(op_index % config->interval == 0){
+            if(config->compact_bytes)
+                stress_compact(config, summary);
+            summary->elapsed_ns += stress_now_ns() - t0;
+            stress_sample(config, summary, op_index, no_of_live_objs, live_bytes);
+            t0 = stress_now_ns();
+        }
+    }
+    summary->elapsed_ns += stress_now_ns() - t0;
+
+    mm_get_stats(&stats);
+    summary->peak_vm_page_memory = stats.peak_vm_page_memory;
+    summary->end_vm_page_memory = stats.vm_page_memory;
+
+    for(i = 0; i < config->max_live_objs; i++){
+        if(objs[i].ptr || objs[i].handle)
+            stress_obj_free(&objs[i]);
+    }
+
+    mm_get_stats(&stats);
+    if(stats.no_of_vm_pages){
+        printf("Error : %" PRIu64 " VM pages left after freeing everything\n",
+            stats.no_of_vm_pages);
+    }
+}
+
+static void
+stress_print_summary(stress_config_t *config,
+                     mm_placement_policy_t placement_policy,
+                     stress_summary_t *summary){
+
+    uint64_t no_of_samples = summary->no_of_samples ? summary->no_of_samples : 1;
+
+    printf("%-14s %12.0f %12" PRIu64 " %12" PRIu64 " %12.1f %10.4f %10.4f %10" PRIu64
+        " %10" PRIu64 "\n",
+        mm_placement_policy_str(placement_policy),
+        summary->elapsed_ns ?
+            (double)config->no_of_ops * 1e9 / (double)summary->elapsed_ns : 0.0,
+        summary->peak_vm_page_memory / getpagesize(),
+        summary->end_vm_page_memory / getpagesize(),
+        (double)summary->sum_vm_page_memory / no_of_samples / getpagesize(),
+        summary->sum_page_utilization / no_of_samples,
+        summary->sum_external_fragmentation / no_of_samples,
+        summary->no_of_failures, summary->pages_reclaimed);
+}
+
+static void
+stress_usage(const char *prog_name){
+
+    printf("Usage : %s [-n no_of_ops] [-i interval] [-l max_live_objects] [-s seed]\n"
+        "\t\t[-p worst-fit | best-fit | first-fit | fullest-page | all] [-w saw | churn]\n"
+        "\t\t[-c compaction_step_bytes]\n"
+        "\tRandomly allocates and frees 1 to %u unit objects of %u page families,\n"
+        "\tthe live set follows a saw tooth between 25%% and 100%% of max_live_objects,\n"
+        "\tor with -w churn grows to max_live_objects, drops to 10%% and churns there.\n"
+        "\tFragmentation metrics are printed as CSV every 'interval' operations.\n"
+        "\t-p all runs the same workload under every placement policy and prints\n"
+        "\tonly a comparison of throughput, pages and fragmentation.\n"
+        "\t-c allocates movable objects and runs a compaction step of the given\n"
+        "\tbudget on every page family once every 'interval' operations\n",
+        prog_name, STRESS_MAX_UNITS, (uint32_t)STRESS_NO_OF_FAMILIES);
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, all_policies = 0;
+    mm_placement_policy_t placement_policy = MM_PLACEMENT_WORST_FIT;
+    stress_config_t config;
+    stress_summary_t summary;
+
+    config.workload = STRESS_WORKLOAD_SAW_TOOTH;
+    config.no_of_ops = 2000000;
+    config.interval = 20000;
+    config.max_live_objs = 20000;
+    config.seed = 2463534242U;
+    config.compact_bytes = 0;
+    config.print_series = 1;
+
+    while((opt = getopt(argc, argv, "n:i:l:s:p:w:c:h")) != -1){
+        switch(opt){
+            case 'w':
+                if(!strcmp(optarg, "churn")){
+                    config.workload = STRESS_WORKLOAD_CHURN;
+                }
+                else if(strcmp(optarg, "saw")){
+                    stress_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'n':
+                config.no_of_ops = strtoull(optarg, NULL, 10);
+                break;
+            case 'i':
+                config.interval = strtoull(optarg, NULL, 10);
+                break;
+            case 'l':
+                config.max_live_objs = strtoull(optarg, NULL, 10);
+                break;
+            case 's':
+                config.seed = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                config.compact_bytes = strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                if(!strcmp(optarg, "all")){
+                    all_policies = 1;
+                    break;
+                }
+                for(placement_policy = MM_PLACEMENT_WORST_FIT;
+                    placement_policy < MM_PLACEMENT_POLICY_MAX;
+                    placement_policy++){
+                    if(!strcmp(optarg, mm_placement_policy_str(placement_policy)))
+                        break;
+                }
+                if(placement_policy == MM_PLACEMENT_POLICY_MAX){
+                    stress_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                stress_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(!config.no_of_ops || !config.interval ||
+        config.max_live_objs < 4 || !config.seed){
+        stress_usage(argv[0]);
+        return 1;
+    }
+
+    if(!all_policies){
+        stress_run(&config, placement_policy, &summary);
+        fprintf(stderr, "%" PRIu64 " operations, %" PRIu64 " failed allocations, "
+            "%.0f ops/sec, peak %" PRIu64 " pages, %" PRIu64 " pages reclaimed "
+            "by compaction\n", config.no_of_ops,
+            summary.no_of_failures, summary.elapsed_ns ?
+            (double)config.no_of_ops * 1e9 / (double)summary.elapsed_ns : 0.0,
+            summary.peak_vm_page_memory / getpagesize(),
+            summary.pages_reclaimed);
+        return 0;
+    }
+
+    config.print_series = 0;
+    printf("%-14s %12s %12s %12s %12s %10s %10s %10s %10s\n", "placement", "ops/sec",
+        "peak pages", "end pages", "avg pages", "avg util", "avg frag", "failures",
+        "reclaimed");
+
+    /*Same seed, fresh heap segment for every policy*/
+    for(placement_policy = MM_PLACEMENT_WORST_FIT;
+        placement_policy < MM_PLACEMENT_POLICY_MAX;
+        placement_policy++){
+
+        fflush(stdout);
+        pid_t pid = fork();
+
+        if(pid < 0){
+            printf("Error : fork failed\n");
+            return 1;
+        }
+        if(!pid){
+            stress_run(&config, placement_policy, &summary);
+            stress_print_summary(&config, placement_policy, &summary);
+            fflush(stdout);
+            _exit(0);
+        }
+        waitpid(pid, NULL, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,405 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_malloc.c
+ *
+ *    Description:  This file implements the standard malloc family on top of the
+ *                  buffers of Memory Manager, built into libmm_malloc.so to be
+ *                  interposed in unmodified programs with LD_PRELOAD
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 06:21:09 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+/* The library is built with -DMM_MMAP_PAGE_SOURCE, so that VM pages are
+ * mapped rather than carved out of the heap segment which belongs to the
+ * program, and with -fvisibility=hidden, so that only the functions
+ * below are interposed*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "mm.h"
+
+#define MM_MALLOC_API   __attribute__((visibility("default")))
+
+/*Alignment of every buffer of Memory Manager*/
+#define MM_MALLOC_ALIGNMENT     16
+
+#define MM_MALLOC_ALIGN_UP(x, a)    \
+    (((uintptr_t)(x) + (a) - 1) & ~((uintptr_t)(a) - 1))
+
+/* Memory which is not a buffer of its own, that is memory too big for
+ * the biggest VM page, which is mapped directly, and memory aligned
+ * beyond MM_MALLOC_ALIGNMENT, which is carved out of a bigger buffer or
+ * mapping. Such memory is preceded by a chunk header, whose meta block
+ * has offset 0, while a meta block of a buffer never does*/
+typedef struct mm_malloc_chunk_{
+
+    char *base;         /*Mapping, or buffer, holding the chunk*/
+    size_t map_size;    /*Size of the mapping, 0 if base is a buffer*/
+    size_t usable_size;
+    size_t pad;         /*Keeps the size of header a multiple of 16*/
+    block_meta_data_t block_meta_data;
+} mm_malloc_chunk_t;
+
+#define MM_MALLOC_GET_META_BLOCK(ptr)   ((block_meta_data_t *)(ptr) - 1)
+#define MM_MALLOC_GET_CHUNK(ptr)        ((mm_malloc_chunk_t *)(ptr) - 1)
+#define MM_MALLOC_IS_CHUNK(ptr)         \
+    (MM_MALLOC_GET_META_BLOCK(ptr)->offset == 0)
+
+/* Memory Manager is not thread safe, every call is serialized. The lock
+ * is recursive, since an error message printed by Memory Manager may
+ * allocate the stdio buffer*/
+static pthread_mutex_t mm_malloc_lock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static int mm_malloc_initialized = 0;
+static size_t mm_malloc_max_buff_size = 0;
+
+static void
+mm_malloc_fork_prepare(){
+
+    pthread_mutex_lock(&mm_malloc_lock);
+}
+
+static void
+mm_malloc_fork_parent(){
+
+    pthread_mutex_unlock(&mm_malloc_lock);
+}
+
+/*Lock owner does not exist in the child, start with a fresh lock*/
+static void
+mm_malloc_fork_child(){
+
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mm_malloc_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static void
+mm_malloc_lazy_init(){
+
+    if(mm_malloc_initialized)
+        return;
+
+    mm_init();
+    mm_malloc_max_buff_size = mm_get_buff_max_size();
+    mm_malloc_initialized = 1;
+    pthread_atfork(mm_malloc_fork_prepare, mm_malloc_fork_parent,
+        mm_malloc_fork_child);
+}
+
+static void *
+mm_malloc_map_chunk(size_t size, size_t alignment){
+
+    char *base, *ptr;
+    mm_malloc_chunk_t *chunk;
+    size_t map_size;
+
+    if(size > SIZE_MAX - sizeof(mm_malloc_chunk_t) - alignment -
+        GB_SYSTEM_PAGE_SIZE){
+        return NULL;
+    }
+
+    map_size = MM_MALLOC_ALIGN_UP(size + sizeof(mm_malloc_chunk_t) +
+        alignment, GB_SYSTEM_PAGE_SIZE);
+
+    base = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(base == MAP_FAILED)
+        return NULL;
+
+    ptr = (char *)MM_MALLOC_ALIGN_UP(base + sizeof(mm_malloc_chunk_t),
+        alignment);
+    chunk = MM_MALLOC_GET_CHUNK(ptr);
+    memset(chunk, 0, sizeof(mm_malloc_chunk_t));
+    chunk->base = base;
+    chunk->map_size = map_size;
+    chunk->usable_size = base + map_size - ptr;
+    return ptr;
+}
+
+/*Call with lock held*/
+static void *
+mm_malloc_aligned(size_t size, size_t alignment){
+
+    char *base, *ptr;
+    mm_malloc_chunk_t *chunk;
+
+    mm_malloc_lazy_init();
+
+    if(alignment <= MM_MALLOC_ALIGNMENT){
+
+        if(size <= mm_malloc_max_buff_size)
+            return xcalloc_buff((uint32_t)size);
+        return mm_malloc_map_chunk(size, MM_MALLOC_ALIGNMENT);
+    }
+
+    if(size > mm_malloc_max_buff_size ||
+        size + sizeof(mm_malloc_chunk_t) + alignment > mm_malloc_max_buff_size){
+        return mm_malloc_map_chunk(size, alignment);
+    }
+
+    base = xcalloc_buff((uint32_t)(size + sizeof(mm_malloc_chunk_t) + alignment));
+
+    if(!base)
+        return NULL;
+
+    ptr = (char *)MM_MALLOC_ALIGN_UP(base + sizeof(mm_malloc_chunk_t),
+        alignment);
+    chunk = MM_MALLOC_GET_CHUNK(ptr);
+    memset(chunk, 0, sizeof(mm_malloc_chunk_t));
+    chunk->base = base;
+    chunk->map_size = 0;
+    chunk->usable_size = MM_MALLOC_GET_META_BLOCK(base)->block_size -
+        (ptr - base);
+    return ptr;
+}
+
+/*Call with lock held*/
+static void
+mm_malloc_free(void *ptr){
+
+    mm_malloc_chunk_t *chunk;
+
+    if(!MM_MALLOC_IS_CHUNK(ptr)){
+        xfree(ptr);
+        return;
+    }
+
+    chunk = MM_MALLOC_GET_CHUNK(ptr);
+
+    if(chunk->map_size)
+        munmap(chunk->base, chunk->map_size);
+    else
+        xfree(chunk->base);
+}
+
+static size_t
+mm_malloc_usable_size(void *ptr){
+
+    if(MM_MALLOC_IS_CHUNK(ptr))
+        return MM_MALLOC_GET_CHUNK(ptr)->usable_size;
+    return MM_MALLOC_GET_META_BLOCK(ptr)->block_size;
+}
+
+MM_MALLOC_API void *
+malloc(size_t size){
+
+    void *ptr;
+
+    pthread_mutex_lock(&mm_malloc_lock);
+    ptr = mm_malloc_aligned(size, MM_MALLOC_ALIGNMENT);
+    pthread_mutex_unlock(&mm_malloc_lock);
+
+    if(!ptr)
+        errno = ENOMEM;
+    return ptr;
+}
+
+/*Buffers and mappings are zeroed already*/
+MM_MALLOC_API void *
+calloc(size_t nmemb, size_t size){
+
+    if(size && nmemb > SIZE_MAX / size){
+        errno = ENOMEM;
+        return NULL;
+    }
+    return malloc(nmemb * size);
+}
+
+MM_MALLOC_API void
+free(void *ptr){
+
+    if(!ptr)
+        return;
+
+    pthread_mutex_lock(&mm_malloc_lock);
+    mm_malloc_free(ptr);
+    pthread_mutex_unlock(&mm_malloc_lock);
+}
+
+/* Memory is kept if it is big enough and not more than twice of what is
+ * asked for. A mapping grows or shrinks in place if the kernel can. A
+ * buffer which grows is given 50% more than asked for, so that memory
+ * growing little by little is not copied on every call*/
+MM_MALLOC_API void *
+realloc(void *ptr, size_t size){
+
+    void *new_ptr;
+    size_t usable_size, new_size;
+    mm_malloc_chunk_t *chunk;
+
+    if(!ptr)
+        return malloc(size);
+
+    if(!size){
+        free(ptr);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&mm_malloc_lock);
+
+    usable_size = mm_malloc_usable_size(ptr);
+
+    if(size <= usable_size && size >= usable_size / 2){
+        pthread_mutex_unlock(&mm_malloc_lock);
+        return ptr;
+    }
+
+    if(MM_MALLOC_IS_CHUNK(ptr) && size > mm_malloc_max_buff_size){
+
+        chunk = MM_MALLOC_GET_CHUNK(ptr);
+
+        if(chunk->map_size &&
+            (char *)ptr == chunk->base + sizeof(mm_malloc_chunk_t)){
+
+            size_t map_size = MM_MALLOC_ALIGN_UP(size +
+                sizeof(mm_malloc_chunk_t) + MM_MALLOC_ALIGNMENT,
+                GB_SYSTEM_PAGE_SIZE);
+            char *base = mremap(chunk->base, chunk->map_size, map_size,
+                                MREMAP_MAYMOVE);
+
+            if(base != MAP_FAILED){
+                chunk = (mm_malloc_chunk_t *)base;
+                chunk->base = base;
+                chunk->map_size = map_size;
+                chunk->usable_size = map_size - sizeof(mm_malloc_chunk_t);
+                pthread_mutex_unlock(&mm_malloc_lock);
+                return chunk + 1;
+            }
+        }
+    }
+
+    new_size = size;
+    if(size > usable_size && size <= mm_malloc_max_buff_size){
+        new_size = size + size / 2;
+        if(new_size > mm_malloc_max_buff_size)
+            new_size = mm_malloc_max_buff_size;
+    }
+
+    new_ptr = mm_malloc_aligned(new_size, MM_MALLOC_ALIGNMENT);
+
+    if(new_ptr){
+        memcpy(new_ptr, ptr, usable_size < size ? usable_size : size);
+        mm_malloc_free(ptr);
+    }
+
+    pthread_mutex_unlock(&mm_malloc_lock);
+
+    if(!new_ptr)
+        errno = ENOMEM;
+    return new_ptr;
+}
+
+/*glibc's own reallocarray() does not go through an interposed realloc()*/
+MM_MALLOC_API void *
+reallocarray(void *ptr, size_t nmemb, size_t size){
+
+    if(size && nmemb > SIZE_MAX / size){
+        errno = ENOMEM;
+        return NULL;
+    }
+    return realloc(ptr, nmemb * size);
+}
+
+MM_MALLOC_API int
+posix_memalign(void **memptr, size_t alignment, size_t size){
+
+    void *ptr;
+
+    if(!alignment || (alignment & (alignment - 1)) ||
+        alignment % sizeof(void *)){
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&mm_malloc_lock);
+    ptr = mm_malloc_aligned(size, alignment);
+    pthread_mutex_unlock(&mm_malloc_lock);
+
+    if(!ptr)
+        return ENOMEM;
+
+    *memptr = ptr;
+    return 0;
+}
+
+MM_MALLOC_API void *
+memalign(size_t alignment, size_t size){
+
+    void *ptr;
+
+    if(!alignment || (alignment & (alignment - 1))){
+        errno = EINVAL;
+        return NULL;
+    }
+
+    pthread_mutex_lock(&mm_malloc_lock);
+    ptr = mm_malloc_aligned(size, alignment);
+    pthread_mutex_unlock(&mm_malloc_lock);
+
+    if(!ptr)
+        errno = ENOMEM;
+    return ptr;
+}
+
+MM_MALLOC_API void *
+aligned_alloc(size_t alignment, size_t size){
+
+    return memalign(alignment, size);
+}
+
+MM_MALLOC_API void *
+valloc(size_t size){
+
+    return memalign(getpagesize(), size);
+}
+
+MM_MALLOC_API void *
+pvalloc(size_t size){
+
+    size_t page_size = getpagesize();
+
+    return memalign(page_size, MM_MALLOC_ALIGN_UP(size ? size : 1, page_size));
+}
+
+MM_MALLOC_API size_t
+malloc_usable_size(void *ptr){
+
+    size_t usable_size;
+
+    if(!ptr)
+        return 0;
+
+    pthread_mutex_lock(&mm_malloc_lock);
+    usable_size = mm_malloc_usable_size(ptr);
+    pthread_mutex_unlock(&mm_malloc_lock);
+    return usable_size;
+}
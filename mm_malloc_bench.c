@@ -0,0 +1,409 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_malloc_bench.c
+ *
+ *    Description:  This file implements the benchmark of libmm_malloc.so, every
+ *                  workload, or a command given on command line, is run with
+ *                  glibc malloc and with libmm_malloc.so preloaded
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 06:24:52 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+/* The workloads use nothing but the standard malloc family, this program
+ * is not linked with Memory Manager*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#define MALLOC_BENCH_DEFAULT_OBJECTS    20000
+#define MALLOC_BENCH_DEFAULT_LIB        "./libmm_malloc.so"
+#define MALLOC_BENCH_NO_OF_THREADS      4
+
+typedef struct malloc_bench_ctx_{
+
+    uint32_t no_of_objects;     /*Working set size of a workload*/
+    uint64_t no_of_ops;
+    uint32_t seed;
+} malloc_bench_ctx_t;
+
+typedef struct malloc_bench_case_{
+
+    const char *name;
+    void (*run)(malloc_bench_ctx_t *ctx);
+} malloc_bench_case_t;
+
+static uint64_t
+malloc_bench_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/*xorshift, so that both runs of a workload see the same sizes*/
+static uint32_t
+malloc_bench_rand(malloc_bench_ctx_t *ctx){
+
+    ctx->seed ^= ctx->seed << 13;
+    ctx->seed ^= ctx->seed >> 17;
+    ctx->seed ^= ctx->seed << 5;
+    return ctx->seed;
+}
+
+/*Write to the memory, as programs do, so that its pages are touched*/
+static inline void *
+malloc_bench_alloc(malloc_bench_ctx_t *ctx, size_t size){
+
+    char *ptr = malloc(size);
+
+    ctx->no_of_ops++;
+    if(!ptr){
+        printf("Error : malloc(%zu) failed\n", size);
+        exit(1);
+    }
+    ptr[0] = ptr[size - 1] = 1;
+    return ptr;
+}
+
+static inline void
+malloc_bench_free(malloc_bench_ctx_t *ctx, void *ptr){
+
+    ctx->no_of_ops++;
+    free(ptr);
+}
+
+/*Random replacement in a working set of small objects*/
+static void
+malloc_bench_small_churn(malloc_bench_ctx_t *ctx){
+
+    uint32_t i, j, n = ctx->no_of_objects;
+    void **objs = calloc(n, sizeof(void *));
+
+    for(i = 0; i < n; i++)
+        objs[i] = malloc_bench_alloc(ctx, 16 + malloc_bench_rand(ctx) % 240);
+
+    for(i = 0; i < 10 * n; i++){
+        j = malloc_bench_rand(ctx) % n;
+        malloc_bench_free(ctx, objs[j]);
+        objs[j] = malloc_bench_alloc(ctx, 16 + malloc_bench_rand(ctx) % 240);
+    }
+
+    for(i = 0; i < n; i++)
+        malloc_bench_free(ctx, objs[i]);
+    free(objs);
+}
+
+/* Sizes spread evenly over powers of 2 up to 64KB, so most of them are
+ * small, and a few are bigger than any VM page*/
+static void
+malloc_bench_mixed_sizes(malloc_bench_ctx_t *ctx){
+
+    uint32_t i, j, n = ctx->no_of_objects;
+    void **objs = calloc(n, sizeof(void *));
+    size_t size;
+
+    for(i = 0; i < 4 * n; i++){
+        j = malloc_bench_rand(ctx) % n;
+        if(objs[j])
+            malloc_bench_free(ctx, objs[j]);
+        size = (size_t)1 << (3 + malloc_bench_rand(ctx) % 14);
+        objs[j] = malloc_bench_alloc(ctx,
+            size + malloc_bench_rand(ctx) % size);
+    }
+
+    for(i = 0; i < n; i++){
+        if(objs[i])
+            malloc_bench_free(ctx, objs[i]);
+    }
+    free(objs);
+}
+
+/*Strings and vectors growing one element at a time*/
+static void
+malloc_bench_realloc_grow(malloc_bench_ctx_t *ctx){
+
+    uint32_t i, k, n = ctx->no_of_objects / 100 + 1;
+    char *buf;
+    size_t len;
+
+    for(i = 0; i < n; i++){
+
+        buf = NULL;
+        len = 0;
+        for(k = 0; k < 2000; k++){
+            len += 1 + malloc_bench_rand(ctx) % 32;
+            buf = realloc(buf, len);
+            buf[len - 1] = 1;
+            ctx->no_of_ops++;
+        }
+        malloc_bench_free(ctx, buf);
+    }
+}
+
+/*Cache line and page aligned objects*/
+static void
+malloc_bench_aligned(malloc_bench_ctx_t *ctx){
+
+    uint32_t i, j, n = ctx->no_of_objects / 4 + 1;
+    void **objs = calloc(n, sizeof(void *));
+    size_t alignment;
+
+    for(i = 0; i < 4 * n; i++){
+        j = malloc_bench_rand(ctx) % n;
+        if(objs[j])
+            malloc_bench_free(ctx, objs[j]);
+        alignment = (malloc_bench_rand(ctx) % 8) ? 64 : 4096;
+        if(posix_memalign(&objs[j], alignment,
+            32 + malloc_bench_rand(ctx) % 1024)){
+            printf("Error : posix_memalign() failed\n");
+            exit(1);
+        }
+        if((uintptr_t)objs[j] % alignment){
+            printf("Error : %p is not aligned to %zu\n", objs[j], alignment);
+            exit(1);
+        }
+        ctx->no_of_ops++;
+    }
+
+    for(i = 0; i < n; i++){
+        if(objs[i])
+            malloc_bench_free(ctx, objs[i]);
+    }
+    free(objs);
+}
+
+static void *
+malloc_bench_thread_fn(void *arg){
+
+    malloc_bench_small_churn((malloc_bench_ctx_t *)arg);
+    return NULL;
+}
+
+/*small_churn in several threads at once, which contend for the allocator*/
+static void
+malloc_bench_threads(malloc_bench_ctx_t *ctx){
+
+    uint32_t i;
+    pthread_t threads[MALLOC_BENCH_NO_OF_THREADS];
+    malloc_bench_ctx_t thread_ctx[MALLOC_BENCH_NO_OF_THREADS];
+
+    for(i = 0; i < MALLOC_BENCH_NO_OF_THREADS; i++){
+        thread_ctx[i] = *ctx;
+        thread_ctx[i].no_of_objects = ctx->no_of_objects /
+            MALLOC_BENCH_NO_OF_THREADS + 1;
+        thread_ctx[i].seed = ctx->seed + i;
+        thread_ctx[i].no_of_ops = 0;
+        pthread_create(&threads[i], NULL, malloc_bench_thread_fn,
+            &thread_ctx[i]);
+    }
+    for(i = 0; i < MALLOC_BENCH_NO_OF_THREADS; i++){
+        pthread_join(threads[i], NULL);
+        ctx->no_of_ops += thread_ctx[i].no_of_ops;
+    }
+}
+
+static malloc_bench_case_t malloc_bench_cases[] = {
+
+    {"small_churn",     malloc_bench_small_churn},
+    {"mixed_sizes",     malloc_bench_mixed_sizes},
+    {"realloc_grow",    malloc_bench_realloc_grow},
+    {"aligned",         malloc_bench_aligned},
+    {"threads",         malloc_bench_threads},
+};
+
+#define MALLOC_BENCH_NO_OF_CASES    \
+    (sizeof(malloc_bench_cases)/sizeof(malloc_bench_cases[0]))
+
+/*Runs in the child, reports ops and ns/op on stdout*/
+static int
+malloc_bench_run_workload(const char *name, uint32_t no_of_objects){
+
+    uint32_t k;
+    uint64_t t0;
+    malloc_bench_ctx_t ctx;
+
+    for(k = 0; k < MALLOC_BENCH_NO_OF_CASES; k++){
+
+        if(strcmp(malloc_bench_cases[k].name, name))
+            continue;
+
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.no_of_objects = no_of_objects;
+        ctx.seed = 2463534242U;
+
+        t0 = malloc_bench_now_ns();
+        malloc_bench_cases[k].run(&ctx);
+        printf("%12" PRIu64 " %10.1f", ctx.no_of_ops,
+            ctx.no_of_ops ?
+            (double)(malloc_bench_now_ns() - t0) / (double)ctx.no_of_ops : 0.0);
+        return 0;
+    }
+    printf("Error : unknown workload %s\n", name);
+    return 1;
+}
+
+/* Run argv in a child process, with lib_path preloaded unless it is NULL,
+ * and print its wall clock time and peak resident memory*/
+static void
+malloc_bench_run_child(char **argv, const char *lib_path, const char *name){
+
+    int status;
+    uint64_t t0, elapsed_ns;
+    struct rusage rusage;
+    pid_t pid;
+
+    fflush(stdout);
+    t0 = malloc_bench_now_ns();
+    pid = fork();
+
+    if(pid < 0){
+        printf("Error : fork failed\n");
+        exit(1);
+    }
+    if(!pid){
+        if(lib_path)
+            setenv("LD_PRELOAD", lib_path, 1);
+        else
+            unsetenv("LD_PRELOAD");
+        printf("%-16s %-8s ", name, lib_path ? "lmm" : "glibc");
+        fflush(stdout);
+        execvp(argv[0], argv);
+        printf("Error : exec of %s failed\n", argv[0]);
+        _exit(127);
+    }
+
+    wait4(pid, &status, 0, &rusage);
+    elapsed_ns = malloc_bench_now_ns() - t0;
+
+    if(!WIFEXITED(status) || WEXITSTATUS(status)){
+        printf(" failed, status = 0x%x\n", status);
+        return;
+    }
+    printf(" %10.1f %10ld\n", (double)elapsed_ns / 1000000.0,
+        rusage.ru_maxrss);
+}
+
+static void
+malloc_bench_usage(const char *prog_name){
+
+    printf("Usage : %s [-n no_of_objects] [-l lib_path] [workload ...]\n"
+           "        %s [-l lib_path] -- command [args ...]\n\tworkloads :",
+           prog_name, prog_name);
+    for(uint32_t i = 0; i < MALLOC_BENCH_NO_OF_CASES; i++)
+        printf(" %s", malloc_bench_cases[i].name);
+    printf("\n");
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, i;
+    uint32_t k, no_of_objects = MALLOC_BENCH_DEFAULT_OBJECTS;
+    const char *workload = NULL;
+    char lib_path[PATH_MAX], no_of_objects_str[16];
+    char *child_argv[6];
+
+    if(!realpath(MALLOC_BENCH_DEFAULT_LIB, lib_path))
+        lib_path[0] = '\0';
+
+    while((opt = getopt(argc, argv, "n:l:w:h")) != -1){
+        switch(opt){
+            case 'n':
+                no_of_objects = strtoul(optarg, NULL, 10);
+                break;
+            case 'l':
+                if(!realpath(optarg, lib_path))
+                    lib_path[0] = '\0';
+                break;
+            case 'w':   /*Internal, run a workload in this process*/
+                workload = optarg;
+                break;
+            default:
+                malloc_bench_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(workload)
+        return malloc_bench_run_workload(workload, no_of_objects);
+
+    if(!no_of_objects){
+        malloc_bench_usage(argv[0]);
+        return 1;
+    }
+
+    /*Preloaded library must be given by absolute path*/
+    if(!lib_path[0]){
+        printf("Error : libmm_malloc.so not found, build it or give -l\n");
+        return 1;
+    }
+
+    /*A command given after --*/
+    if(optind < argc && !strcmp(argv[optind - 1], "--")){
+
+        printf("%-16s %-8s %10s %10s\n", "command", "malloc", "wall ms",
+            "maxrss KB");
+        malloc_bench_run_child(&argv[optind], NULL, argv[optind]);
+        malloc_bench_run_child(&argv[optind], lib_path, argv[optind]);
+        return 0;
+    }
+
+    printf("%-16s %-8s %12s %10s %10s %10s\n",
+        "workload", "malloc", "ops", "ns/op", "wall ms", "maxrss KB");
+
+    snprintf(no_of_objects_str, sizeof(no_of_objects_str), "%u",
+        no_of_objects);
+
+    for(k = 0; k < MALLOC_BENCH_NO_OF_CASES; k++){
+
+        if(optind < argc){
+            for(i = optind; i < argc; i++){
+                if(!strcmp(argv[i], malloc_bench_cases[k].name))
+                    break;
+            }
+            if(i == argc)
+                continue;
+        }
+
+        /*The workload is run by a fresh copy of this program*/
+        child_argv[0] = "/proc/self/exe";
+        child_argv[1] = "-n";
+        child_argv[2] = no_of_objects_str;
+        child_argv[3] = "-w";
+        child_argv[4] = (char *)malloc_bench_cases[k].name;
+        child_argv[5] = NULL;
+
+        malloc_bench_run_child(child_argv, NULL, malloc_bench_cases[k].name);
+        malloc_bench_run_child(child_argv, lib_path, malloc_bench_cases[k].name);
+    }
+    return 0;
+}
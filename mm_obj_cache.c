@@ -0,0 +1,290 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_obj_cache.c
+ *
+ *    Description:  This file implements the object caches of Memory Manager, objects
+ *                  are constructed once and kept constructed across free and reuse
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 09:41:05 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "mm.h"
+
+/* Objects of a cache are ordinary blocks of the cache's page family.
+ * An idle object stays allocated as far as the family is concerned and
+ * is queued on the idle list of the cache through the priority thread
+ * glue of its meta block, which is unused while a block is allocated.
+ * So the object itself is never written by the cache, and its
+ * constructed state survives till the object is destructed*/
+#define MM_OBJ_CACHE_MAX_REFILL    128
+
+struct mm_obj_cache_{
+
+    char cache_name[MM_MAX_STRUCT_NAME];
+    mm_family_handle_t family_handle;
+    mm_obj_ctor_t ctor;
+    mm_obj_dtor_t dtor;
+    glthread_t idle_list_head;
+    uint32_t no_of_idle_objects;
+    uint32_t refill_count;      /*Objects constructed at once, a VM page worth*/
+    uint32_t reap_threshold;    /*Idle objects which trigger the next reap*/
+};
+
+#define MM_OBJ_CACHE_GET_META_BLOCK(obj)    \
+    ((block_meta_data_t *)(obj) - 1)
+
+/*Idle objects are counted by their family too, for its sanity checks*/
+#define MM_OBJ_CACHE_GET_FAMILY(block_meta_data)    \
+    (MM_GET_PAGE_FROM_META_BLOCK(block_meta_data)->pg_family)
+
+/* Cache descriptors are taken directly from kernel, so that they stay
+ * put when families are relocated by mm_family_destroy()*/
+mm_obj_cache_t *
+mm_obj_cache_create(char *cache_name,
+                    uint32_t obj_size,
+                    mm_obj_ctor_t ctor,
+                    mm_obj_dtor_t dtor){
+
+    uint32_t capacity;
+    mm_obj_cache_t *obj_cache;
+    vm_page_family_t *vm_page_family;
+
+    if(lookup_page_family_by_name(cache_name)){
+        printf("Error : %s() Page family %s already exists\n",
+            __FUNCTION__, cache_name);
+        return NULL;
+    }
+
+    obj_cache = mmap(NULL, sizeof(mm_obj_cache_t), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(obj_cache == MAP_FAILED)
+        return NULL;
+
+    mm_instantiate_new_page_family(cache_name, obj_size);
+
+    vm_page_family = lookup_page_family_by_name(cache_name);
+
+    if(!vm_page_family){
+        munmap(obj_cache, sizeof(mm_obj_cache_t));
+        return NULL;
+    }
+
+    vm_page_family->owner = obj_cache;
+    strncpy(obj_cache->cache_name, cache_name, MM_MAX_STRUCT_NAME - 1);
+    obj_cache->cache_name[MM_MAX_STRUCT_NAME - 1] = '\0';
+    obj_cache->family_handle = mm_get_family_handle(cache_name);
+    obj_cache->ctor = ctor;
+    obj_cache->dtor = dtor;
+    init_glthread(&obj_cache->idle_list_head);
+    obj_cache->no_of_idle_objects = 0;
+
+    capacity = (GB_SYSTEM_PAGE_SIZE * vm_page_family->vm_page_units) -
+                offset_of(vm_page_t, block_meta_data);
+    obj_cache->refill_count =
+        capacity / (sizeof(block_meta_data_t) + vm_page_family->struct_size);
+
+    if(obj_cache->refill_count > MM_OBJ_CACHE_MAX_REFILL)
+        obj_cache->refill_count = MM_OBJ_CACHE_MAX_REFILL;
+    if(!obj_cache->refill_count)
+        obj_cache->refill_count = 1;
+
+    obj_cache->reap_threshold = 2 * obj_cache->refill_count;
+    return obj_cache;
+}
+
+static void
+mm_obj_cache_push_idle(mm_obj_cache_t *obj_cache, void *obj){
+
+    block_meta_data_t *block_meta_data = MM_OBJ_CACHE_GET_META_BLOCK(obj);
+
+    glthread_add_next(&obj_cache->idle_list_head,
+        &block_meta_data->priority_thread_glue);
+    obj_cache->no_of_idle_objects++;
+    MM_COUNTER_ADD(MM_OBJ_CACHE_GET_FAMILY(block_meta_data)->no_of_idle_blocks, 1);
+}
+
+static void
+mm_obj_cache_remove_idle(mm_obj_cache_t *obj_cache,
+                         block_meta_data_t *block_meta_data){
+
+    remove_glthread(&block_meta_data->priority_thread_glue);
+    obj_cache->no_of_idle_objects--;
+    MM_COUNTER_SUB(MM_OBJ_CACHE_GET_FAMILY(block_meta_data)->no_of_idle_blocks, 1);
+}
+
+/*Fresh objects come zeroed from the family and are constructed once*/
+static vm_bool_t
+mm_obj_cache_refill(mm_obj_cache_t *obj_cache){
+
+    int i, count;
+    void *objs[MM_OBJ_CACHE_MAX_REFILL];
+
+    count = xcalloc_family_bulk(obj_cache->family_handle, objs,
+                obj_cache->refill_count);
+
+    for(i = count - 1; i >= 0; i--){
+        if(obj_cache->ctor)
+            obj_cache->ctor(objs[i]);
+        mm_obj_cache_push_idle(obj_cache, objs[i]);
+    }
+    return count ? MM_TRUE : MM_FALSE;
+}
+
+void *
+mm_obj_cache_alloc(mm_obj_cache_t *obj_cache){
+
+    glthread_t *glue = BASE(&obj_cache->idle_list_head);
+
+    if(!glue){
+
+        if(!mm_obj_cache_refill(obj_cache))
+            return NULL;
+        glue = BASE(&obj_cache->idle_list_head);
+    }
+
+    mm_obj_cache_remove_idle(obj_cache, glthread_to_block_meta_data(glue));
+    return (void *)(glthread_to_block_meta_data(glue) + 1);
+}
+
+void
+mm_obj_cache_free(mm_obj_cache_t *obj_cache, void *obj){
+
+    mm_obj_cache_push_idle(obj_cache, obj);
+
+    if(obj_cache->no_of_idle_objects > obj_cache->reap_threshold){
+
+        mm_obj_cache_reap(obj_cache);
+
+        /* Idle objects left behind sit on VM pages shared with objects
+         * in use, the threshold grows with them so that reaps stay rare*/
+        obj_cache->reap_threshold = 2 * obj_cache->no_of_idle_objects;
+        if(obj_cache->reap_threshold < 2 * obj_cache->refill_count)
+            obj_cache->reap_threshold = 2 * obj_cache->refill_count;
+    }
+}
+
+/* A VM page is reclaimable if every allocated block on it is an idle
+ * object of the cache*/
+static vm_bool_t
+mm_obj_cache_vm_page_idle(vm_page_t *vm_page){
+
+    block_meta_data_t *block_meta_data;
+
+    ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page, block_meta_data){
+
+        if(block_meta_data->is_free == MM_FALSE &&
+            IS_GLTHREAD_LIST_EMPTY(&block_meta_data->priority_thread_glue)){
+            return MM_FALSE;
+        }
+    } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page, block_meta_data);
+    return MM_TRUE;
+}
+
+/* Idle objects of a reclaimable VM page are destructed and moved to a
+ * local list first, freeing them while walking the page is not possible
+ * as xfree() merges neighbouring free blocks. Freeing the last one
+ * returns the VM page*/
+uint32_t
+mm_obj_cache_reap(mm_obj_cache_t *obj_cache){
+
+    uint32_t no_of_objects = 0;
+    glthread_t reap_list_head, *glue;
+    vm_page_t *vm_page;
+    block_meta_data_t *block_meta_data;
+    vm_page_family_t *vm_page_family =
+        lookup_page_family_by_name(obj_cache->cache_name);
+
+    if(!vm_page_family)
+        return 0;
+
+    init_glthread(&reap_list_head);
+
+    ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family, vm_page){
+
+        if(!mm_obj_cache_vm_page_idle(vm_page))
+            continue;
+
+        ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page, block_meta_data){
+
+            if(block_meta_data->is_free == MM_TRUE)
+                continue;
+
+            mm_obj_cache_remove_idle(obj_cache, block_meta_data);
+
+            if(obj_cache->dtor)
+                obj_cache->dtor((void *)(block_meta_data + 1));
+
+            glthread_add_next(&reap_list_head,
+                &block_meta_data->priority_thread_glue);
+        } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page, block_meta_data);
+    } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family, vm_page);
+
+    while((glue = BASE(&reap_list_head))){
+
+        remove_glthread(glue);
+        xfree((void *)(glthread_to_block_meta_data(glue) + 1));
+        no_of_objects++;
+    }
+    return no_of_objects;
+}
+
+/* Idle objects are destructed, objects still in use are released
+ * without running the destructor*/
+int
+mm_obj_cache_destroy(mm_obj_cache_t *obj_cache){
+
+    glthread_t *glue;
+
+    /*Checked before the idle objects are destructed*/
+    if(gb_pressure_cb_running){
+        printf("Error : %s() Cache %s can not be destroyed by the pressure "
+            "callback\n", __FUNCTION__, obj_cache->cache_name);
+        return -1;
+    }
+
+    /*Reset of the family would fail after the idle objects are destructed*/
+    if(MM_COUNTER_READ(lookup_page_family_by_name(obj_cache->cache_name)->
+            no_of_deferred_blocks)){
+        printf("Error : %s() Cache %s has objects deferred by "
+            "xfree_deferred(), call mm_epoch_barrier() first\n",
+            __FUNCTION__, obj_cache->cache_name);
+        return -1;
+    }
+
+    while((glue = BASE(&obj_cache->idle_list_head))){
+
+        mm_obj_cache_remove_idle(obj_cache, glthread_to_block_meta_data(glue));
+        if(obj_cache->dtor)
+            obj_cache->dtor((void *)(glthread_to_block_meta_data(glue) + 1));
+    }
+
+    mm_vm_page_family_destroy(
+        lookup_page_family_by_name(obj_cache->cache_name));
+    munmap(obj_cache, sizeof(mm_obj_cache_t));
+    return 0;
+}
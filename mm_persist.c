@@ -0,0 +1,752 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_persist.c
+ *
+ *    Description:  This file implements the persistent and shared heaps of Memory
+ *                  Manager, page families kept in a file which a restarted process
+ *                  maps back, or in shared memory used by several processes
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 10:27:44 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include "mm.h"
+
+/* Layout of a persistent heap file or shared memory object, which is
+ * mapped shared as a whole :
+ *
+ *  system page 0   : header
+ *  system page 1   : page of families of the heap
+ *  system page 2.. : VM pages of the families, handed out bottom up
+ *
+ * Memory Manager structures in the file keep plain pointers. The header
+ * records the address the file was mapped at, if a process can not map
+ * it back at the same address, every pointer of the structures is moved
+ * by the difference before the heap is used. A shared heap is in use by
+ * other processes while being attached, so it is never relocated*/
+#define MM_PERSIST_MAGIC        "LMMHEAP"
+#define MM_PERSIST_VERSION      1
+#define MM_PERSIST_HDR_PAGES    2
+
+typedef struct mm_persist_hdr_{
+
+    char magic[8];
+    uint32_t version;
+    uint32_t sys_page_size;
+    /*Layout of Memory Manager structures in the file, build flags change them*/
+    uint32_t vm_page_size_of;
+    uint32_t block_meta_data_size_of;
+    uint32_t vm_page_family_size_of;
+    uint32_t shared;
+    uint64_t heap_size;     /*Size of the file*/
+    uint64_t heap_base;     /*Address the heap was last mapped at*/
+    uint64_t heap_used;     /*Offset of the first byte never handed out*/
+    vm_page_t *free_vm_pages;   /*Released VM pages, chained through next*/
+    void *root;
+    pthread_mutex_t lock;       /*Of a shared heap*/
+    mm_page_source_t page_source;
+} mm_persist_hdr_t;
+
+struct mm_persist_{
+
+    char path[256];
+    int fd;
+    char *base;
+    mm_persist_hdr_t *hdr;
+    intptr_t relocation;
+    vm_bool_t shared;
+};
+
+#define MM_PERSIST_GET_HDR(page_source_ptr)                                 \
+    ((mm_persist_hdr_t *)((char *)(page_source_ptr) -                       \
+        offset_of(mm_persist_hdr_t, page_source)))
+
+static mm_persist_t *gb_shm = NULL;
+
+#define MM_PERSIST_REBASE(ptr, relocation)                                  \
+    ((ptr) = (ptr) ? (__typeof__(ptr))((char *)(ptr) + (relocation)) : NULL)
+
+/* VM pages of the same size are reused first. Heap never grows, the file
+ * is sized once when created and left sparse*/
+static vm_page_t *
+mm_persist_get_vm_page(mm_page_source_t *page_source, uint32_t units){
+
+    mm_persist_hdr_t *hdr = MM_PERSIST_GET_HDR(page_source);
+    uint32_t page_size = units * GB_SYSTEM_PAGE_SIZE;
+    vm_page_t **vm_page_ptr, *vm_page;
+
+    for(vm_page_ptr = &hdr->free_vm_pages; *vm_page_ptr;
+        vm_page_ptr = &(*vm_page_ptr)->next){
+
+        if((*vm_page_ptr)->page_size == page_size){
+            vm_page = *vm_page_ptr;
+            *vm_page_ptr = vm_page->next;
+            vm_page->prev_page_size = 0;
+            return vm_page;
+        }
+    }
+
+    if(hdr->heap_used + page_size > hdr->heap_size){
+        printf("Error : Heap at %p is full\n", (void *)hdr);
+        return NULL;
+    }
+
+    vm_page = (vm_page_t *)((char *)hdr + hdr->heap_used);
+    hdr->heap_used += page_size;
+    vm_page->page_size = page_size;
+    vm_page->prev_page_size = 0;
+    return vm_page;
+}
+
+/* Contents of a released VM page are dropped from the file, except for
+ * the system page holding the VM page header. The top most VM page is
+ * given back to the heap altogether*/
+static void
+mm_persist_put_vm_page(mm_page_source_t *page_source, vm_page_t *vm_page){
+
+    mm_persist_hdr_t *hdr = MM_PERSIST_GET_HDR(page_source);
+
+    if((char *)vm_page + vm_page->page_size == (char *)hdr + hdr->heap_used){
+        hdr->heap_used -= vm_page->page_size;
+        madvise(vm_page, vm_page->page_size, MADV_REMOVE);
+        return;
+    }
+
+    if(vm_page->page_size > GB_SYSTEM_PAGE_SIZE){
+        madvise((char *)vm_page + GB_SYSTEM_PAGE_SIZE,
+            vm_page->page_size - GB_SYSTEM_PAGE_SIZE, MADV_REMOVE);
+    }
+    vm_page->next = hdr->free_vm_pages;
+    hdr->free_vm_pages = vm_page;
+}
+
+static const mm_page_source_ops_t mm_persist_page_source_ops = {
+
+    mm_persist_get_vm_page,
+    mm_persist_put_vm_page
+};
+
+static vm_page_for_families_t *
+mm_persist_vm_page_for_families(mm_persist_t *persist){
+
+    return (vm_page_for_families_t *)(persist->base + GB_SYSTEM_PAGE_SIZE);
+}
+
+/* Checks of the structures read from a heap file, which may be corrupt.
+ * Family names are not trusted to be NUL terminated either*/
+#define MM_PERSIST_HEAP_CHECK(cond, reason)                                 \
+    if(!(cond)){                                                            \
+        printf("Error : Persistent heap %s is corrupt : %s\n",              \
+            persist->path, reason);                                         \
+        return MM_FALSE;                                                    \
+    }
+
+#define MM_PERSIST_CHECK(cond, reason)                                      \
+    if(!(cond)){                                                            \
+        printf("Error : Persistent heap %s is corrupt, family %.*s : %s\n", \
+            persist->path, MM_MAX_STRUCT_NAME, vm_page_family->struct_name, \
+            reason);                                                        \
+        return MM_FALSE;                                                    \
+    }
+
+static vm_bool_t
+mm_persist_in_heap(mm_persist_t *persist, void *ptr, uint32_t size){
+
+    char *heap_start = persist->base + MM_PERSIST_HDR_PAGES * GB_SYSTEM_PAGE_SIZE;
+    char *heap_end = persist->base + persist->hdr->heap_used;
+
+    return (char *)ptr >= heap_start && (char *)ptr <= heap_end &&
+        size <= (uint64_t)(heap_end - (char *)ptr) ?
+        MM_TRUE : MM_FALSE;
+}
+
+/* Block lies in vm_page, and so does the meta block of the next block,
+ * the next block can be read once this holds*/
+static vm_bool_t
+mm_persist_block_in_vm_page(vm_page_t *vm_page,
+                            block_meta_data_t *block_meta_data){
+
+    char *vm_page_end = (char *)vm_page + vm_page->page_size;
+    char *block_end = (char *)(block_meta_data + 1);
+
+    if(block_end > vm_page_end ||
+        block_meta_data->block_size > (uint64_t)(vm_page_end - block_end)){
+        return MM_FALSE;
+    }
+
+    block_end += block_meta_data->block_size;
+
+    return !block_meta_data->next_block ||
+        ((char *)block_meta_data->next_block >= block_end &&
+         (char *)block_meta_data->next_block <= vm_page_end &&
+         sizeof(block_meta_data_t) <=
+            (uint64_t)(vm_page_end - (char *)block_meta_data->next_block)) ?
+        MM_TRUE : MM_FALSE;
+}
+
+/* Move every pointer of the structures in the heap by persist->relocation.
+ * Each VM page and block pointer is moved and checked to lie in the heap
+ * before it is followed, the rest is left to mm_persist_validate()*/
+static vm_bool_t
+mm_persist_rebase(mm_persist_t *persist){
+
+    uint32_t i, j;
+    uint64_t no_of_vm_pages;
+    vm_page_t *vm_page, *prev_vm_page;
+    vm_page_family_t *vm_page_family;
+    block_meta_data_t *block_meta_data;
+    intptr_t relocation = persist->relocation;
+    vm_page_for_families_t *vm_page_for_families =
+        mm_persist_vm_page_for_families(persist);
+
+    MM_PERSIST_REBASE(persist->hdr->root, relocation);
+    MM_PERSIST_REBASE(persist->hdr->free_vm_pages, relocation);
+
+    no_of_vm_pages = 0;
+
+    for(vm_page = persist->hdr->free_vm_pages; vm_page;
+        vm_page = vm_page->next){
+
+        MM_PERSIST_HEAP_CHECK(mm_persist_in_heap(persist, vm_page,
+            sizeof(vm_page_t)) &&
+            ++no_of_vm_pages <= persist->hdr->heap_used / GB_SYSTEM_PAGE_SIZE,
+            "bad free VM page list");
+        MM_PERSIST_REBASE(vm_page->next, relocation);
+    }
+
+    MM_PERSIST_HEAP_CHECK(vm_page_for_families->no_of_families <=
+        MAX_FAMILIES_PER_VM_PAGE, "bad number of families");
+
+    for(i = 0; i < vm_page_for_families->no_of_families; i++){
+
+        vm_page_family = &vm_page_for_families->vm_page_family[i];
+        prev_vm_page = NULL;
+
+        MM_PERSIST_REBASE(vm_page_family->first_page, relocation);
+        MM_PERSIST_REBASE(vm_page_family->free_block_priority_list_head.right,
+            relocation);
+        for(j = 0; j < MM_PAGE_OCCUPANCY_MAX; j++){
+            MM_PERSIST_REBASE(vm_page_family->page_occupancy_list_head[j].right,
+                relocation);
+        }
+
+        for(vm_page = vm_page_family->first_page; vm_page;
+            vm_page = vm_page->next){
+
+            MM_PERSIST_CHECK(mm_persist_in_heap(persist, vm_page,
+                sizeof(vm_page_t)) &&
+                mm_persist_in_heap(persist, vm_page, vm_page->page_size),
+                "VM page out of heap");
+
+            MM_PERSIST_REBASE(vm_page->next, relocation);
+            MM_PERSIST_REBASE(vm_page->prev, relocation);
+            MM_PERSIST_REBASE(vm_page->pg_family, relocation);
+            MM_PERSIST_REBASE(vm_page->occupancy_glue.left, relocation);
+            MM_PERSIST_REBASE(vm_page->occupancy_glue.right, relocation);
+
+            /*Also keeps the walk from going round a loop of VM pages*/
+            MM_PERSIST_CHECK(vm_page->prev == prev_vm_page,
+                "bad VM page links");
+            prev_vm_page = vm_page;
+
+            for(block_meta_data = &vm_page->block_meta_data; block_meta_data;
+                block_meta_data = block_meta_data->next_block){
+
+                MM_PERSIST_REBASE(block_meta_data->priority_thread_glue.left,
+                    relocation);
+                MM_PERSIST_REBASE(block_meta_data->priority_thread_glue.right,
+                    relocation);
+                MM_PERSIST_REBASE(block_meta_data->prev_block, relocation);
+                MM_PERSIST_REBASE(block_meta_data->next_block, relocation);
+
+                MM_PERSIST_CHECK(mm_persist_block_in_vm_page(vm_page,
+                    block_meta_data), "block overflows VM page");
+            }
+        }
+    }
+    return MM_TRUE;
+}
+
+/* Same walk as mm_print_block_usage(), every VM page and block of every
+ * family must lie in the heap and be linked consistently, and the blocks
+ * must add up to the statistics of the family*/
+static vm_bool_t
+mm_persist_validate(mm_persist_t *persist){
+
+    uint32_t i;
+    glthread_t *curr;
+    vm_page_t *vm_page, *prev_vm_page;
+    vm_page_family_t *vm_page_family;
+    block_meta_data_t *block_meta_data, *prev_block_meta_data;
+    uint64_t no_of_allocated_blocks, memory_in_use, no_of_free_blocks;
+    uint64_t no_of_reserved_vm_pages, no_of_vm_pages;
+    vm_page_for_families_t *vm_page_for_families =
+        mm_persist_vm_page_for_families(persist);
+
+    no_of_vm_pages = 0;
+
+    for(vm_page = persist->hdr->free_vm_pages; vm_page;
+        vm_page = vm_page->next){
+
+        MM_PERSIST_HEAP_CHECK(mm_persist_in_heap(persist, vm_page,
+            sizeof(vm_page_t)) &&
+            ++no_of_vm_pages <= persist->hdr->heap_used / GB_SYSTEM_PAGE_SIZE,
+            "bad free VM page list");
+        MM_PERSIST_HEAP_CHECK(vm_page->page_size &&
+            vm_page->page_size % GB_SYSTEM_PAGE_SIZE == 0 &&
+            vm_page->page_size <=
+                MM_MAX_SYS_PAGES_PER_VM_PAGE * GB_SYSTEM_PAGE_SIZE &&
+            mm_persist_in_heap(persist, vm_page, vm_page->page_size),
+            "bad free VM page size");
+    }
+
+    MM_PERSIST_HEAP_CHECK(vm_page_for_families->no_of_families <=
+        MAX_FAMILIES_PER_VM_PAGE, "bad number of families");
+
+    for(i = 0; i < vm_page_for_families->no_of_families; i++){
+
+        vm_page_family = &vm_page_for_families->vm_page_family[i];
+        no_of_allocated_blocks = 0;
+        memory_in_use = 0;
+        no_of_free_blocks = 0;
+        no_of_reserved_vm_pages = 0;
+        prev_vm_page = NULL;
+
+        MM_PERSIST_CHECK(vm_page_family->vm_page_units &&
+            vm_page_family->vm_page_units <= MM_MAX_SYS_PAGES_PER_VM_PAGE,
+            "bad VM page size");
+
+        for(vm_page = vm_page_family->first_page; vm_page;
+            vm_page = vm_page->next){
+
+            MM_PERSIST_CHECK(mm_persist_in_heap(persist, vm_page,
+                vm_page_family->vm_page_units * GB_SYSTEM_PAGE_SIZE),
+                "VM page out of heap");
+            MM_PERSIST_CHECK(vm_page->page_size ==
+                vm_page_family->vm_page_units * GB_SYSTEM_PAGE_SIZE,
+                "bad VM page size");
+            MM_PERSIST_CHECK(vm_page->pg_family == vm_page_family &&
+                vm_page->prev == prev_vm_page, "bad VM page links");
+            MM_PERSIST_CHECK(vm_page->occupancy < MM_PAGE_OCCUPANCY_MAX,
+                "bad VM page occupancy");
+            prev_vm_page = vm_page;
+            prev_block_meta_data = NULL;
+
+            /*Free block of a reserved VM page is kept out of the free block list*/
+            if(vm_page->occupancy == MM_PAGE_OCCUPANCY_EMPTY){
+                MM_PERSIST_CHECK(mm_is_vm_page_empty(vm_page) &&
+                    IS_GLTHREAD_LIST_EMPTY(
+                        &vm_page->block_meta_data.priority_thread_glue),
+                    "bad reserved VM page");
+                no_of_reserved_vm_pages++;
+                continue;
+            }
+
+            for(block_meta_data = &vm_page->block_meta_data; block_meta_data;
+                block_meta_data = block_meta_data->next_block){
+
+                MM_PERSIST_CHECK(block_meta_data->prev_block ==
+                    prev_block_meta_data, "bad block links");
+                MM_PERSIST_CHECK(block_meta_data->offset ==
+                    (uint32_t)((char *)block_meta_data - (char *)vm_page),
+                    "bad block offset");
+                /*Next block is read by the next round only if it is in
+                 *the VM page*/
+                MM_PERSIST_CHECK(mm_persist_block_in_vm_page(vm_page,
+                    block_meta_data), "block overflows VM page");
+
+                if(block_meta_data->is_free == MM_TRUE){
+                    MM_PERSIST_CHECK(!IS_GLTHREAD_LIST_EMPTY(
+                        &block_meta_data->priority_thread_glue),
+                        "free block not in free block list");
+                    no_of_free_blocks++;
+                }
+                else{
+                    no_of_allocated_blocks++;
+                    memory_in_use += sizeof(block_meta_data_t) +
+                        block_meta_data->block_size;
+                }
+                prev_block_meta_data = block_meta_data;
+            }
+        }
+
+        MM_PERSIST_CHECK(no_of_allocated_blocks ==
+            MM_COUNTER_READ(vm_page_family->no_of_allocated_blocks) &&
+            memory_in_use ==
+            MM_COUNTER_READ(vm_page_family->total_memory_in_use_by_app),
+            "allocated blocks do not match statistics");
+        MM_PERSIST_CHECK(no_of_reserved_vm_pages ==
+            MM_COUNTER_READ(vm_page_family->no_of_reserved_vm_pages),
+            "reserved VM pages do not match statistics");
+
+        /*Not ITERATE_GLTHREAD_BEGIN, it reads the next node before the
+         *current one is checked*/
+        for(curr = vm_page_family->free_block_priority_list_head.right; curr;
+            curr = curr->right){
+
+            block_meta_data = glthread_to_block_meta_data(curr);
+            MM_PERSIST_CHECK(mm_persist_in_heap(persist, block_meta_data,
+                sizeof(block_meta_data_t)) &&
+                block_meta_data->is_free == MM_TRUE,
+                "bad free block list");
+            MM_PERSIST_CHECK(no_of_free_blocks, "bad free block list");
+            no_of_free_blocks--;
+        }
+
+        MM_PERSIST_CHECK(!no_of_free_blocks, "bad free block list");
+    }
+    return MM_TRUE;
+}
+
+static vm_bool_t
+mm_persist_hdr_valid(mm_persist_hdr_t *hdr, uint64_t file_size,
+                     vm_bool_t shared){
+
+    return memcmp(hdr->magic, MM_PERSIST_MAGIC, sizeof(MM_PERSIST_MAGIC)) == 0 &&
+        hdr->version == MM_PERSIST_VERSION &&
+        hdr->shared == (shared ? 1 : 0) &&
+        hdr->sys_page_size == GB_SYSTEM_PAGE_SIZE &&
+        hdr->vm_page_size_of == sizeof(vm_page_t) &&
+        hdr->block_meta_data_size_of == sizeof(block_meta_data_t) &&
+        hdr->vm_page_family_size_of == sizeof(vm_page_family_t) &&
+        hdr->heap_size == file_size &&
+        hdr->heap_used >= MM_PERSIST_HDR_PAGES * GB_SYSTEM_PAGE_SIZE &&
+        hdr->heap_used <= hdr->heap_size ?
+        MM_TRUE : MM_FALSE;
+}
+
+static void
+mm_persist_free(mm_persist_t *persist){
+
+    if(persist->base)
+        munmap(persist->base, persist->hdr->heap_size);
+    close(persist->fd);
+    free(persist);
+}
+
+/* Map the heap of persist->fd, which is new if create, and attach its
+ * page source. Frees persist on failure*/
+static mm_persist_t *
+mm_persist_map(mm_persist_t *persist, size_t size, vm_bool_t create){
+
+    uint32_t i;
+    int rc = 0;
+    mm_persist_hdr_t hdr;
+    char *base;
+    pthread_mutexattr_t attr;
+    vm_page_for_families_t *vm_page_for_families;
+
+    if(create){
+
+        size = (size + GB_SYSTEM_PAGE_SIZE - 1) & ~(GB_SYSTEM_PAGE_SIZE - 1);
+        if(size < (MM_PERSIST_HDR_PAGES + MM_MAX_SYS_PAGES_PER_VM_PAGE) *
+                    GB_SYSTEM_PAGE_SIZE){
+            size = (MM_PERSIST_HDR_PAGES + MM_MAX_SYS_PAGES_PER_VM_PAGE) *
+                    GB_SYSTEM_PAGE_SIZE;
+        }
+        if(ftruncate(persist->fd, size) < 0){
+            printf("Error : %s() Could not size %s, error no = %d\n",
+                __FUNCTION__, persist->path, errno);
+            mm_persist_free(persist);
+            return NULL;
+        }
+        memset(&hdr, 0, sizeof(hdr));
+    }
+    else{
+
+        if(pread(persist->fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) ||
+            !mm_persist_hdr_valid(&hdr, size, persist->shared)){
+            printf("Error : %s() %s is not a %s heap of this build\n",
+                __FUNCTION__, persist->path,
+                persist->shared ? "shared" : "persistent");
+            mm_persist_free(persist);
+            return NULL;
+        }
+    }
+
+    /*Objects keep their addresses if the heap can be mapped back in place*/
+    base = mmap((void *)(uintptr_t)hdr.heap_base, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | (create ? 0 : MAP_FIXED_NOREPLACE),
+                persist->fd, 0);
+
+    if(base == MAP_FAILED && !create && !persist->shared){
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    persist->fd, 0);
+    }
+
+    if(base == MAP_FAILED){
+        printf("Error : %s() Could not map %s at %p, error no = %d\n",
+            __FUNCTION__, persist->path, (void *)(uintptr_t)hdr.heap_base,
+            errno);
+        mm_persist_free(persist);
+        return NULL;
+    }
+
+    persist->base = base;
+    persist->hdr = (mm_persist_hdr_t *)base;
+    vm_page_for_families = mm_persist_vm_page_for_families(persist);
+
+    if(create){
+        memcpy(persist->hdr->magic, MM_PERSIST_MAGIC, sizeof(MM_PERSIST_MAGIC));
+        persist->hdr->version = MM_PERSIST_VERSION;
+        persist->hdr->sys_page_size = GB_SYSTEM_PAGE_SIZE;
+        persist->hdr->vm_page_size_of = sizeof(vm_page_t);
+        persist->hdr->block_meta_data_size_of = sizeof(block_meta_data_t);
+        persist->hdr->vm_page_family_size_of = sizeof(vm_page_family_t);
+        persist->hdr->shared = persist->shared ? 1 : 0;
+        persist->hdr->heap_size = size;
+        persist->hdr->heap_used = MM_PERSIST_HDR_PAGES * GB_SYSTEM_PAGE_SIZE;
+        persist->hdr->heap_base = (uint64_t)(uintptr_t)base;
+        persist->hdr->page_source.vm_page_for_families = vm_page_for_families;
+
+        if(persist->shared){
+            pthread_mutexattr_init(&attr);
+            pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+            pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+            pthread_mutex_init(&persist->hdr->lock, &attr);
+            pthread_mutexattr_destroy(&attr);
+            persist->hdr->page_source.lock = &persist->hdr->lock;
+        }
+    }
+    else if(!persist->shared){
+        persist->relocation = (intptr_t)(base - (char *)(uintptr_t)hdr.heap_base);
+        if(persist->relocation && !mm_persist_rebase(persist)){
+            mm_persist_free(persist);
+            return NULL;
+        }
+        persist->hdr->heap_base = (uint64_t)(uintptr_t)base;
+        persist->hdr->page_source.vm_page_for_families = vm_page_for_families;
+        persist->hdr->page_source.lock = NULL;
+    }
+
+    gb_page_source_ops = &mm_persist_page_source_ops;
+
+    /*Other processes of a shared heap keep using it meanwhile*/
+    if(persist->shared)
+        mm_page_source_lock(&persist->hdr->page_source);
+
+    if(!create && !mm_persist_validate(persist))
+        rc = -1;
+
+    for(i = 0; !rc && i < vm_page_for_families->no_of_families; i++){
+
+        if(lookup_page_family_by_name(
+            vm_page_for_families->vm_page_family[i].struct_name)){
+            printf("Error : %s() Page family %s already exists\n",
+                __FUNCTION__, vm_page_for_families->vm_page_family[i].struct_name);
+            rc = -1;
+        }
+    }
+
+    if(!rc)
+        rc = mm_attach_page_source(&persist->hdr->page_source);
+
+    if(persist->shared)
+        pthread_mutex_unlock(persist->hdr->page_source.lock);
+
+    if(rc < 0){
+        mm_persist_free(persist);
+        return NULL;
+    }
+    return persist;
+}
+
+mm_persist_t *
+mm_persist_open(const char *path, size_t size){
+
+    struct stat st;
+    mm_persist_t *persist = calloc(1, sizeof(mm_persist_t));
+
+    if(!persist)
+        return NULL;
+
+    strncpy(persist->path, path, sizeof(persist->path) - 1);
+    persist->fd = open(path, O_RDWR | O_CREAT, 0644);
+
+    if(persist->fd < 0){
+        printf("Error : %s() Could not open %s, error no = %d\n",
+            __FUNCTION__, path, errno);
+        free(persist);
+        return NULL;
+    }
+
+    /*One process at a time*/
+    if(flock(persist->fd, LOCK_EX | LOCK_NB) < 0 ||
+        fstat(persist->fd, &st) < 0){
+        printf("Error : %s() %s is in use, error no = %d\n",
+            __FUNCTION__, path, errno);
+        mm_persist_free(persist);
+        return NULL;
+    }
+
+    return mm_persist_map(persist, st.st_size ? (size_t)st.st_size : size,
+                st.st_size ? MM_FALSE : MM_TRUE);
+}
+
+int
+mm_persist_instantiate_new_page_family(mm_persist_t *persist,
+                                       char *struct_name,
+                                       uint32_t struct_size){
+
+    vm_page_family_t *vm_page_family = lookup_page_family_by_name(struct_name);
+
+    if(vm_page_family){
+
+        if(vm_page_family->page_source == &persist->hdr->page_source &&
+            vm_page_family->struct_size == struct_size){
+            return 0;
+        }
+        printf("Error : %s() Page family %s already exists\n",
+            __FUNCTION__, struct_name);
+        return -1;
+    }
+
+    return mm_instantiate_page_family_in_page_source(struct_name,
+                struct_size, &persist->hdr->page_source) ? 0 : -1;
+}
+
+void
+mm_persist_set_root(mm_persist_t *persist, void *root){
+
+    persist->hdr->root = root;
+}
+
+void *
+mm_persist_get_root(mm_persist_t *persist){
+
+    return persist->hdr->root;
+}
+
+intptr_t
+mm_persist_get_relocation(mm_persist_t *persist){
+
+    return persist->relocation;
+}
+
+int
+mm_persist_sync(mm_persist_t *persist){
+
+    return msync(persist->base, persist->hdr->heap_used, MS_SYNC);
+}
+
+void
+mm_persist_close(mm_persist_t *persist){
+
+    mm_persist_sync(persist);
+    mm_detach_page_source(&persist->hdr->page_source);
+    mm_persist_free(persist);
+}
+
+/* A shared memory object is a tmpfs file, a shared heap is a persistent
+ * heap mapped by several processes at once, never relocated*/
+mm_shm_t *
+mm_shm_open(const char *name, size_t size){
+
+    struct stat st;
+    mm_shm_t *shm;
+
+    if(gb_shm){
+        printf("Error : %s() Shared heap %s is already open\n",
+            __FUNCTION__, gb_shm->path);
+        return NULL;
+    }
+
+    shm = calloc(1, sizeof(mm_shm_t));
+
+    if(!shm)
+        return NULL;
+
+    strncpy(shm->path, name, sizeof(shm->path) - 1);
+    shm->shared = MM_TRUE;
+    shm->fd = shm_open(name, size ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0600);
+
+    if(shm->fd < 0 || fstat(shm->fd, &st) < 0){
+        printf("Error : %s() Could not open %s, error no = %d\n",
+            __FUNCTION__, name, errno);
+        if(shm->fd >= 0)
+            close(shm->fd);
+        free(shm);
+        return NULL;
+    }
+
+    gb_shm = mm_persist_map(shm, size ? size : (size_t)st.st_size,
+                size ? MM_TRUE : MM_FALSE);
+    return gb_shm;
+}
+
+int
+mm_shm_instantiate_new_page_family(mm_shm_t *shm,
+                                   char *struct_name,
+                                   uint32_t struct_size){
+
+    int rc;
+
+    mm_shm_lock(shm);
+    rc = mm_persist_instantiate_new_page_family(shm, struct_name, struct_size);
+    mm_shm_unlock(shm);
+    return rc;
+}
+
+void
+mm_shm_lock(mm_shm_t *shm){
+
+    mm_page_source_lock(&shm->hdr->page_source);
+}
+
+void
+mm_shm_unlock(mm_shm_t *shm){
+
+    pthread_mutex_unlock(shm->hdr->page_source.lock);
+}
+
+void
+mm_shm_set_root(mm_shm_t *shm, void *root){
+
+    shm->hdr->root = root;
+}
+
+void *
+mm_shm_get_root(mm_shm_t *shm){
+
+    return shm->hdr->root;
+}
+
+void
+mm_shm_close(mm_shm_t *shm){
+
+    mm_shm_lock(shm);
+    mm_detach_page_source(&shm->hdr->page_source);
+    mm_shm_unlock(shm);
+    gb_shm = NULL;
+    mm_persist_free(shm);
+}
@@ -0,0 +1,291 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_persist_bench.c
+ *
+ *    Description:  This file implements the restart benchmark of persistent heaps, a
+ *                  table of routes is built once, then every restart maps it back
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 11:02:16 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "uapi_mm.h"
+
+typedef struct route_{
+
+    struct route_ *left;
+    struct route_ *right;
+    uint32_t prefix;
+    uint32_t prefix_len;
+    uint32_t nexthop;
+    uint32_t metric;
+} route_t;
+
+#define PERSIST_BENCH_DEFAULT_ROUTES    1000000
+#define PERSIST_BENCH_DEFAULT_FILE      "/tmp/mm_persist_bench.heap"
+#define PERSIST_BENCH_MAX_DEPTH         4096
+
+/*Shared between the build and the restart processes*/
+typedef struct persist_bench_result_{
+
+    void *root;
+    uint64_t checksum;
+} persist_bench_result_t;
+
+static uint64_t
+persist_bench_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t
+persist_bench_rand(){
+
+    static uint32_t seed = 2463534242U;
+
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static void
+persist_bench_print(const char *phase, uint64_t elapsed_ns, uint64_t no_of_routes){
+
+    printf("%-12s %10" PRIu64 " routes %10.1f ms\n",
+        phase, no_of_routes, (double)elapsed_ns / 1e6);
+}
+
+/* Walk the tree, moving the child pointers by relocation first if the
+ * heap could not be mapped back in place. Return the checksum of the
+ * routes and the no of routes in no_of_routes*/
+static uint64_t
+persist_bench_walk(route_t *root, intptr_t relocation, uint64_t *no_of_routes){
+
+    static route_t *stack[PERSIST_BENCH_MAX_DEPTH];
+    uint32_t depth = 0;
+    uint64_t checksum = 0;
+    route_t *route;
+
+    *no_of_routes = 0;
+    if(root)
+        stack[depth++] = root;
+
+    while(depth){
+
+        route = stack[--depth];
+        if(relocation){
+            if(route->left)
+                route->left = (route_t *)((char *)route->left + relocation);
+            if(route->right)
+                route->right = (route_t *)((char *)route->right + relocation);
+        }
+        checksum += ((uint64_t)route->prefix << 8 | route->prefix_len) ^
+                    route->nexthop;
+        (*no_of_routes)++;
+
+        if(depth + 2 > PERSIST_BENCH_MAX_DEPTH){
+            printf("Error : Route tree too deep\n");
+            return 0;
+        }
+        if(route->left)
+            stack[depth++] = route->left;
+        if(route->right)
+            stack[depth++] = route->right;
+    }
+    return checksum;
+}
+
+static int
+persist_bench_build(const char *path, uint64_t no_of_routes,
+                    persist_bench_result_t *result){
+
+    uint64_t i, t0, elapsed_ns, no_of_nodes;
+    route_t *root = NULL, *route, **link;
+    mm_persist_t *persist;
+
+    unlink(path);
+    mm_init();
+
+    persist = mm_persist_open(path,
+        no_of_routes * (sizeof(route_t) + 64) * 3 / 2 + (1 << 20));
+
+    if(!persist || MM_PERSIST_REG_STRUCT(persist, route_t) < 0)
+        return 1;
+
+    t0 = persist_bench_now_ns();
+
+    for(i = 0; i < no_of_routes; i++){
+
+        route = XCALLOC(1, route_t);
+        if(!route)
+            return 1;
+        route->prefix = persist_bench_rand();
+        route->prefix_len = 8 + persist_bench_rand() % 25;
+        route->nexthop = persist_bench_rand();
+        route->metric = i;
+
+        for(link = &root; *link;){
+            link = route->prefix < (*link)->prefix ?
+                &(*link)->left : &(*link)->right;
+        }
+        *link = route;
+    }
+    persist_bench_print("build", persist_bench_now_ns() - t0, no_of_routes);
+
+    mm_persist_set_root(persist, root);
+    result->root = root;
+    result->checksum = persist_bench_walk(root, 0, &no_of_nodes);
+
+    t0 = persist_bench_now_ns();
+    mm_persist_close(persist);
+    elapsed_ns = persist_bench_now_ns() - t0;
+    persist_bench_print("sync+close", elapsed_ns, no_of_routes);
+    return 0;
+}
+
+/* A restarted process maps the routes back. With relocate, the address
+ * the heap was at is taken first, so that the heap has to move*/
+static int
+persist_bench_restart(const char *path, int relocate,
+                      persist_bench_result_t *result){
+
+    uint64_t t0, elapsed_ns, checksum, no_of_routes;
+    intptr_t relocation;
+    mm_persist_t *persist;
+
+    mm_init();
+
+    if(relocate){
+        void *page = (void *)((uintptr_t)result->root &
+                        ~((uintptr_t)getpagesize() - 1));
+        if(mmap(page, getpagesize(), PROT_READ,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0) != page){
+            printf("Error : Could not take the address of the heap\n");
+            return 1;
+        }
+    }
+
+    t0 = persist_bench_now_ns();
+    persist = mm_persist_open(path, 0);
+    elapsed_ns = persist_bench_now_ns() - t0;
+
+    if(!persist)
+        return 1;
+
+    relocation = mm_persist_get_relocation(persist);
+    persist_bench_print("open", elapsed_ns, 0);
+
+    t0 = persist_bench_now_ns();
+    checksum = persist_bench_walk(mm_persist_get_root(persist), relocation,
+                &no_of_routes);
+    persist_bench_print(relocation ? "walk+reloc" : "walk",
+        persist_bench_now_ns() - t0, no_of_routes);
+
+    printf("relocation %" PRIdPTR " bytes, checksum %s\n", relocation,
+        checksum == result->checksum ? "ok" : "MISMATCH");
+
+    /*Routes stay usable, one more is added before the next restart*/
+    if(MM_PERSIST_REG_STRUCT(persist, route_t) < 0 || !XCALLOC(1, route_t))
+        return 1;
+    xfree(XCALLOC(1, route_t));
+
+    mm_persist_close(persist);
+    return checksum == result->checksum ? 0 : 1;
+}
+
+static int
+persist_bench_run(int (*fn)(const char *, int, persist_bench_result_t *),
+                  const char *path, int arg, persist_bench_result_t *result){
+
+    int status;
+
+    fflush(stdout);
+    pid_t pid = fork();
+
+    if(pid < 0)
+        return 1;
+    if(!pid){
+        status = fn(path, arg, result);
+        fflush(stdout);
+        _exit(status);
+    }
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+static int
+persist_bench_build_fn(const char *path, int no_of_routes,
+                       persist_bench_result_t *result){
+
+    return persist_bench_build(path, (uint64_t)no_of_routes, result);
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, rc;
+    int no_of_routes = PERSIST_BENCH_DEFAULT_ROUTES;
+    const char *path = PERSIST_BENCH_DEFAULT_FILE;
+    persist_bench_result_t *result;
+
+    while((opt = getopt(argc, argv, "n:f:h")) != -1){
+        switch(opt){
+            case 'n':
+                no_of_routes = atoi(optarg);
+                break;
+            case 'f':
+                path = optarg;
+                break;
+            default:
+                printf("Usage : %s [-n no_of_routes] [-f heap_file]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    result = mmap(NULL, sizeof(*result), PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if(result == MAP_FAILED)
+        return 1;
+
+    /*Every phase is a process of its own, like a daemon restarting*/
+    rc = persist_bench_run(persist_bench_build_fn, path, no_of_routes, result);
+    if(!rc)
+        rc = persist_bench_run(persist_bench_restart, path, 0, result);
+    if(!rc)
+        rc = persist_bench_run(persist_bench_restart, path, 1, result);
+
+    unlink(path);
+    return rc;
+}
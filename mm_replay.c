@@ -0,0 +1,609 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_replay.c
+ *
+ *    Description:  This file implements the tool which replays an allocation trace
+ *                  recorded by Memory Manager (-DMM_TRACE) against Memory Manager
+ *                  or glibc malloc and reports throughput and memory footprint
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 04:12:37 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "uapi_mm.h"
+
+typedef enum{
+
+    REPLAY_ALLOCATOR_LMM,
+    REPLAY_ALLOCATOR_GLIBC
+} replay_allocator_t;
+
+typedef struct replay_family_{
+
+    char struct_name[MM_MAX_STRUCT_NAME + 1];
+    uint32_t struct_size;
+    int is_buff;    /*Size class family of xcalloc_buff()*/
+} replay_family_t;
+
+typedef struct replay_op_{
+
+    uint64_t ts;
+    uint64_t addr;
+    uint32_t seq;       /*Position in trace file, breaks ts ties*/
+    uint32_t size;
+    uint16_t family_index;
+    uint8_t op;
+} replay_op_t;
+
+/*Maps the addresses recorded in the trace to the replayed allocations*/
+typedef struct replay_live_obj_{
+
+    uint64_t trace_addr;    /*0 if slot is empty*/
+    void *ptr;
+    uint32_t size;
+    uint16_t family_index;
+} replay_live_obj_t;
+
+typedef struct replay_trace_{
+
+    replay_family_t *families;
+    uint32_t no_of_families;
+    uint16_t *family_index_by_id;
+    replay_op_t *ops;
+    uint64_t no_of_ops;
+    uint64_t no_of_allocs;
+} replay_trace_t;
+
+typedef struct replay_sample_{
+
+    uint64_t footprint;     /*Bytes obtained from kernel*/
+    uint64_t in_use;        /*Bytes handed to application incl. allocator overhead*/
+    uint64_t free;          /*Bytes free within footprint*/
+    uint64_t largest_free_block;
+    uint64_t no_of_system_calls;
+} replay_sample_t;
+
+#define REPLAY_FAMILY_ID_MAX    (UINT16_MAX + 1)
+#define REPLAY_DEFAULT_INTERVAL 10000
+
+/* Tables are taken directly from the kernel, so that replay tool itself
+ * does not allocate from the heap segment being measured*/
+static void *
+replay_zalloc(size_t size){
+
+    void *ptr = mmap(NULL, size ? size : 1, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(ptr == MAP_FAILED){
+        printf("Error : %s() mmap of %zu bytes failed\n", __FUNCTION__, size);
+        exit(1);
+    }
+    return ptr;
+}
+
+static uint64_t
+replay_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static int
+replay_op_comparison_function(const void *_op1, const void *_op2){
+
+    const replay_op_t *op1 = _op1;
+    const replay_op_t *op2 = _op2;
+
+    if(op1->ts != op2->ts)
+        return op1->ts < op2->ts ? -1 : 1;
+    if(op1->seq != op2->seq)
+        return op1->seq < op2->seq ? -1 : 1;
+    return 0;
+}
+
+/* Load the trace file, merge the per thread chunks into one stream of
+ * xcalloc/xfree operations ordered by time. VM page events are not
+ * replayed, the allocator being measured generates its own*/
+static int
+replay_load_trace(const char *file_name, replay_trace_t *trace){
+
+    int fd;
+    struct stat st;
+    char *file, *ptr, *end;
+    mm_trace_file_hdr_t *file_hdr;
+    mm_trace_family_t *trace_family;
+    mm_trace_chunk_hdr_t *chunk_hdr;
+    mm_trace_record_t *record;
+    uint32_t i, seq = 0;
+
+    fd = open(file_name, O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) < 0){
+        printf("Error : Could not open trace file %s\n", file_name);
+        return -1;
+    }
+
+    if((size_t)st.st_size < sizeof(mm_trace_file_hdr_t)){
+        printf("Error : %s is not a Memory Manager trace file\n", file_name);
+        close(fd);
+        return -1;
+    }
+
+    file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(file == MAP_FAILED){
+        printf("Error : Could not map trace file %s\n", file_name);
+        return -1;
+    }
+
+    end = file + st.st_size;
+    file_hdr = (mm_trace_file_hdr_t *)file;
+
+    if(memcmp(file_hdr->magic, MM_TRACE_MAGIC, sizeof(file_hdr->magic)) ||
+        file_hdr->version != MM_TRACE_VERSION ||
+        file_hdr->record_size != sizeof(mm_trace_record_t)){
+        printf("Error : %s is not a Memory Manager trace file of version %u\n",
+            file_name, MM_TRACE_VERSION);
+        return -1;
+    }
+
+    ptr = file + sizeof(mm_trace_file_hdr_t);
+
+    if((size_t)(end - ptr) <
+        file_hdr->no_of_families * sizeof(mm_trace_family_t)){
+        printf("Error : %s is truncated\n", file_name);
+        return -1;
+    }
+
+    trace->no_of_families = file_hdr->no_of_families;
+    trace->families = replay_zalloc(
+        trace->no_of_families * sizeof(replay_family_t));
+    trace->family_index_by_id = replay_zalloc(
+        REPLAY_FAMILY_ID_MAX * sizeof(uint16_t));
+    memset(trace->family_index_by_id, 0xff,
+        REPLAY_FAMILY_ID_MAX * sizeof(uint16_t));
+
+    for(i = 0; i < trace->no_of_families; i++){
+
+        trace_family = (mm_trace_family_t *)ptr;
+        memcpy(trace->families[i].struct_name, trace_family->struct_name,
+            MM_MAX_STRUCT_NAME);
+        trace->families[i].struct_size = trace_family->struct_size;
+        trace->families[i].is_buff = !strncmp(trace->families[i].struct_name,
+            MM_BUFF_FAMILY_PREFIX, strlen(MM_BUFF_FAMILY_PREFIX));
+        trace->family_index_by_id[trace_family->family_id] = i;
+        ptr += sizeof(mm_trace_family_t);
+    }
+
+    /*First pass to count the operations, second pass to collect them*/
+    char *records_start = ptr;
+    int pass;
+
+    for(pass = 0; pass < 2; pass++){
+
+        if(pass){
+            trace->ops = replay_zalloc(trace->no_of_ops * sizeof(replay_op_t));
+            trace->no_of_ops = 0;
+        }
+
+        for(ptr = records_start; ptr < end; ){
+
+            chunk_hdr = (mm_trace_chunk_hdr_t *)ptr;
+            ptr += sizeof(mm_trace_chunk_hdr_t);
+
+            if(ptr > end || (size_t)(end - ptr) <
+                chunk_hdr->no_of_records * sizeof(mm_trace_record_t)){
+                if(pass)
+                    printf("Warning : %s is truncated, replaying the complete chunks\n",
+                        file_name);
+                break;
+            }
+
+            for(i = 0; i < chunk_hdr->no_of_records; i++,
+                ptr += sizeof(mm_trace_record_t)){
+
+                record = (mm_trace_record_t *)ptr;
+
+                if(record->op != MM_TRACE_OP_ALLOC &&
+                    record->op != MM_TRACE_OP_FREE &&
+                    record->op != MM_TRACE_OP_FAMILY_RESET)
+                    continue;
+
+                if(trace->family_index_by_id[record->family_id] == UINT16_MAX)
+                    continue;
+
+                if(pass){
+                    replay_op_t *op = &trace->ops[trace->no_of_ops];
+                    op->ts = record->ts;
+                    op->addr = record->addr;
+                    op->seq = seq++;
+                    op->size = record->size;
+                    op->family_index =
+                        trace->family_index_by_id[record->family_id];
+                    op->op = record->op;
+                    if(op->op == MM_TRACE_OP_ALLOC)
+                        trace->no_of_allocs++;
+                }
+                trace->no_of_ops++;
+            }
+        }
+    }
+
+    qsort(trace->ops, trace->no_of_ops, sizeof(replay_op_t),
+        replay_op_comparison_function);
+    munmap(file, st.st_size);
+    return 0;
+}
+
+/* Open addressing hash table with linear probing, sized to twice the
+ * no of allocations in the trace, so it can never fill up*/
+static replay_live_obj_t *
+replay_live_obj_lookup(replay_live_obj_t *table, uint64_t table_size,
+                       uint64_t trace_addr){
+
+    uint64_t i = (trace_addr >> 4) * 0x9E3779B97F4A7C15ULL;
+
+    for(i &= (table_size - 1); ; i = (i + 1) & (table_size - 1)){
+
+        if(!table[i].trace_addr || table[i].trace_addr == trace_addr)
+            return &table[i];
+    }
+}
+
+static void
+replay_live_obj_delete(replay_live_obj_t *table, uint64_t table_size,
+                       replay_live_obj_t *live_obj){
+
+    uint64_t i = live_obj - table, j = i, home;
+
+    /*Shift back the entries of the probe chain into the hole*/
+    for(;;){
+        table[i].trace_addr = 0;
+        for(;;){
+            j = (j + 1) & (table_size - 1);
+            if(!table[j].trace_addr)
+                return;
+            home = ((table[j].trace_addr >> 4) * 0x9E3779B97F4A7C15ULL) &
+                (table_size - 1);
+            if(i <= j ? (home <= i || home > j) : (home <= i && home > j))
+                break;
+        }
+        table[i] = table[j];
+        i = j;
+    }
+}
+
+/* Drop all the live objects of the family, LMM does it with one
+ * mm_family_reset(), glibc has to free them one by one. Return the no
+ * of objects dropped*/
+static uint64_t
+replay_family_reset(replay_trace_t *trace, replay_allocator_t allocator,
+                    replay_live_obj_t *table, uint64_t table_size,
+                    uint16_t family_index, uint64_t *live_bytes){
+
+    uint64_t i = 0, no_of_objs = 0;
+
+    if(allocator == REPLAY_ALLOCATOR_LMM)
+        mm_family_reset(trace->families[family_index].struct_name);
+
+    /*Deletion shifts later entries back into slot i, so revisit it*/
+    while(i < table_size){
+
+        if(!table[i].trace_addr || table[i].family_index != family_index){
+            i++;
+            continue;
+        }
+        if(allocator == REPLAY_ALLOCATOR_GLIBC)
+            free(table[i].ptr);
+        *live_bytes -= table[i].size;
+        replay_live_obj_delete(table, table_size, &table[i]);
+        no_of_objs++;
+    }
+    return no_of_objs;
+}
+
+static void
+replay_sample(replay_allocator_t allocator, replay_sample_t *sample){
+
+    memset(sample, 0, sizeof(replay_sample_t));
+
+    if(allocator == REPLAY_ALLOCATOR_LMM){
+
+        mm_stats_t stats;
+
+        mm_get_stats(&stats);
+        sample->footprint = stats.vm_page_memory;
+        sample->in_use = stats.memory_in_use_by_app;
+        sample->free = stats.free_memory;
+        sample->largest_free_block = stats.largest_free_block;
+        sample->no_of_system_calls = stats.no_of_system_calls;
+        return;
+    }
+
+    struct mallinfo2 mi = mallinfo2();
+
+    sample->footprint = mi.arena + mi.hblkhd;
+    sample->in_use = mi.uordblks + mi.hblkhd;
+    sample->free = mi.fordblks;
+}
+
+static void
+replay_print_sample(replay_allocator_t allocator, uint64_t op_index,
+                    uint64_t live_bytes, replay_sample_t *sample){
+
+    double frag = 0.0;
+
+    if(sample->footprint > live_bytes)
+        frag = (double)((sample->footprint - live_bytes) * 100) /
+            (double)sample->footprint;
+
+    printf("%12" PRIu64 " %14" PRIu64 " %14" PRIu64 " %14" PRIu64 " %14" PRIu64,
+        op_index, live_bytes, sample->footprint, sample->in_use, sample->free);
+
+    if(allocator == REPLAY_ALLOCATOR_LMM)
+        printf(" %14" PRIu64, sample->largest_free_block);
+    else
+        printf(" %14s", "-");
+
+    printf(" %7.2f%%\n", frag);
+}
+
+static void
+replay_run(replay_trace_t *trace, replay_allocator_t allocator,
+           uint64_t interval, int quiet){
+
+    uint64_t i, batch_end;
+    uint64_t table_size = 2;
+    uint64_t live_bytes = 0, elapsed_ns = 0, t0;
+    uint64_t no_of_allocs = 0, no_of_frees = 0, no_of_skipped = 0;
+    uint64_t no_of_failures = 0, peak_footprint = 0;
+    replay_op_t *op;
+    replay_family_t *family;
+    replay_live_obj_t *table, *live_obj;
+    replay_sample_t sample;
+    const char *allocator_name =
+        allocator == REPLAY_ALLOCATOR_LMM ? "lmm" : "glibc";
+
+    while(table_size < trace->no_of_allocs * 2)
+        table_size <<= 1;
+    table = replay_zalloc(table_size * sizeof(replay_live_obj_t));
+
+    if(allocator == REPLAY_ALLOCATOR_LMM){
+        mm_init();
+        /*Buffer families are created by xcalloc_buff() itself*/
+        for(i = 0; i < trace->no_of_families; i++){
+            if(trace->families[i].is_buff)
+                continue;
+            mm_instantiate_new_page_family(trace->families[i].struct_name,
+                trace->families[i].struct_size);
+        }
+    }
+
+    if(!quiet){
+        printf("\n[%s] Footprint over time, fragmentation = 1 - live/footprint\n",
+            allocator_name);
+        printf("%12s %14s %14s %14s %14s %14s %8s\n", "ops", "live_bytes",
+            "footprint", "in_use", "free", "largest_free", "frag");
+    }
+
+    for(i = 0; i < trace->no_of_ops; i = batch_end){
+
+        batch_end = i + interval;
+        if(batch_end > trace->no_of_ops)
+            batch_end = trace->no_of_ops;
+
+        t0 = replay_now_ns();
+
+        for(op = &trace->ops[i]; op < &trace->ops[batch_end]; op++){
+
+            if(op->op == MM_TRACE_OP_FAMILY_RESET){
+                no_of_frees += replay_family_reset(trace, allocator, table,
+                    table_size, op->family_index, &live_bytes);
+                continue;
+            }
+
+            if(!op->addr){
+                no_of_skipped++;
+                continue;
+            }
+
+            live_obj = replay_live_obj_lookup(table, table_size, op->addr);
+
+            if(op->op == MM_TRACE_OP_FREE){
+
+                /*Allocated before the trace window began*/
+                if(!live_obj->trace_addr){
+                    no_of_skipped++;
+                    continue;
+                }
+                if(allocator == REPLAY_ALLOCATOR_LMM)
+                    xfree(live_obj->ptr);
+                else
+                    free(live_obj->ptr);
+                live_bytes -= live_obj->size;
+                replay_live_obj_delete(table, table_size, live_obj);
+                no_of_frees++;
+                continue;
+            }
+
+            family = &trace->families[op->family_index];
+
+            /*Free of this address was lost, release the stale object*/
+            if(live_obj->trace_addr){
+                if(allocator == REPLAY_ALLOCATOR_LMM)
+                    xfree(live_obj->ptr);
+                else
+                    free(live_obj->ptr);
+                live_bytes -= live_obj->size;
+            }
+
+            if(allocator == REPLAY_ALLOCATOR_LMM && family->is_buff)
+                live_obj->ptr = xcalloc_buff(op->size);
+            else if(allocator == REPLAY_ALLOCATOR_LMM)
+                live_obj->ptr = xcalloc(family->struct_name,
+                    op->size / family->struct_size);
+            else
+                live_obj->ptr = calloc(1, op->size);
+
+            if(!live_obj->ptr){
+                live_obj->trace_addr = 0;
+                no_of_failures++;
+                continue;
+            }
+            live_obj->trace_addr = op->addr;
+            live_obj->size = op->size;
+            live_obj->family_index = op->family_index;
+            live_bytes += op->size;
+            no_of_allocs++;
+        }
+
+        elapsed_ns += replay_now_ns() - t0;
+
+        replay_sample(allocator, &sample);
+        if(sample.footprint > peak_footprint)
+            peak_footprint = sample.footprint;
+        if(!quiet)
+            replay_print_sample(allocator, batch_end, live_bytes, &sample);
+    }
+
+    if(allocator == REPLAY_ALLOCATOR_LMM){
+        mm_stats_t stats;
+        mm_get_stats(&stats);
+        peak_footprint = stats.peak_vm_page_memory;
+    }
+
+    printf("\n[%s] Replay Summary\n", allocator_name);
+    printf("\tOperations replayed   : %" PRIu64 " (%" PRIu64 " allocs, %" PRIu64
+        " frees), %" PRIu64 " skipped, %" PRIu64 " failed\n",
+        no_of_allocs + no_of_frees, no_of_allocs, no_of_frees,
+        no_of_skipped, no_of_failures);
+    printf("\tReplay time           : %.3f ms\n", (double)elapsed_ns / 1e6);
+    printf("\tThroughput            : %.0f ops/sec\n", elapsed_ns ?
+        (double)(no_of_allocs + no_of_frees) * 1e9 / (double)elapsed_ns : 0.0);
+    printf("\tPeak footprint        : %" PRIu64 " Bytes (%" PRIu64 " system pages)%s\n",
+        peak_footprint, peak_footprint / getpagesize(),
+        allocator == REPLAY_ALLOCATOR_LMM ? "" : ", sampled");
+    printf("\tLive at end of trace  : %" PRIu64 " Bytes\n", live_bytes);
+
+    if(allocator == REPLAY_ALLOCATOR_LMM)
+        printf("\tSystem calls          : %" PRIu64 "\n", sample.no_of_system_calls);
+    else
+        printf("\tSystem calls          : n/a (use strace -c)\n");
+
+    /*Release what the trace left allocated, footprint should drop to 0*/
+    for(i = 0; i < table_size; i++){
+        if(!table[i].trace_addr)
+            continue;
+        if(allocator == REPLAY_ALLOCATOR_LMM)
+            xfree(table[i].ptr);
+        else
+            free(table[i].ptr);
+    }
+    replay_sample(allocator, &sample);
+    printf("\tFootprint at cleanup  : %" PRIu64 " Bytes\n", sample.footprint);
+    fflush(stdout);
+}
+
+static void
+replay_usage(const char *prog_name){
+
+    printf("Usage : %s [-g | -b] [-i interval] [-q] <trace file>\n"
+        "\t-g : replay against glibc malloc instead of Memory Manager\n"
+        "\t-b : replay against both, one after the other\n"
+        "\t-i : sample footprint every 'interval' operations (default %u)\n"
+        "\t-q : print only the summary\n", prog_name, REPLAY_DEFAULT_INTERVAL);
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, quiet = 0, no_of_allocators = 1, i;
+    uint64_t interval = REPLAY_DEFAULT_INTERVAL;
+    replay_allocator_t allocators[2] =
+        {REPLAY_ALLOCATOR_LMM, REPLAY_ALLOCATOR_GLIBC};
+    replay_trace_t trace;
+
+    while((opt = getopt(argc, argv, "gbi:qh")) != -1){
+        switch(opt){
+            case 'g':
+                allocators[0] = REPLAY_ALLOCATOR_GLIBC;
+                no_of_allocators = 1;
+                break;
+            case 'b':
+                allocators[0] = REPLAY_ALLOCATOR_LMM;
+                no_of_allocators = 2;
+                break;
+            case 'i':
+                interval = strtoull(optarg, NULL, 10);
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                replay_usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(optind != argc - 1 || !interval){
+        replay_usage(argv[0]);
+        return 1;
+    }
+
+    memset(&trace, 0, sizeof(trace));
+    if(replay_load_trace(argv[optind], &trace) < 0)
+        return 1;
+
+    printf("Trace %s : %u page families, %" PRIu64 " operations\n",
+        argv[optind], trace.no_of_families, trace.no_of_ops);
+
+    /* Every replay runs in its own process, so that the heap left behind
+     * by one allocator does not distort the numbers of the other*/
+    for(i = 0; i < no_of_allocators; i++){
+
+        fflush(stdout);
+        pid_t pid = fork();
+
+        if(pid < 0){
+            printf("Error : fork failed\n");
+            return 1;
+        }
+        if(!pid){
+            replay_run(&trace, allocators[i], interval, quiet);
+            _exit(0);
+        }
+        waitpid(pid, NULL, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_reserve_bench.c
+ *
+ *    Description:  This file implements the benchmark of VM page reservation, a burst
+ *                  of allocations as on failover, with and without mm_reserve() ahead
+ *
+ *        Version:  1.0
+ *        Created:  10/20/2026 02:07:41 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "uapi_mm.h"
+
+typedef struct session_{
+
+    uint64_t session_id;
+    uint32_t peer_addr;
+    uint32_t state;
+    char key[48];
+} session_t;
+
+#define RESERVE_BENCH_DEFAULT_OBJECTS   500000
+
+typedef enum{
+
+    RESERVE_BENCH_COLD,
+    RESERVE_BENCH_RESERVE,
+    RESERVE_BENCH_RESERVE_PREFAULT,
+    RESERVE_BENCH_MODE_MAX
+} reserve_bench_mode_t;
+
+static const char *reserve_bench_mode_names[RESERVE_BENCH_MODE_MAX] = {
+
+    "cold", "reserve", "reserve+prefault"
+};
+
+static uint64_t
+reserve_bench_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t
+reserve_bench_minor_faults(){
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)usage.ru_minflt;
+}
+
+/* The reservation is made ahead of the burst, only the burst counts
+ * against the deadline*/
+static int
+reserve_bench_run(reserve_bench_mode_t mode, uint64_t no_of_objects){
+
+    uint64_t n, t0, t1, elapsed_ns, max_ns = 0, reserve_ns = 0, faults;
+    session_t *session;
+    mm_family_stats_t family_stats;
+
+    mm_init();
+    MM_REG_STRUCT(session_t);
+
+    if(mode != RESERVE_BENCH_COLD){
+
+        t0 = reserve_bench_now_ns();
+        if(MM_RESERVE(session_t, no_of_objects,
+            mode == RESERVE_BENCH_RESERVE_PREFAULT ?
+            MM_RESERVE_PREFAULT : 0) < 0){
+            return 1;
+        }
+        reserve_ns = reserve_bench_now_ns() - t0;
+    }
+
+    faults = reserve_bench_minor_faults();
+    t0 = reserve_bench_now_ns();
+    for(n = 0; n < no_of_objects; n++){
+
+        t1 = reserve_bench_now_ns();
+        session = XCALLOC(1, session_t);
+        if(!session)
+            return 1;
+        session->session_id = n;
+        t1 = reserve_bench_now_ns() - t1;
+        if(t1 > max_ns)
+            max_ns = t1;
+    }
+    elapsed_ns = reserve_bench_now_ns() - t0;
+    faults = reserve_bench_minor_faults() - faults;
+
+    if(mm_get_family_stats("session_t", &family_stats) < 0)
+        return 1;
+
+    printf("%-18s %10.1f %10.1f %8.1f %10.1f %10" PRIu64 " %8" PRIu64
+        " %8" PRIu64 "\n",
+        reserve_bench_mode_names[mode], (double)reserve_ns / 1e6,
+        (double)elapsed_ns / 1e6, (double)elapsed_ns / no_of_objects,
+        (double)max_ns / 1e3, faults, family_stats.no_of_vm_pages,
+        family_stats.no_of_reserved_vm_pages);
+    return 0;
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, status, rc = 0;
+    int no_of_objects = RESERVE_BENCH_DEFAULT_OBJECTS;
+    reserve_bench_mode_t mode;
+    pid_t pid;
+
+    while((opt = getopt(argc, argv, "n:h")) != -1){
+        switch(opt){
+            case 'n':
+                no_of_objects = atoi(optarg);
+                break;
+            default:
+                printf("Usage : %s [-n no_of_objects]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(no_of_objects < 1)
+        return 1;
+
+    printf("%-18s %10s %10s %8s %10s %10s %8s %8s\n", "mode", "reserve ms",
+        "alloc ms", "ns/obj", "max us", "faults", "VM pages", "unused");
+
+    /*Every mode runs in a fresh process, with a heap segment of its own*/
+    for(mode = RESERVE_BENCH_COLD; mode < RESERVE_BENCH_MODE_MAX; mode++){
+
+        fflush(stdout);
+        pid = fork();
+        if(pid < 0)
+            return 1;
+        if(!pid){
+            status = reserve_bench_run(mode, (uint64_t)no_of_objects);
+            fflush(stdout);
+            _exit(status);
+        }
+        waitpid(pid, &status, 0);
+        if(!WIFEXITED(status) || WEXITSTATUS(status))
+            rc = 1;
+    }
+    return rc;
+}
@@ -0,0 +1,278 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_shm_bench.c
+ *
+ *    Description:  This file implements the benchmark of shared heaps, a producer
+ *                  process builds a table which reader processes walk and free
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 11:48:32 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "uapi_mm.h"
+
+typedef struct shm_entry_{
+
+    struct shm_entry_ *next;
+    uint32_t key;
+    uint32_t value;
+    char payload[48];
+} shm_entry_t;
+
+typedef struct shm_table_{
+
+    shm_entry_t *head;
+    uint64_t no_of_entries;
+    uint64_t checksum;
+} shm_table_t;
+
+#define SHM_BENCH_DEFAULT_ENTRIES   1000000
+#define SHM_BENCH_DEFAULT_READERS   4
+#define SHM_BENCH_MAX_READERS       64
+#define SHM_BENCH_NAME              "/mm_shm_bench"
+
+static uint64_t
+shm_bench_now_ns(){
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+shm_bench_print(const char *who, const char *phase, uint64_t elapsed_ns,
+                uint64_t no_of_entries){
+
+    printf("%-10s %-12s %10" PRIu64 " entries %10.1f ms %8.1f ns/entry\n",
+        who, phase, no_of_entries, (double)elapsed_ns / 1e6,
+        no_of_entries ? (double)elapsed_ns / no_of_entries : 0.0);
+}
+
+static uint64_t
+shm_bench_entry_sum(shm_entry_t *entry){
+
+    return ((uint64_t)entry->key << 32) ^ entry->value;
+}
+
+/* A reader attaches by name, walks the whole table and checks it, then
+ * frees its share of the entries, a range of keys as in a table
+ * partitioned between readers*/
+static int
+shm_bench_reader(int reader_id, int no_of_readers, uint64_t no_of_keys,
+                 int start_fd){
+
+    char c, who[16];
+    uint64_t keys_per_reader = no_of_keys / no_of_readers + 1;
+    uint64_t t0, checksum = 0, no_of_entries = 0, no_of_freed = 0;
+    mm_shm_t *shm;
+    shm_table_t *table;
+    shm_entry_t *entry, **link;
+
+    if(read(start_fd, &c, 1) != 1)
+        return 1;
+
+    snprintf(who, sizeof(who), "reader %d", reader_id);
+    mm_init();
+
+    t0 = shm_bench_now_ns();
+    shm = mm_shm_open(SHM_BENCH_NAME, 0);
+    if(!shm)
+        return 1;
+    shm_bench_print(who, "attach", shm_bench_now_ns() - t0, 0);
+
+    mm_shm_lock(shm);
+    table = mm_shm_get_root(shm);
+
+    t0 = shm_bench_now_ns();
+    for(entry = table->head; entry; entry = entry->next){
+        checksum += shm_bench_entry_sum(entry);
+        no_of_entries++;
+    }
+    shm_bench_print(who, "walk", shm_bench_now_ns() - t0, no_of_entries);
+
+    if(checksum != table->checksum || no_of_entries != table->no_of_entries){
+        printf("%s : checksum MISMATCH\n", who);
+        mm_shm_unlock(shm);
+        return 1;
+    }
+
+    /*Entries were allocated by the producer*/
+    t0 = shm_bench_now_ns();
+    for(link = &table->head; *link;){
+
+        entry = *link;
+        if(entry->key / keys_per_reader != (uint64_t)reader_id){
+            link = &entry->next;
+            continue;
+        }
+        *link = entry->next;
+        table->checksum -= shm_bench_entry_sum(entry);
+        table->no_of_entries--;
+        xfree(entry);
+        no_of_freed++;
+    }
+    shm_bench_print(who, "walk+xfree", shm_bench_now_ns() - t0, no_of_freed);
+    mm_shm_unlock(shm);
+
+    mm_shm_close(shm);
+    return 0;
+}
+
+static int
+shm_bench_producer(uint64_t no_of_entries, int no_of_readers,
+                   size_t heap_size, int start_fd){
+
+    int i, rc = 0, status;
+    uint64_t n, t0;
+    mm_shm_t *shm;
+    shm_table_t *table;
+    shm_entry_t *entry;
+    mm_family_stats_t family_stats;
+
+    mm_init();
+    shm_unlink(SHM_BENCH_NAME);
+
+    shm = mm_shm_open(SHM_BENCH_NAME, heap_size);
+
+    if(!shm || MM_SHM_REG_STRUCT(shm, shm_table_t) < 0 ||
+        MM_SHM_REG_STRUCT(shm, shm_entry_t) < 0){
+        return 1;
+    }
+
+    table = XCALLOC(1, shm_table_t);
+    if(!table)
+        return 1;
+
+    t0 = shm_bench_now_ns();
+    for(n = 0; n < no_of_entries; n++){
+
+        entry = XCALLOC(1, shm_entry_t);
+        if(!entry)
+            return 1;
+        entry->key = (uint32_t)n;
+        entry->value = (uint32_t)(n * 2654435761U);
+
+        mm_shm_lock(shm);
+        entry->next = table->head;
+        table->head = entry;
+        table->no_of_entries++;
+        table->checksum += shm_bench_entry_sum(entry);
+        mm_shm_unlock(shm);
+    }
+    shm_bench_print("producer", "XCALLOC", shm_bench_now_ns() - t0,
+        no_of_entries);
+
+    mm_shm_lock(shm);
+    mm_shm_set_root(shm, table);
+    mm_shm_unlock(shm);
+
+    /*Readers attach only now, the heap is complete*/
+    fflush(stdout);
+    for(i = 0; i < no_of_readers; i++){
+        if(write(start_fd, "s", 1) != 1)
+            return 1;
+    }
+
+    for(i = 0; i < no_of_readers; i++){
+        wait(&status);
+        if(!WIFEXITED(status) || WEXITSTATUS(status))
+            rc = 1;
+    }
+
+    if(mm_get_family_stats("shm_entry_t", &family_stats) < 0)
+        return 1;
+
+    printf("producer   entries left %" PRIu64 ", allocated blocks %" PRIu64
+        ", VM pages %" PRIu64 "\n", table->no_of_entries,
+        family_stats.no_of_allocated_blocks, family_stats.no_of_vm_pages);
+
+    if(table->no_of_entries || table->head ||
+        family_stats.no_of_allocated_blocks){
+        rc = 1;
+    }
+
+    xfree(table);
+    mm_shm_close(shm);
+    shm_unlink(SHM_BENCH_NAME);
+    return rc;
+}
+
+int
+main(int argc, char **argv){
+
+    int opt, i;
+    int no_of_entries = SHM_BENCH_DEFAULT_ENTRIES;
+    int no_of_readers = SHM_BENCH_DEFAULT_READERS;
+    int start_pipe[2];
+    pid_t pid;
+
+    while((opt = getopt(argc, argv, "n:r:h")) != -1){
+        switch(opt){
+            case 'n':
+                no_of_entries = atoi(optarg);
+                break;
+            case 'r':
+                no_of_readers = atoi(optarg);
+                break;
+            default:
+                printf("Usage : %s [-n no_of_entries] [-r no_of_readers]\n",
+                    argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if(no_of_entries < 0 || no_of_readers < 1 ||
+        no_of_readers > SHM_BENCH_MAX_READERS || pipe(start_pipe) < 0){
+        return 1;
+    }
+
+    /* Readers are forked before the heap exists, so that they attach to
+     * it like unrelated processes would*/
+    for(i = 0; i < no_of_readers; i++){
+
+        fflush(stdout);
+        pid = fork();
+        if(pid < 0)
+            return 1;
+        if(!pid){
+            close(start_pipe[1]);
+            opt = shm_bench_reader(i, no_of_readers, (uint64_t)no_of_entries,
+                    start_pipe[0]);
+            fflush(stdout);
+            _exit(opt);
+        }
+    }
+    close(start_pipe[0]);
+
+    return shm_bench_producer((uint64_t)no_of_entries, no_of_readers,
+                (size_t)no_of_entries * (sizeof(shm_entry_t) + 64) * 3 / 2 +
+                (1 << 20), start_pipe[1]);
+}
@@ -0,0 +1,574 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_stats.c
+ *
+ *    Description:  This file implements the machine readable statistics snapshot
+ *                  APIs of Memory Manager
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 10:05:12 AM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <inttypes.h>
+#include "mm.h"
+
+static void
+mm_fill_family_stats(vm_page_family_t *vm_page_family,
+                     mm_family_stats_t *family_stats){
+
+    block_meta_data_t *biggest_free_block =
+        mm_get_biggest_free_block_page_family(vm_page_family);
+
+    memset(family_stats, 0, sizeof(mm_family_stats_t));
+    strncpy(family_stats->struct_name, vm_page_family->struct_name,
+        MM_MAX_STRUCT_NAME - 1);
+    family_stats->struct_size = vm_page_family->struct_size;
+    family_stats->vm_page_size =
+        vm_page_family->vm_page_units * GB_SYSTEM_PAGE_SIZE;
+    family_stats->no_of_vm_pages =
+        MM_COUNTER_READ(vm_page_family->no_of_vm_pages);
+    family_stats->vm_page_memory =
+        family_stats->no_of_vm_pages * family_stats->vm_page_size;
+    family_stats->memory_in_use_by_app =
+        MM_COUNTER_READ(vm_page_family->total_memory_in_use_by_app);
+    family_stats->peak_memory_in_use_by_app =
+        MM_COUNTER_READ(vm_page_family->peak_memory_in_use_by_app);
+    family_stats->free_memory =
+        MM_COUNTER_READ(vm_page_family->total_free_memory);
+    family_stats->no_of_free_blocks =
+        MM_COUNTER_READ(vm_page_family->no_of_free_blocks);
+    family_stats->no_of_allocated_blocks =
+        MM_COUNTER_READ(vm_page_family->no_of_allocated_blocks);
+    family_stats->largest_free_block =
+        biggest_free_block ? biggest_free_block->block_size : 0;
+    family_stats->no_of_system_calls =
+        MM_COUNTER_READ(vm_page_family->no_of_system_calls_to_alloc_dealloc_vm_pages);
+    family_stats->no_of_allocations =
+        MM_COUNTER_READ(vm_page_family->no_of_allocations);
+    family_stats->no_of_deallocations =
+        MM_COUNTER_READ(vm_page_family->no_of_deallocations);
+    family_stats->total_memory_allocated =
+        MM_COUNTER_READ(vm_page_family->total_memory_allocated);
+    family_stats->no_of_compaction_passes =
+        MM_COUNTER_READ(vm_page_family->no_of_compaction_passes);
+    family_stats->compaction_pages_reclaimed =
+        MM_COUNTER_READ(vm_page_family->compaction_pages_reclaimed);
+    family_stats->compaction_bytes_moved =
+        MM_COUNTER_READ(vm_page_family->compaction_bytes_moved);
+    family_stats->last_pass_pages_reclaimed =
+        MM_COUNTER_READ(vm_page_family->last_pass_pages_reclaimed);
+    family_stats->soft_page_limit =
+        vm_page_family->soft_page_limit == MM_NO_LIMIT ?
+        0 : vm_page_family->soft_page_limit;
+    family_stats->hard_page_limit =
+        vm_page_family->hard_page_limit == MM_NO_LIMIT ?
+        0 : vm_page_family->hard_page_limit;
+    family_stats->no_of_soft_limit_hits =
+        MM_COUNTER_READ(vm_page_family->no_of_soft_limit_hits);
+    family_stats->no_of_hard_limit_failures =
+        MM_COUNTER_READ(vm_page_family->no_of_hard_limit_failures);
+    family_stats->no_of_reserved_vm_pages =
+        MM_COUNTER_READ(vm_page_family->no_of_reserved_vm_pages);
+}
+
+void
+mm_get_stats(mm_stats_t *stats){
+
+    vm_page_family_t *vm_page_family_curr;
+    mm_family_stats_t family_stats;
+
+    memset(stats, 0, sizeof(mm_stats_t));
+    stats->system_page_size = GB_SYSTEM_PAGE_SIZE;
+    stats->peak_memory_in_use_by_app =
+        MM_COUNTER_READ(gb_peak_memory_in_use_by_app);
+    stats->peak_vm_page_memory =
+        MM_COUNTER_READ(gb_peak_vm_page_memory);
+    stats->soft_vm_page_memory_limit =
+        gb_soft_vm_page_memory_limit == MM_NO_LIMIT ?
+        0 : gb_soft_vm_page_memory_limit;
+    stats->hard_vm_page_memory_limit =
+        gb_hard_vm_page_memory_limit == MM_NO_LIMIT ?
+        0 : gb_hard_vm_page_memory_limit;
+
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, vm_page_family_curr){
+
+        mm_fill_family_stats(vm_page_family_curr, &family_stats);
+
+        stats->no_of_families++;
+        stats->no_of_vm_pages += family_stats.no_of_vm_pages;
+        stats->vm_page_memory += family_stats.vm_page_memory;
+        stats->memory_in_use_by_app += family_stats.memory_in_use_by_app;
+        stats->free_memory += family_stats.free_memory;
+        stats->no_of_free_blocks += family_stats.no_of_free_blocks;
+        stats->no_of_allocated_blocks += family_stats.no_of_allocated_blocks;
+        stats->no_of_system_calls += family_stats.no_of_system_calls;
+        stats->no_of_allocations += family_stats.no_of_allocations;
+        stats->no_of_deallocations += family_stats.no_of_deallocations;
+        stats->total_memory_allocated += family_stats.total_memory_allocated;
+        stats->no_of_soft_limit_hits += family_stats.no_of_soft_limit_hits;
+        stats->no_of_hard_limit_failures +=
+            family_stats.no_of_hard_limit_failures;
+        stats->no_of_reserved_vm_pages += family_stats.no_of_reserved_vm_pages;
+        if(family_stats.largest_free_block > stats->largest_free_block)
+            stats->largest_free_block = family_stats.largest_free_block;
+
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
+}
+
+int
+mm_get_family_stats(char *struct_name, mm_family_stats_t *family_stats){
+
+    vm_page_family_t *vm_page_family =
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family)
+        return -1;
+
+    mm_fill_family_stats(vm_page_family, family_stats);
+    return 0;
+}
+
+/* Account every byte of every VM page of the family as app data, meta
+ * data, free or unusable. Unusable bytes are the slivers left behind
+ * a block when the remainder was too small to be split into a free
+ * block, including the tail at the bottom of a packed VM page*/
+static void
+mm_fill_family_frag_stats(vm_page_family_t *vm_page_family,
+                          mm_frag_stats_t *frag_stats){
+
+    vm_page_t *vm_page;
+    block_meta_data_t *block_meta_data;
+    char *block_end, *next_block_start;
+    uint64_t page_bytes_accounted, page_bytes_in_use;
+    uint32_t page_largest_free_block;
+
+    ITERATE_VM_PAGE_PER_FAMILY_BEGIN(vm_page_family, vm_page){
+
+        frag_stats->no_of_vm_pages++;
+        frag_stats->vm_page_memory += vm_page->page_size;
+        frag_stats->meta_data_bytes += offset_of(vm_page_t, block_meta_data);
+        page_bytes_accounted = offset_of(vm_page_t, block_meta_data);
+        page_bytes_in_use = 0;
+        page_largest_free_block = 0;
+
+        ITERATE_VM_PAGE_ALL_BLOCKS_BEGIN(vm_page, block_meta_data){
+
+            frag_stats->meta_data_bytes += sizeof(block_meta_data_t);
+
+            if(block_meta_data->is_free == MM_TRUE){
+                frag_stats->no_of_free_blocks++;
+                frag_stats->free_bytes += block_meta_data->block_size;
+                if(block_meta_data->block_size > frag_stats->largest_free_block)
+                    frag_stats->largest_free_block = block_meta_data->block_size;
+                if(block_meta_data->block_size > page_largest_free_block)
+                    page_largest_free_block = block_meta_data->block_size;
+            }
+            else{
+                frag_stats->no_of_allocated_blocks++;
+                frag_stats->app_data_bytes += block_meta_data->block_size;
+                page_bytes_in_use +=
+                    sizeof(block_meta_data_t) + block_meta_data->block_size;
+            }
+
+            block_end = (char *)(block_meta_data + 1) +
+                block_meta_data->block_size;
+            next_block_start = NEXT_META_BLOCK(block_meta_data) ?
+                (char *)NEXT_META_BLOCK(block_meta_data) :
+                (char *)vm_page + vm_page->page_size;
+            frag_stats->unusable_bytes += next_block_start - block_end;
+            page_bytes_accounted += next_block_start - (char *)block_meta_data;
+
+        } ITERATE_VM_PAGE_ALL_BLOCKS_END(vm_page, block_meta_data);
+
+        assert(page_bytes_accounted == vm_page->page_size);
+        assert(page_bytes_in_use == vm_page->bytes_in_use);
+        assert(page_largest_free_block == vm_page->largest_free_block);
+
+    } ITERATE_VM_PAGE_PER_FAMILY_END(vm_page_family, vm_page);
+}
+
+static void
+mm_compute_frag_ratios(mm_frag_stats_t *frag_stats){
+
+    if(frag_stats->free_bytes){
+        frag_stats->external_fragmentation = 1.0 -
+            (double)frag_stats->largest_free_block /
+            (double)frag_stats->free_bytes;
+    }
+    if(frag_stats->vm_page_memory){
+        frag_stats->internal_waste =
+            (double)(frag_stats->meta_data_bytes + frag_stats->unusable_bytes) /
+            (double)frag_stats->vm_page_memory;
+        frag_stats->page_utilization =
+            (double)frag_stats->app_data_bytes /
+            (double)frag_stats->vm_page_memory;
+    }
+}
+
+void
+mm_get_frag_stats(mm_frag_stats_t *frag_stats){
+
+    vm_page_family_t *vm_page_family_curr;
+
+    memset(frag_stats, 0, sizeof(mm_frag_stats_t));
+
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, vm_page_family_curr){
+
+        mm_fill_family_frag_stats(vm_page_family_curr, frag_stats);
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
+
+    mm_compute_frag_ratios(frag_stats);
+}
+
+int
+mm_get_family_frag_stats(char *struct_name, mm_frag_stats_t *frag_stats){
+
+    vm_page_family_t *vm_page_family =
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family)
+        return -1;
+
+    memset(frag_stats, 0, sizeof(mm_frag_stats_t));
+    mm_fill_family_frag_stats(vm_page_family, frag_stats);
+    mm_compute_frag_ratios(frag_stats);
+    return 0;
+}
+
+#ifdef MM_LATENCY_STATS
+static const char *mm_latency_op_names[MM_LATENCY_OP_MAX] = {
+
+    "alloc", "free", "page_acquire", "page_release"
+};
+
+/* Upper bound of the histogram bucket holding the pct'th percentile*/
+static uint64_t
+mm_latency_percentile(mm_latency_stats_t *latency_stats, double pct){
+
+    uint32_t i;
+    uint64_t cumulative_count = 0;
+    double rank = (latency_stats->count * pct) / 100.0;
+
+    for(i = 0; i < MM_LATENCY_HIST_BUCKETS; i++){
+        cumulative_count += latency_stats->bucket[i];
+        if(cumulative_count && (double)cumulative_count >= rank)
+            return i ? (1ULL << i) - 1 : 0;
+    }
+    return latency_stats->max;
+}
+
+static void
+mm_fill_latency_stats(vm_page_family_t *vm_page_family,
+                      mm_latency_op_t op,
+                      mm_latency_stats_t *latency_stats){
+
+    uint32_t i;
+    mm_latency_hist_t *latency_hist = &vm_page_family->latency_hist[op];
+
+    memset(latency_stats, 0, sizeof(mm_latency_stats_t));
+    for(i = 0; i < MM_LATENCY_HIST_BUCKETS; i++){
+        latency_stats->bucket[i] = MM_COUNTER_READ(latency_hist->bucket[i]);
+        latency_stats->count += latency_stats->bucket[i];
+    }
+    latency_stats->total = MM_COUNTER_READ(latency_hist->total);
+    latency_stats->max = MM_COUNTER_READ(latency_hist->max);
+    if(!latency_stats->count)
+        return;
+    latency_stats->p50 = mm_latency_percentile(latency_stats, 50.0);
+    latency_stats->p99 = mm_latency_percentile(latency_stats, 99.0);
+    latency_stats->p999 = mm_latency_percentile(latency_stats, 99.9);
+    if(latency_stats->p999 > latency_stats->max)
+        latency_stats->p999 = latency_stats->max;
+    if(latency_stats->p99 > latency_stats->max)
+        latency_stats->p99 = latency_stats->max;
+    if(latency_stats->p50 > latency_stats->max)
+        latency_stats->p50 = latency_stats->max;
+}
+
+void
+mm_print_family_latency_stats(vm_page_family_t *vm_page_family){
+
+    mm_latency_op_t op;
+    mm_latency_stats_t latency_stats;
+
+    for(op = MM_LATENCY_OP_ALLOC; op < MM_LATENCY_OP_MAX; op++){
+
+        mm_fill_latency_stats(vm_page_family, op, &latency_stats);
+        if(!latency_stats.count)
+            continue;
+
+        printf("\t%-12s latency (" MM_LATENCY_UNIT ") : #%" PRIu64 ", avg %" PRIu64
+            ", p50 <= %" PRIu64 ", p99 <= %" PRIu64 ", p999 <= %" PRIu64
+            ", max %" PRIu64 "\n",
+            mm_latency_op_names[op], latency_stats.count,
+            latency_stats.total / latency_stats.count,
+            latency_stats.p50, latency_stats.p99, latency_stats.p999,
+            latency_stats.max);
+    }
+}
+#endif
+
+int
+mm_get_family_latency_stats(char *struct_name,
+                            mm_latency_op_t op,
+                            mm_latency_stats_t *latency_stats){
+
+#ifdef MM_LATENCY_STATS
+    vm_page_family_t *vm_page_family =
+        lookup_page_family_by_name(struct_name);
+
+    if(!vm_page_family || op >= MM_LATENCY_OP_MAX)
+        return -1;
+
+    mm_fill_latency_stats(vm_page_family, op, latency_stats);
+    return 0;
+#else
+    (void)struct_name;
+    (void)op;
+    memset(latency_stats, 0, sizeof(mm_latency_stats_t));
+    return -1;
+#endif
+}
+
+/* Append to the serialization buffer in snprintf() fashion, keep
+ * counting the bytes once the buffer is exhausted*/
+#define MM_STATS_PRINT(buff, buff_size, len, ...)                          \
+    len += snprintf((buff) + ((size_t)(len) < (buff_size) ? (len) : 0),   \
+                ((size_t)(len) < (buff_size) ? (buff_size) - (len) : 0),  \
+                __VA_ARGS__)
+
+/* Family names are free form, C++ type names (e.g. of
+ * mm::family_allocator) carry commas, quotes may come from anywhere.
+ * A name escaped to a \u00XX sequence per byte still fits*/
+#define MM_STATS_ESCAPED_NAME_SIZE  (MM_MAX_STRUCT_NAME * 6)
+
+static const char *
+mm_stats_json_escape(const char *struct_name, char *escaped_name){
+
+    int i, j = 0;
+    unsigned char c;
+
+    for(i = 0; i < MM_MAX_STRUCT_NAME && struct_name[i]; i++){
+
+        c = (unsigned char)struct_name[i];
+        if(c == '"' || c == '\\'){
+            escaped_name[j++] = '\\';
+            escaped_name[j++] = c;
+        }
+        else if(c < 0x20){
+            j += sprintf(&escaped_name[j], "\\u%04x", c);
+        }
+        else{
+            escaped_name[j++] = c;
+        }
+    }
+    escaped_name[j] = '\0';
+    return escaped_name;
+}
+
+/*RFC 4180, a field with a separator, quote or line break is quoted*/
+static const char *
+mm_stats_csv_escape(const char *struct_name, char *escaped_name){
+
+    int i, j = 0;
+
+    if(!strpbrk(struct_name, ",\"\r\n"))
+        return struct_name;
+
+    escaped_name[j++] = '"';
+    for(i = 0; i < MM_MAX_STRUCT_NAME && struct_name[i]; i++){
+
+        if(struct_name[i] == '"')
+            escaped_name[j++] = '"';
+        escaped_name[j++] = struct_name[i];
+    }
+    escaped_name[j++] = '"';
+    escaped_name[j] = '\0';
+    return escaped_name;
+}
+
+int
+mm_stats_to_json(char *buff, size_t buff_size){
+
+    int len = 0;
+    uint32_t no_of_families_serialized = 0;
+    mm_stats_t stats;
+    mm_family_stats_t family_stats;
+    vm_page_family_t *vm_page_family_curr;
+    char escaped_name[MM_STATS_ESCAPED_NAME_SIZE];
+
+    mm_get_stats(&stats);
+
+    MM_STATS_PRINT(buff, buff_size, len,
+        "{\"system_page_size\":%u,\"no_of_families\":%u,"
+        "\"no_of_vm_pages\":%" PRIu64 ",\"no_of_reserved_vm_pages\":%" PRIu64 ","
+        "\"vm_page_memory\":%" PRIu64 ",\"peak_vm_page_memory\":%" PRIu64 ","
+        "\"memory_in_use_by_app\":%" PRIu64 ","
+        "\"peak_memory_in_use_by_app\":%" PRIu64 ","
+        "\"free_memory\":%" PRIu64 ",\"no_of_free_blocks\":%" PRIu64 ","
+        "\"no_of_allocated_blocks\":%" PRIu64 ","
+        "\"largest_free_block\":%" PRIu64 ",\"no_of_system_calls\":%" PRIu64 ","
+        "\"no_of_allocations\":%" PRIu64 ",\"no_of_deallocations\":%" PRIu64 ","
+        "\"total_memory_allocated\":%" PRIu64 ","
+        "\"limits\":{\"soft_bytes\":%" PRIu64 ",\"hard_bytes\":%" PRIu64 ","
+        "\"soft_limit_hits\":%" PRIu64 ",\"hard_limit_failures\":%" PRIu64 "},"
+        "\"page_families\":[",
+        stats.system_page_size, stats.no_of_families,
+        stats.no_of_vm_pages, stats.no_of_reserved_vm_pages,
+        stats.vm_page_memory, stats.peak_vm_page_memory,
+        stats.memory_in_use_by_app, stats.peak_memory_in_use_by_app,
+        stats.free_memory, stats.no_of_free_blocks,
+        stats.no_of_allocated_blocks, stats.largest_free_block,
+        stats.no_of_system_calls, stats.no_of_allocations,
+        stats.no_of_deallocations, stats.total_memory_allocated,
+        stats.soft_vm_page_memory_limit, stats.hard_vm_page_memory_limit,
+        stats.no_of_soft_limit_hits, stats.no_of_hard_limit_failures);
+
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, vm_page_family_curr){
+
+        mm_fill_family_stats(vm_page_family_curr, &family_stats);
+
+        MM_STATS_PRINT(buff, buff_size, len,
+            "%s{\"struct_name\":\"%s\",\"struct_size\":%u,"
+            "\"vm_page_size\":%u,\"no_of_vm_pages\":%" PRIu64 ","
+            "\"no_of_reserved_vm_pages\":%" PRIu64 ","
+            "\"vm_page_memory\":%" PRIu64 ","
+            "\"memory_in_use_by_app\":%" PRIu64 ","
+            "\"peak_memory_in_use_by_app\":%" PRIu64 ","
+            "\"free_memory\":%" PRIu64 ",\"no_of_free_blocks\":%" PRIu64 ","
+            "\"no_of_allocated_blocks\":%" PRIu64 ","
+            "\"largest_free_block\":%" PRIu64 ",\"no_of_system_calls\":%" PRIu64 ","
+            "\"no_of_allocations\":%" PRIu64 ",\"no_of_deallocations\":%" PRIu64 ","
+            "\"total_memory_allocated\":%" PRIu64 ","
+            "\"compaction\":{\"passes\":%" PRIu64 ","
+            "\"pages_reclaimed\":%" PRIu64 ",\"bytes_moved\":%" PRIu64 ","
+            "\"last_pass_pages_reclaimed\":%" PRIu64 "},"
+            "\"limits\":{\"soft_pages\":%" PRIu64 ",\"hard_pages\":%" PRIu64 ","
+            "\"soft_limit_hits\":%" PRIu64 ",\"hard_limit_failures\":%" PRIu64 "}",
+            no_of_families_serialized++ ? "," : "",
+            mm_stats_json_escape(family_stats.struct_name, escaped_name),
+            family_stats.struct_size,
+            family_stats.vm_page_size, family_stats.no_of_vm_pages,
+            family_stats.no_of_reserved_vm_pages,
+            family_stats.vm_page_memory, family_stats.memory_in_use_by_app,
+            family_stats.peak_memory_in_use_by_app,
+            family_stats.free_memory, family_stats.no_of_free_blocks,
+            family_stats.no_of_allocated_blocks,
+            family_stats.largest_free_block,
+            family_stats.no_of_system_calls,
+            family_stats.no_of_allocations,
+            family_stats.no_of_deallocations,
+            family_stats.total_memory_allocated,
+            family_stats.no_of_compaction_passes,
+            family_stats.compaction_pages_reclaimed,
+            family_stats.compaction_bytes_moved,
+            family_stats.last_pass_pages_reclaimed,
+            family_stats.soft_page_limit, family_stats.hard_page_limit,
+            family_stats.no_of_soft_limit_hits,
+            family_stats.no_of_hard_limit_failures);
+
+#ifdef MM_LATENCY_STATS
+        mm_latency_op_t op;
+        mm_latency_stats_t latency_stats;
+
+        MM_STATS_PRINT(buff, buff_size, len, ",\"latency\":{");
+        for(op = MM_LATENCY_OP_ALLOC; op < MM_LATENCY_OP_MAX; op++){
+
+            mm_fill_latency_stats(vm_page_family_curr, op, &latency_stats);
+            MM_STATS_PRINT(buff, buff_size, len,
+                "%s\"%s\":{\"count\":%" PRIu64 ",\"total\":%" PRIu64 ","
+                "\"p50\":%" PRIu64 ",\"p99\":%" PRIu64 ",\"p999\":%" PRIu64 ","
+                "\"max\":%" PRIu64 "}",
+                op == MM_LATENCY_OP_ALLOC ? "" : ",",
+                mm_latency_op_names[op], latency_stats.count,
+                latency_stats.total, latency_stats.p50, latency_stats.p99,
+                latency_stats.p999, latency_stats.max);
+        }
+        MM_STATS_PRINT(buff, buff_size, len, ",\"unit\":\"" MM_LATENCY_UNIT "\"}");
+#endif
+        MM_STATS_PRINT(buff, buff_size, len, "}");
+
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
+
+    MM_STATS_PRINT(buff, buff_size, len, "]}");
+    return len;
+}
+
+#define MM_STATS_CSV_ROW_FMT                                            \
+    "%s,%u,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 \
+    ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64         \
+    ",%" PRIu64 ",%" PRIu64 "\n"
+
+int
+mm_stats_to_csv(char *buff, size_t buff_size){
+
+    int len = 0;
+    mm_stats_t stats;
+    mm_family_stats_t family_stats;
+    vm_page_family_t *vm_page_family_curr;
+    char escaped_name[MM_STATS_ESCAPED_NAME_SIZE];
+
+    MM_STATS_PRINT(buff, buff_size, len,
+        "struct_name,struct_size,vm_page_size,no_of_vm_pages,vm_page_memory,"
+        "memory_in_use_by_app,peak_memory_in_use_by_app,free_memory,"
+        "no_of_free_blocks,no_of_allocated_blocks,largest_free_block,"
+        "no_of_system_calls,no_of_allocations,no_of_deallocations,"
+        "total_memory_allocated\n");
+
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families, vm_page_family_curr){
+
+        mm_fill_family_stats(vm_page_family_curr, &family_stats);
+
+        MM_STATS_PRINT(buff, buff_size, len, MM_STATS_CSV_ROW_FMT,
+            mm_stats_csv_escape(family_stats.struct_name, escaped_name),
+            family_stats.struct_size,
+            family_stats.vm_page_size, family_stats.no_of_vm_pages,
+            family_stats.vm_page_memory, family_stats.memory_in_use_by_app,
+            family_stats.peak_memory_in_use_by_app,
+            family_stats.free_memory, family_stats.no_of_free_blocks,
+            family_stats.no_of_allocated_blocks,
+            family_stats.largest_free_block,
+            family_stats.no_of_system_calls,
+            family_stats.no_of_allocations,
+            family_stats.no_of_deallocations,
+            family_stats.total_memory_allocated);
+
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
+
+    mm_get_stats(&stats);
+
+    /*Summary row, struct size and vm page size do not apply*/
+    MM_STATS_PRINT(buff, buff_size, len, MM_STATS_CSV_ROW_FMT,
+        "total", 0, 0, stats.no_of_vm_pages,
+        stats.vm_page_memory, stats.memory_in_use_by_app,
+        stats.peak_memory_in_use_by_app,
+        stats.free_memory, stats.no_of_free_blocks,
+        stats.no_of_allocated_blocks, stats.largest_free_block,
+        stats.no_of_system_calls, stats.no_of_allocations,
+        stats.no_of_deallocations, stats.total_memory_allocated);
+
+    return len;
+}
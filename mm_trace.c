@@ -0,0 +1,290 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  mm_trace.c
+ *
+ *    Description:  This file implements the per thread allocation event trace
+ *                  of Memory Manager
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 02:40:51 PM
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "mm.h"
+
+#ifdef MM_TRACE
+
+#if MM_TRACE_RING_RECORDS & (MM_TRACE_RING_RECORDS - 1)
+#error "MM_TRACE_RING_RECORDS must be a power of 2"
+#endif
+
+/* Records copied out of a ring per chunk while dumping, the copy lives
+ * on the stack since the dump may run inside a signal handler*/
+#define MM_TRACE_DUMP_CHUNK_RECORDS 128
+
+/* Only the owner thread writes into a ring. head is the no of records
+ * ever written, it is published after the record is filled in, so that
+ * a dumper can detect the records overwritten while it was copying them*/
+typedef struct mm_trace_ring_{
+
+    struct mm_trace_ring_ *next;
+    uint32_t thread_id;
+    uint64_t head;
+    mm_trace_record_t record[MM_TRACE_RING_RECORDS];
+} mm_trace_ring_t;
+
+/*Rings are never freed, so that records of exited threads can be dumped*/
+static mm_trace_ring_t *gb_trace_rings = NULL;
+static __thread mm_trace_ring_t *mm_trace_thread_ring = NULL;
+static char mm_trace_signal_file_name[256];
+
+/* Rings are taken directly from the kernel, not from heap segment, so
+ * that tracing does not perturb the heap layout being traced*/
+static mm_trace_ring_t *
+mm_trace_get_thread_ring(){
+
+    mm_trace_ring_t *ring = mm_trace_thread_ring;
+
+    if(ring)
+        return ring;
+
+    ring = mmap(NULL, sizeof(mm_trace_ring_t), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(ring == MAP_FAILED)
+        return NULL;
+
+    ring->thread_id = (uint32_t)syscall(SYS_gettid);
+    ring->head = 0;
+    ring->next = __atomic_load_n(&gb_trace_rings, __ATOMIC_ACQUIRE);
+    while(!__atomic_compare_exchange_n(&gb_trace_rings, &ring->next, ring,
+            0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+
+    mm_trace_thread_ring = ring;
+    return ring;
+}
+
+void
+mm_trace_record(vm_page_family_t *vm_page_family, mm_trace_op_t op,
+                void *addr, void *page, uint32_t size){
+
+    struct timespec ts;
+    mm_trace_record_t *record;
+    mm_trace_ring_t *ring = mm_trace_get_thread_ring();
+
+    if(!ring)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    record = &ring->record[ring->head & (MM_TRACE_RING_RECORDS - 1)];
+    record->ts = ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+    record->addr = (uint64_t)(uintptr_t)addr;
+    record->page = (uint64_t)(uintptr_t)page;
+    record->size = size;
+    record->family_id = (uint16_t)vm_page_family->family_id;
+    record->op = (uint8_t)op;
+    record->reserved = 0;
+
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+static int
+mm_trace_write(int fd, const void *buff, size_t size){
+
+    const char *ptr = buff;
+    ssize_t rc;
+
+    while(size){
+        rc = write(fd, ptr, size);
+        if(rc < 0){
+            if(errno == EINTR)
+                continue;
+            return -1;
+        }
+        ptr += rc;
+        size -= rc;
+    }
+    return 0;
+}
+
+static int
+mm_trace_dump_ring(int fd, mm_trace_ring_t *ring){
+
+    mm_trace_record_t records[MM_TRACE_DUMP_CHUNK_RECORDS];
+    mm_trace_chunk_hdr_t chunk_hdr;
+    uint64_t head, seq, valid_seq, no_of_records, i;
+    int no_of_records_written = 0;
+
+    head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    seq = head > MM_TRACE_RING_RECORDS ? head - MM_TRACE_RING_RECORDS : 0;
+
+    for( ; seq < head; seq += no_of_records){
+
+        no_of_records = head - seq;
+        if(no_of_records > MM_TRACE_DUMP_CHUNK_RECORDS)
+            no_of_records = MM_TRACE_DUMP_CHUNK_RECORDS;
+
+        for(i = 0; i < no_of_records; i++){
+            records[i] =
+                ring->record[(seq + i) & (MM_TRACE_RING_RECORDS - 1)];
+        }
+
+        /* The owner thread starts overwriting record 'seq' only once
+         * head reaches seq + MM_TRACE_RING_RECORDS, drop the records
+         * which could have been overwritten while being copied*/
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        valid_seq = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        valid_seq = valid_seq >= MM_TRACE_RING_RECORDS ?
+            valid_seq - MM_TRACE_RING_RECORDS + 1 : 0;
+
+        if(valid_seq >= seq + no_of_records)
+            continue;
+
+        i = valid_seq > seq ? valid_seq - seq : 0;
+        chunk_hdr.thread_id = ring->thread_id;
+        chunk_hdr.no_of_records = (uint32_t)(no_of_records - i);
+
+        if(mm_trace_write(fd, &chunk_hdr, sizeof(chunk_hdr)) < 0 ||
+            mm_trace_write(fd, &records[i],
+                chunk_hdr.no_of_records * sizeof(mm_trace_record_t)) < 0){
+            return -1;
+        }
+        no_of_records_written += chunk_hdr.no_of_records;
+    }
+    return no_of_records_written;
+}
+
+int
+mm_trace_dump(const char *file_name){
+
+    int fd, rc;
+    int no_of_records_written = 0;
+    mm_trace_file_hdr_t file_hdr;
+    mm_trace_family_t trace_family;
+    mm_trace_ring_t *ring;
+    vm_page_family_t *vm_page_family_curr;
+
+    fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if(fd < 0)
+        return -1;
+
+    memset(&file_hdr, 0, sizeof(file_hdr));
+    memcpy(file_hdr.magic, MM_TRACE_MAGIC, sizeof(file_hdr.magic));
+    file_hdr.version = MM_TRACE_VERSION;
+    file_hdr.record_size = sizeof(mm_trace_record_t);
+    file_hdr.system_page_size = GB_SYSTEM_PAGE_SIZE;
+
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families,
+        vm_page_family_curr){
+
+        file_hdr.no_of_families++;
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
+
+    if(mm_trace_write(fd, &file_hdr, sizeof(file_hdr)) < 0)
+        goto error;
+
+    ITERATE_PAGE_FAMILIES_BEGIN(gb_first_vm_page_for_families,
+        vm_page_family_curr){
+
+        memset(&trace_family, 0, sizeof(trace_family));
+        memcpy(trace_family.struct_name, vm_page_family_curr->struct_name,
+            MM_MAX_STRUCT_NAME);
+        trace_family.struct_size = vm_page_family_curr->struct_size;
+        trace_family.family_id = (uint16_t)vm_page_family_curr->family_id;
+        trace_family.vm_page_units = (uint16_t)vm_page_family_curr->vm_page_units;
+
+        if(mm_trace_write(fd, &trace_family, sizeof(trace_family)) < 0)
+            goto error;
+    } ITERATE_PAGE_FAMILIES_END(gb_first_vm_page_for_families, vm_page_family_curr);
+
+    for(ring = __atomic_load_n(&gb_trace_rings, __ATOMIC_ACQUIRE);
+        ring; ring = ring->next){
+
+        rc = mm_trace_dump_ring(fd, ring);
+        if(rc < 0)
+            goto error;
+        no_of_records_written += rc;
+    }
+
+    close(fd);
+    return no_of_records_written;
+
+    error:
+    close(fd);
+    return -1;
+}
+
+static void
+mm_trace_signal_handler(int signo){
+
+    int saved_errno = errno;
+
+    (void)signo;
+    mm_trace_dump(mm_trace_signal_file_name);
+    errno = saved_errno;
+}
+
+int
+mm_trace_dump_on_signal(int signo, const char *file_name){
+
+    struct sigaction sa;
+
+    if(strlen(file_name) >= sizeof(mm_trace_signal_file_name))
+        return -1;
+
+    strcpy(mm_trace_signal_file_name, file_name);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = mm_trace_signal_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    return sigaction(signo, &sa, NULL);
+}
+
+#else
+
+int
+mm_trace_dump(const char *file_name){
+
+    (void)file_name;
+    return -1;
+}
+
+int
+mm_trace_dump_on_signal(int signo, const char *file_name){
+
+    (void)signo;
+    (void)file_name;
+    return -1;
+}
+
+#endif /*MM_TRACE*/
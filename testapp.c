@@ -18,12 +18,19 @@ typedef struct student_ {
     struct student_ *next;
 } student_t;
 
+typedef struct pkt_buff_ {
+
+    char data[1500];
+} pkt_buff_t;
+
 int
 main(int argc, char **argv){
 
     mm_init();
     MM_REG_STRUCT(emp_t);
     MM_REG_STRUCT(student_t);
+    MM_REG_STRUCT(pkt_buff_t);
+    mm_print_registered_page_families();
 #if 0
     emp_t *emp1 = xcalloc("emp_t", 1);
     emp_t *emp2 = xcalloc("emp_t", 1);
@@ -63,6 +70,12 @@ main(int argc, char **argv){
     }
     mm_print_memory_usage(0);
     mm_print_block_usage();
+
+    char stats_buff[2048];
+    mm_stats_to_json(stats_buff, sizeof(stats_buff));
+    printf("%s\n", stats_buff);
+    mm_stats_to_csv(stats_buff, sizeof(stats_buff));
+    printf("%s", stats_buff);
     #if 1
     i = 0;
     student_t *next = NULL;
@@ -32,6 +32,14 @@
 #define __UAPI_MM__
 
 #include <stdint.h>
+#include <stddef.h> /*for size_t*/
+#include <string.h> /*for memset in typed allocators*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MM_MAX_STRUCT_NAME 32
 
 void *
 xcalloc(char *struct_name, int units);
@@ -49,9 +57,609 @@ mm_instantiate_new_page_family(
  * Public APIs Exposed to the Application using Memory Manager
  */
 
+/* Placement policy decides which free block of the page family serves
+ * an allocation request*/
+typedef enum{
+
+    MM_PLACEMENT_WORST_FIT,     /*Biggest free block*/
+    MM_PLACEMENT_BEST_FIT,      /*Smallest free block which fits*/
+    MM_PLACEMENT_FIRST_FIT,     /*Lowest addressed free block which fits*/
+    MM_PLACEMENT_FULLEST_PAGE,  /*Best fit on the most occupied VM page, the default*/
+    MM_PLACEMENT_POLICY_MAX
+} mm_placement_policy_t;
+
+/*Return -1 if family is not registered*/
+int
+mm_set_page_family_placement_policy(char *struct_name,
+                                    mm_placement_policy_t placement_policy);
+
+const char *
+mm_placement_policy_str(mm_placement_policy_t placement_policy);
+
+/* Limits on the VM page memory of a family or of the whole Memory
+ * Manager, checked whenever a VM page is acquired. Past a soft limit the
+ * pressure callback is called and the VM page is acquired all the same.
+ * Past a hard limit the pressure callback is called too, then the
+ * allocation fails unless the callback released enough memory. Page
+ * limits of a family count its VM pages, those of the Memory Manager
+ * count system pages. 0 means no limit. Families of shared heaps are
+ * only bounded by their own limits and by the size of the heap*/
+typedef struct mm_limits_{
+
+    uint64_t soft_bytes;
+    uint64_t hard_bytes;
+    uint64_t soft_pages;
+    uint64_t hard_pages;
+} mm_limits_t;
+
+/*Return -1 if family is not registered*/
+int
+mm_set_family_limits(char *struct_name, const mm_limits_t *limits);
+
+void
+mm_set_limits(const mm_limits_t *limits);
+
+typedef enum{
+
+    MM_PRESSURE_FAMILY_SOFT,
+    MM_PRESSURE_INSTANCE_SOFT,
+    MM_PRESSURE_FAMILY_HARD,
+    MM_PRESSURE_INSTANCE_HARD
+} mm_pressure_t;
+
+/* Called with the name of the family acquiring a VM page and the most
+ * severe limit it crossed. The callback may free memory, with xfree(),
+ * mm_obj_cache_reap(), or mm_family_reset() of other families which are
+ * not the family of an arena or of an object cache and have no objects
+ * deferred by xfree_deferred(), mm_family_reset() fails for the others
+ * and for the family under pressure. The callback must not allocate
+ * from the family under pressure. It is not called again for VM pages
+ * acquired while it runs. Destroying a family would move other family
+ * records under the caller, mm_family_destroy(), mm_arena_destroy() and
+ * mm_obj_cache_destroy() fail while it runs*/
+typedef void (*mm_pressure_cb_t)(char *struct_name, mm_pressure_t pressure,
+                                 void *arg);
+
+/*NULL unregisters the callback*/
+void
+mm_register_pressure_callback(mm_pressure_cb_t pressure_cb, void *arg);
+
+/* Acquire ahead of time enough VM pages for the family to hold
+ * no_of_objects single objects, so that allocations do not have to
+ * acquire VM pages. VM pages reserved before and not used yet count
+ * toward no_of_objects. A reserved VM page is not released until a
+ * block of it has been allocated and freed, or the family is reset.
+ * With MM_RESERVE_PREFAULT, the VM pages are also faulted in. Return -1
+ * if the family is not registered or not every VM page could be
+ * acquired, VM pages acquired stay reserved*/
+#define MM_RESERVE_PREFAULT     (1 << 0)
+
+int
+mm_reserve(char *struct_name, uint64_t no_of_objects, uint32_t flags);
+
+/* Family handles let hot paths allocate without looking the family up
+ * by name, which costs O(no of families). A handle stays valid till the
+ * family is destroyed, and is never reused for another family*/
+typedef uint32_t mm_family_handle_t;
+
+#define MM_FAMILY_HANDLE_NULL   0
+
+/*Return MM_FAMILY_HANDLE_NULL if family is not registered*/
+mm_family_handle_t
+mm_get_family_handle(char *struct_name);
+
+/*Return NULL if the family has been destroyed*/
+void *
+xcalloc_family(mm_family_handle_t family_handle, int units);
+
+/* Allocate count single objects of the family, zeroed, into objs. The
+ * objects are carved back to back out of as few free blocks as possible,
+ * which costs one update of the free block list per free block rather
+ * than one per object. Return the no of objects allocated, each is freed
+ * with xfree()*/
+int
+xcalloc_family_bulk(mm_family_handle_t family_handle,
+                    void **objs, int count);
+
+/* Free count objects, of any families, in one go. Objects sharing a VM
+ * page are released together, with one walk of the VM page, which is
+ * cheaper than one xfree() per object as soon as objects of a VM page
+ * are freed together. objs is reordered*/
+void
+xfree_bulk(void **objs, int count);
+
+/* Typed allocators. MM_DEFINE_TYPED_ALLOCATOR(struct_name) emits
+ * struct_name##_alloc() and struct_name##_free() for the family of
+ * struct_name, registered on first use. The family handle is cached per
+ * translation unit and the size of struct_name is a compile-time
+ * constant, so allocating one object skips the lookup by name and the
+ * units * struct_size product, and zeroes the object with a memset of
+ * constant size. Objects are
+ * allocated and freed like any other, struct_name##_free() is xfree()*/
+void *
+mm_typed_alloc(mm_family_handle_t *family_handle,
+               char *struct_name,
+               uint32_t struct_size);
+
+#define MM_DEFINE_TYPED_ALLOCATOR(struct_name)                          \
+                                                                        \
+static mm_family_handle_t struct_name##_mm_family_handle;               \
+                                                                        \
+static inline struct_name *                                             \
+struct_name##_alloc(void){                                              \
+                                                                        \
+    void *obj = mm_typed_alloc(&struct_name##_mm_family_handle,         \
+                    (char *)#struct_name, sizeof(struct_name));         \
+                                                                        \
+    if(obj)                                                             \
+        memset(obj, 0, sizeof(struct_name));                            \
+    return (struct_name *)obj;                                          \
+}                                                                       \
+                                                                        \
+static inline void                                                      \
+struct_name##_free(struct_name *obj){                                   \
+                                                                        \
+    xfree(obj);                                                         \
+}
+
+/* Variable sized buffers, zeroed, freed with xfree(). Buffers up to
+ * MM_BUFF_MAX_CLASS_SIZE are rounded up to one of the size classes 16B,
+ * 32B .. 256B, 320B .. 8192B, bigger ones up to a VM page to 16B, each
+ * class is served by its own page family named MM_BUFF_FAMILY_PREFIX
+ * followed by the class size or "large", created on first use*/
+#define MM_BUFF_FAMILY_PREFIX   "mm_buff_"
+#define MM_BUFF_MAX_CLASS_SIZE  8192
+
+void *
+xcalloc_buff(uint32_t bytes);
+
+/*Biggest buffer xcalloc_buff() can serve*/
+uint32_t
+mm_get_buff_max_size();
+
+/* Movable objects are accessed through a handle, the Memory Manager may
+ * move them to another VM page of the family while compacting it. The
+ * pointer returned by mm_handle_deref() is valid only till the next
+ * compaction step of the family, re-derefer the handle after that.
+ * MM_HANDLE_NULL is never a valid handle*/
+typedef uint32_t mm_handle_t;
+
+#define MM_HANDLE_NULL  0
+
+mm_handle_t
+xcalloc_movable(char *struct_name, int units);
+
+/*Return NULL if the handle is not in use*/
+void *
+mm_handle_deref(mm_handle_t handle);
+
+/* Same as xfree() of the dereferenced pointer, xfree() of the pointer of
+ * a movable object releases its handle too*/
+void
+xfree_movable(mm_handle_t handle);
+
+/* Compaction evacuates movable objects out of the sparsest VM pages of
+ * a family into its fuller pages, and releases the emptied VM pages.
+ * VM pages holding any non-movable object are never evacuated. A pass
+ * is done in bounded steps, so that it can be interleaved with the
+ * application work*/
+typedef struct mm_compaction_stats_{
+
+    uint64_t blocks_moved;          /*By this step*/
+    uint64_t bytes_moved;           /*By this step, including meta blocks*/
+    uint64_t pages_reclaimed;       /*By this step*/
+    uint64_t pass_pages_reclaimed;  /*By the pass so far, including this step*/
+    uint32_t pass_complete;         /*Family can not be compacted any further*/
+} mm_compaction_stats_t;
+
+/* Move at most max_bytes of objects (at least one object, if any can be
+ * moved). Return 1 if the pass needs more steps, 0 if this step completed
+ * the pass, -1 if family is not registered or is shared with other
+ * processes. stats may be NULL*/
+int
+mm_compact_step(char *struct_name, uint32_t max_bytes,
+                mm_compaction_stats_t *stats);
+
+/*Run a complete pass, return the no of VM pages reclaimed or -1*/
+int
+mm_compact(char *struct_name);
+
+/* Free every object of the family at once. Blocks are not visited, all
+ * VM pages of the family are released by walking the page list, so the
+ * cost is O(no of VM pages) instead of O(no of objects). Pointers and
+ * handles to objects of the family become invalid. Return -1 if family
+ * is not registered or is the family of an arena or of an object cache,
+ * their idle objects and VM pages are released with mm_arena_reset()
+ * or mm_obj_cache_reap(). Return -1 as well while objects of the family
+ * are deferred by xfree_deferred(), or if called by the pressure callback
+ * for the family under pressure*/
+int
+mm_family_reset(char *struct_name);
+
+/* Reset the family and unregister it. Return -1 if family is not
+ * registered, is shared, is the family of an arena or of an object
+ * cache, has objects deferred by xfree_deferred(), or if called by the
+ * pressure callback*/
+int
+mm_family_destroy(char *struct_name);
+
+/* Arenas serve request scoped allocations : bump pointer allocation out
+ * of VM pages, no meta block per object and no individual free, all the
+ * objects are released at once by mm_arena_reset(), which keeps one VM
+ * page for the next round, mm_arena_destroy() releases all. An arena is a page
+ * family of its own named arena_name, so its VM pages show up in the
+ * statistics like any other family. Memory returned is zeroed and
+ * aligned to MM_ARENA_ALIGNMENT*/
+typedef struct mm_arena_ mm_arena_t;
+
+#define MM_ARENA_ALIGNMENT  16
+
+/*Return NULL if arena_name is already a registered page family*/
+mm_arena_t *
+mm_arena_create(char *arena_name);
+
+/*Return NULL if size exceeds the arena VM page or heap can not grow*/
+void *
+mm_arena_alloc(mm_arena_t *arena, uint32_t size);
+
+void
+mm_arena_reset(mm_arena_t *arena);
+
+/*Return -1 if called by the pressure callback, arena is left as it is*/
+int
+mm_arena_destroy(mm_arena_t *arena);
+
+/* Object caches serve objects which are expensive to initialize. The
+ * constructor runs once when an object is first carved out of a VM page
+ * of the cache, freed objects stay constructed and are handed out again
+ * as they are, not zeroed. The destructor runs only when the VM page of
+ * an idle object is reclaimed, by mm_obj_cache_reap(), which the cache
+ * also calls itself as idle objects pile up, or by
+ * mm_obj_cache_destroy(). An object cache is a page family of its own
+ * named cache_name, idle objects count as allocated in its statistics.
+ * ctor and dtor are optional*/
+typedef struct mm_obj_cache_ mm_obj_cache_t;
+
+typedef void (*mm_obj_ctor_t)(void *obj);
+typedef void (*mm_obj_dtor_t)(void *obj);
+
+/*Return NULL if cache_name is already a registered page family*/
+mm_obj_cache_t *
+mm_obj_cache_create(char *cache_name,
+                    uint32_t obj_size,
+                    mm_obj_ctor_t ctor,
+                    mm_obj_dtor_t dtor);
+
+/*Return NULL if heap can not grow*/
+void *
+mm_obj_cache_alloc(mm_obj_cache_t *obj_cache);
+
+void
+mm_obj_cache_free(mm_obj_cache_t *obj_cache, void *obj);
+
+/* Destruct and release the idle objects of every VM page which has no
+ * object in use. Return the no of objects destructed*/
+uint32_t
+mm_obj_cache_reap(mm_obj_cache_t *obj_cache);
+
+/* Return -1 if called by the pressure callback or while objects of the
+ * cache are deferred by xfree_deferred(), cache is left as it is*/
+int
+mm_obj_cache_destroy(mm_obj_cache_t *obj_cache);
+
+/* Persistent heaps keep page families in a file mapped shared, so that
+ * a restarted process maps its objects back instead of allocating them
+ * again. Families registered in a persistent heap are used like any
+ * other, XCALLOC() and xfree() included, and come back registered when
+ * the file is opened again. The file is mapped back at the same address
+ * if possible, else the Memory Manager structures in it are relocated,
+ * mm_persist_get_relocation() tells by how many bytes, pointers stored
+ * in the objects are then for the application to relocate. The root is
+ * the application's entry point into its objects, and is relocated too.
+ * The file is validated on open, it must be synced or closed at a point
+ * where no allocation is in progress. One process at a time*/
+typedef struct mm_persist_ mm_persist_t;
+
+/* A new file is created sparse with room for size bytes, size is
+ * ignored for an existing file. Return NULL if the file is in use or
+ * is not a valid persistent heap of this build*/
+mm_persist_t *
+mm_persist_open(const char *path, size_t size);
+
+/* Return 0 also if the family is already registered in the heap with
+ * the same struct_size, -1 on conflict or if the heap has no room for
+ * one more family*/
+int
+mm_persist_instantiate_new_page_family(mm_persist_t *persist,
+                                       char *struct_name,
+                                       uint32_t struct_size);
+
+/*root must be NULL or an object of the heap*/
+void
+mm_persist_set_root(mm_persist_t *persist, void *root);
+
+void *
+mm_persist_get_root(mm_persist_t *persist);
+
+intptr_t
+mm_persist_get_relocation(mm_persist_t *persist);
+
+/*Return -1 if msync() fails*/
+int
+mm_persist_sync(mm_persist_t *persist);
+
+/*Sync and unmap, families of the heap are unregistered*/
+void
+mm_persist_close(mm_persist_t *persist);
+
+/* Shared heaps keep page families in POSIX shared memory, used by
+ * several processes at the same time. The creator sizes the heap and
+ * registers families, other processes attach to it by name. XCALLOC()
+ * and xfree() on its families work in every attached process, an
+ * object allocated by one process may be freed by another. The heap is
+ * mapped at the same address in all processes, so that objects link to
+ * each other with plain pointers, attaching fails if that address is
+ * taken in the process. Allocations and frees take the process shared
+ * lock of the heap, which application code takes as well through
+ * mm_shm_lock() to read or update objects consistently, XCALLOC() and
+ * xfree() included as the lock is recursive. A process dying
+ * with the lock held leaves its lock to the next process as is.
+ * Families of a shared heap can not be destroyed, and are left out of
+ * the process wide statistics. One shared heap per process, a forked
+ * child inherits the one of its parent*/
+typedef struct mm_persist_ mm_shm_t;
+
+/* Create the shared memory object name with room for size bytes, or
+ * attach to an existing one if size is 0. Return NULL on failure*/
+mm_shm_t *
+mm_shm_open(const char *name, size_t size);
+
+/*Same return values as mm_persist_instantiate_new_page_family()*/
+int
+mm_shm_instantiate_new_page_family(mm_shm_t *shm,
+                                   char *struct_name,
+                                   uint32_t struct_size);
+
+void
+mm_shm_lock(mm_shm_t *shm);
+
+void
+mm_shm_unlock(mm_shm_t *shm);
+
+/*root must be NULL or an object of the heap, set under the lock*/
+void
+mm_shm_set_root(mm_shm_t *shm, void *root);
+
+void *
+mm_shm_get_root(mm_shm_t *shm);
+
+/* Unmap, families of the heap are unregistered in this process. The
+ * shared memory object stays till shm_unlink() and the last close*/
+void
+mm_shm_close(mm_shm_t *shm);
+
+/* Epoch based deferred frees, for objects which readers traverse without
+ * locks. Readers bracket every traversal with mm_epoch_enter() and
+ * mm_epoch_exit(), which only announce the current epoch of the thread
+ * and may nest. A writer unlinks an object, then xfree_deferred() queues
+ * it on a list of the calling thread. Queued objects are freed, in
+ * batches with xfree_bulk(), by later xfree_deferred() calls of the same
+ * thread once every reader which could hold them has exited. Deferred
+ * frees of a thread which exits are finished by the next thread taking
+ * over its epoch record. Like xfree(), xfree_deferred() must be
+ * serialized with the other Memory Manager calls. While objects of a
+ * family are deferred, mm_family_reset(), mm_family_destroy() and
+ * mm_obj_cache_destroy() of the family fail, mm_epoch_barrier() in
+ * every deferring thread frees them first*/
+void
+mm_epoch_enter();
+
+void
+mm_epoch_exit();
+
+void
+xfree_deferred(void *app_data);
+
+/* Wait until every object deferred by the calling thread is freed.
+ * Return -1 if called inside a read side critical section*/
+int
+mm_epoch_barrier();
+
 /*Printing Functions*/
 void mm_print_memory_usage(char *struct_name);
 void mm_print_block_usage();
+void mm_print_registered_page_families();
+
+/*Statistics Functions*/
+typedef struct mm_family_stats_{
+
+    char struct_name[MM_MAX_STRUCT_NAME];
+    uint32_t struct_size;
+    uint32_t vm_page_size;
+    uint64_t no_of_vm_pages;
+    uint64_t vm_page_memory;            /*Bytes held in VM pages*/
+    uint64_t memory_in_use_by_app;      /*Allocated data blocks including meta blocks*/
+    uint64_t peak_memory_in_use_by_app; /*High water mark of memory_in_use_by_app*/
+    uint64_t free_memory;               /*Sum of sizes of free data blocks*/
+    uint64_t no_of_free_blocks;
+    uint64_t no_of_allocated_blocks;
+    uint64_t largest_free_block;
+    uint64_t no_of_system_calls;
+    uint64_t no_of_allocations;         /*Cumulative*/
+    uint64_t no_of_deallocations;       /*Cumulative*/
+    uint64_t total_memory_allocated;    /*Cumulative application bytes*/
+    uint64_t no_of_compaction_passes;
+    uint64_t compaction_pages_reclaimed;    /*Cumulative*/
+    uint64_t compaction_bytes_moved;        /*Cumulative*/
+    uint64_t last_pass_pages_reclaimed;
+    uint64_t soft_page_limit;           /*VM pages, 0 if none*/
+    uint64_t hard_page_limit;
+    uint64_t no_of_soft_limit_hits;     /*VM pages acquired past a soft limit*/
+    uint64_t no_of_hard_limit_failures; /*VM pages refused by a hard limit*/
+    uint64_t no_of_reserved_vm_pages;   /*Unused yet, counted in no_of_vm_pages, not in free_memory*/
+} mm_family_stats_t;
+
+typedef struct mm_stats_{
+
+    uint32_t system_page_size;
+    uint32_t no_of_families;
+    uint64_t no_of_vm_pages;
+    uint64_t vm_page_memory;
+    uint64_t peak_vm_page_memory;       /*High water mark of vm_page_memory*/
+    uint64_t memory_in_use_by_app;
+    uint64_t peak_memory_in_use_by_app;
+    uint64_t free_memory;
+    uint64_t no_of_free_blocks;
+    uint64_t no_of_allocated_blocks;
+    uint64_t largest_free_block;
+    uint64_t no_of_system_calls;
+    uint64_t no_of_allocations;
+    uint64_t no_of_deallocations;
+    uint64_t total_memory_allocated;
+    uint64_t soft_vm_page_memory_limit; /*Bytes, 0 if none*/
+    uint64_t hard_vm_page_memory_limit;
+    uint64_t no_of_soft_limit_hits;
+    uint64_t no_of_hard_limit_failures;
+    uint64_t no_of_reserved_vm_pages;
+} mm_stats_t;
+
+/* Snapshots are built from counters maintained on every allocation
+ * and de-allocation, cost is O(no of page families)*/
+void
+mm_get_stats(mm_stats_t *stats);
+
+int
+mm_get_family_stats(char *struct_name, mm_family_stats_t *family_stats);
+
+/* Fragmentation, computed by walking all VM pages and blocks, so cost is
+ * O(no of blocks). Every byte of VM page memory is accounted in exactly
+ * one of app_data_bytes, meta_data_bytes, free_bytes or unusable_bytes*/
+typedef struct mm_frag_stats_{
+
+    uint64_t no_of_vm_pages;
+    uint64_t vm_page_memory;
+    uint64_t no_of_allocated_blocks;
+    uint64_t no_of_free_blocks;
+    uint64_t app_data_bytes;        /*Data bytes of allocated blocks*/
+    uint64_t meta_data_bytes;       /*VM page headers and meta blocks*/
+    uint64_t free_bytes;            /*Data bytes of free blocks*/
+    uint64_t unusable_bytes;        /*Page tails and slivers too small to split*/
+    uint64_t largest_free_block;
+    double external_fragmentation;  /*1 - largest_free_block/free_bytes*/
+    double internal_waste;          /*(meta_data + unusable)/vm_page_memory*/
+    double page_utilization;        /*app_data/vm_page_memory*/
+} mm_frag_stats_t;
+
+void
+mm_get_frag_stats(mm_frag_stats_t *frag_stats);
+
+int
+mm_get_family_frag_stats(char *struct_name, mm_frag_stats_t *frag_stats);
+
+/* Latency histograms per page family, available only if the library
+ * is built with -DMM_LATENCY_STATS (add -DMM_LATENCY_USE_TSC to count
+ * in TSC cycles instead of nano seconds). Bucket i counts the operations
+ * which took [2^(i-1), 2^i) ticks, bucket 0 counts the 0 tick ones*/
+typedef enum{
+
+    MM_LATENCY_OP_ALLOC,
+    MM_LATENCY_OP_FREE,
+    MM_LATENCY_OP_PAGE_ACQUIRE,
+    MM_LATENCY_OP_PAGE_RELEASE,
+    MM_LATENCY_OP_MAX
+} mm_latency_op_t;
+
+#define MM_LATENCY_HIST_BUCKETS 64
+
+typedef struct mm_latency_stats_{
+
+    uint64_t count;
+    uint64_t total;     /*Sum of all samples*/
+    uint64_t max;
+    uint64_t p50;       /*Percentiles are upper bounds of histogram buckets*/
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t bucket[MM_LATENCY_HIST_BUCKETS];
+} mm_latency_stats_t;
+
+/*Return -1 if family is not registered or latency stats are compiled out*/
+int
+mm_get_family_latency_stats(char *struct_name,
+                            mm_latency_op_t op,
+                            mm_latency_stats_t *latency_stats);
+
+/* Allocation event tracing, available only if the library is built
+ * with -DMM_TRACE. Every thread records its xcalloc/xfree and VM page
+ * events into its own lock-free ring buffer of MM_TRACE_RING_RECORDS
+ * records, the oldest records are overwritten once the ring is full*/
+typedef enum{
+
+    MM_TRACE_OP_ALLOC,
+    MM_TRACE_OP_FREE,
+    MM_TRACE_OP_PAGE_ACQUIRE,
+    MM_TRACE_OP_PAGE_RELEASE,
+    MM_TRACE_OP_FAMILY_RESET    /*size is the no of objects dropped*/
+} mm_trace_op_t;
+
+typedef struct mm_trace_record_{
+
+    uint64_t ts;        /*CLOCK_MONOTONIC nano seconds*/
+    uint64_t addr;      /*Application pointer, VM page for page events*/
+    uint64_t page;      /*Hosting VM page*/
+    uint32_t size;      /*Bytes requested/freed, VM page size for page events*/
+    uint16_t family_id;
+    uint8_t op;         /*mm_trace_op_t*/
+    uint8_t reserved;
+} mm_trace_record_t;
+
+/* Trace file layout : mm_trace_file_hdr_t, no_of_families x
+ * mm_trace_family_t, then till EOF any no of chunks, every chunk is one
+ * mm_trace_chunk_hdr_t followed by no_of_records x mm_trace_record_t of
+ * one thread in the order they were recorded. Chunks of different
+ * threads interleave, merge them by ts*/
+#define MM_TRACE_MAGIC      "LMMTRACE"
+#define MM_TRACE_VERSION    1
+
+typedef struct mm_trace_file_hdr_{
+
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t system_page_size;
+    uint32_t no_of_families;
+} mm_trace_file_hdr_t;
+
+typedef struct mm_trace_family_{
+
+    char struct_name[MM_MAX_STRUCT_NAME];
+    uint32_t struct_size;
+    uint16_t family_id;
+    uint16_t vm_page_units;
+} mm_trace_family_t;
+
+typedef struct mm_trace_chunk_hdr_{
+
+    uint32_t thread_id;
+    uint32_t no_of_records;
+} mm_trace_chunk_hdr_t;
+
+/* Write the trace rings of all threads to file_name, return the no of
+ * records written or -1 on error. Async signal safe*/
+int
+mm_trace_dump(const char *file_name);
+
+/*Dump the trace to file_name whenever signal signo is delivered*/
+int
+mm_trace_dump_on_signal(int signo, const char *file_name);
+
+/* Serialize the snapshot of all page families into buff. Return the
+ * no of bytes which would have been written had buff been large enough,
+ * same as snprintf()*/
+int
+mm_stats_to_json(char *buff, size_t buff_size);
+
+int
+mm_stats_to_csv(char *buff, size_t buff_size);
 
 /*Initialization Functions*/
 void
@@ -61,6 +669,23 @@ mm_init();
 #define MM_REG_STRUCT(struct_name)  \
     (mm_instantiate_new_page_family(#struct_name, sizeof(struct_name)))
 
+#define MM_PERSIST_REG_STRUCT(persist, struct_name)  \
+    (mm_persist_instantiate_new_page_family(persist, #struct_name, \
+        sizeof(struct_name)))
+
+#define MM_SHM_REG_STRUCT(shm, struct_name)  \
+    (mm_shm_instantiate_new_page_family(shm, #struct_name, \
+        sizeof(struct_name)))
+
+#define MM_SET_PLACEMENT_POLICY(struct_name, placement_policy)  \
+    (mm_set_page_family_placement_policy(#struct_name, placement_policy))
+
+#define MM_SET_FAMILY_LIMITS(struct_name, limits)  \
+    (mm_set_family_limits(#struct_name, limits))
+
+#define MM_RESERVE(struct_name, no_of_objects, flags)  \
+    (mm_reserve(#struct_name, no_of_objects, flags))
+
 /*Allocators and De-Allocators*/
 #define XCALLOC(units, struct_name) \
     (xcalloc(#struct_name, units))
@@ -68,4 +693,23 @@ mm_init();
 #define XFREE(ptr)  \
     xfree(ptr)
 
+#define XCALLOC_BUFF(size_in_bytes) \
+    (xcalloc_buff(size_in_bytes))
+
+#define XCALLOC_MOVABLE(units, struct_name) \
+    (xcalloc_movable(#struct_name, units))
+
+#define MM_COMPACT(struct_name) \
+    (mm_compact(#struct_name))
+
+#define MM_FAMILY_RESET(struct_name)    \
+    (mm_family_reset(#struct_name))
+
+#define MM_FAMILY_DESTROY(struct_name)  \
+    (mm_family_destroy(#struct_name))
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* __UAPI_MM__ */
@@ -0,0 +1,501 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  uapi_mm.hpp
+ *
+ *    Description:  This file defines the C++ interface of Memory Manager, header only,
+ *                  on top of uapi_mm.h
+ *
+ *        Version:  1.0
+ *        Created:  10/19/2026 06:33:40 PM
+ *       Revision:  none
+ *       Compiler:  g++
+ *
+ *         Author:  Er. Abhishek Sagar, Juniper Networks (https://csepracticals.wixsite.com/csepracticals), sachinites@gmail.com
+ *        Company:  Juniper Networks
+ *
+ *        This file is part of the Linux Memory Manager distribution (https://github.com/sachinites)
+ *        Copyright (c) 2019 Abhishek Sagar.
+ *        This program is free software: you can redistribute it and/or modify it under the terms of the GNU General
+ *        Public License as published by the Free Software Foundation, version 3.
+ *
+ *        This program is distributed in the hope that it will be useful, but
+ *        WITHOUT ANY WARRANTY; without even the implied warranty of
+ *        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ *        General Public License for more details.
+ *
+ *        visit website : https://csepracticals.wixsite.com/csepracticals for more courses and projects
+ *
+ * =====================================================================================
+ */
+
+#ifndef __UAPI_MM_HPP__
+#define __UAPI_MM_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+#include "uapi_mm.h"
+
+namespace mm {
+
+namespace detail {
+
+/* GCC and clang spell T in __PRETTY_FUNCTION__ as "... [with T = type]"
+ * and "... [T = type]"*/
+template <typename T>
+inline const char *
+pretty_function(){
+
+    return __PRETTY_FUNCTION__;
+}
+
+/* Page family name of a type, the type as spelled by the compiler without
+ * "std::" and blanks. A name too long for MM_MAX_STRUCT_NAME is cut, and
+ * ends with the hash of the whole spelling, so that types which differ
+ * only in the cut part get different families*/
+inline void
+family_name(const char *pretty_function, char *struct_name){
+
+    const char *start = std::strstr(pretty_function, "T = ");
+    const char *end = std::strrchr(pretty_function, ']');
+    size_t len = 0;
+    unsigned int hash = 2166136261U;    /*FNV-1a*/
+    const char *curr;
+
+    start = start ? start + 4 : pretty_function;
+    if(!end || end < start)
+        end = start + std::strlen(start);
+
+    for(curr = start; curr < end; curr++){
+
+        hash = (hash ^ (unsigned char)*curr) * 16777619U;
+
+        if(*curr == ' ')
+            continue;
+        if(!std::strncmp(curr, "std::", 5)){
+            curr += 4;
+            continue;
+        }
+        if(len < MM_MAX_STRUCT_NAME - 1)
+            struct_name[len] = *curr;
+        len++;
+    }
+
+    if(len < MM_MAX_STRUCT_NAME){
+        struct_name[len] = '\0';
+        return;
+    }
+    std::snprintf(struct_name + MM_MAX_STRUCT_NAME - 10, 10, "#%08x", hash);
+}
+
+} // namespace detail
+
+/* Page family of type T, registered on first use, named after the type.
+ * The handle is cached, allocations do not look the family up by name*/
+template <typename T>
+struct family{
+
+    /* Page memory and meta blocks are multiples of 16B, so the blocks of
+     * a family meet any alignment of T up to 16B*/
+    static_assert(alignof(T) <= 16, "over aligned type");
+
+    static const char *
+    name(){
+
+        static char struct_name[MM_MAX_STRUCT_NAME];
+
+        if(!struct_name[0])
+            detail::family_name(detail::pretty_function<T>(), struct_name);
+        return struct_name;
+    }
+
+    static mm_family_handle_t &
+    cached_handle(){
+
+        static mm_family_handle_t family_handle = MM_FAMILY_HANDLE_NULL;
+        return family_handle;
+    }
+
+    /*Out of line, so that it does not weigh on inlined allocations*/
+    __attribute__((noinline)) static mm_family_handle_t
+    register_family(){
+
+        char *struct_name = const_cast<char *>(name());
+        mm_family_handle_t family_handle = mm_get_family_handle(struct_name);
+
+        if(family_handle == MM_FAMILY_HANDLE_NULL){
+            mm_instantiate_new_page_family(struct_name, sizeof(T));
+            family_handle = mm_get_family_handle(struct_name);
+        }
+        cached_handle() = family_handle;
+        return family_handle;
+    }
+
+    static mm_family_handle_t
+    handle(){
+
+        mm_family_handle_t family_handle = cached_handle();
+
+        if(family_handle == MM_FAMILY_HANDLE_NULL)
+            family_handle = register_family();
+        return family_handle;
+    }
+
+    /* Zeroed memory for units objects of T, NULL on failure. A family
+     * destroyed with mm_family_destroy() is registered again*/
+    static void *
+    alloc(int units){
+
+        void *ptr = xcalloc_family(handle(), units);
+
+        if(!ptr && mm_get_family_handle(const_cast<char *>(name())) !=
+            cached_handle()){
+            ptr = xcalloc_family(register_family(), units);
+        }
+        return ptr;
+    }
+};
+
+/* Allocator of standard containers. Single objects, which is all that
+ * node based containers (list, map, set, and nodes of unordered ones)
+ * allocate, come from the page family of the rebound node type, so
+ * every node type shows up in the statistics of Memory Manager. Arrays,
+ * like the bucket arrays of unordered containers, come from operator
+ * new, they would seldom fit a VM page. Memory Manager must have been
+ * initialized with mm_init()*/
+template <typename T>
+class family_allocator{
+
+public:
+    typedef T value_type;
+
+    family_allocator() noexcept {}
+
+    template <typename U>
+    family_allocator(const family_allocator<U> &) noexcept {}
+
+    T *
+    allocate(std::size_t n){
+
+        void *ptr;
+
+        if(n != 1)
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+
+        ptr = family<T>::alloc(1);
+
+        if(!ptr)
+            throw std::bad_alloc();
+        return static_cast<T *>(ptr);
+    }
+
+    void
+    deallocate(T *ptr, std::size_t n) noexcept {
+
+        if(n != 1)
+            ::operator delete(ptr);
+        else
+            xfree(ptr);
+    }
+};
+
+template <typename T, typename U>
+inline bool
+operator==(const family_allocator<T> &, const family_allocator<U> &) noexcept {
+
+    return true;
+}
+
+template <typename T, typename U>
+inline bool
+operator!=(const family_allocator<T> &, const family_allocator<U> &) noexcept {
+
+    return false;
+}
+
+/* CRTP base routing new and delete of class T, and of its arrays, to
+ * the page family of T : class T : public mm::pooled<T> { ... }. A class
+ * derived from T, and an array with its cookie, take as many units of
+ * the family as cover their size, so everything is freed by xfree().
+ * With new inlined, size is sizeof(T) at compile time and new T is one
+ * xcalloc_family() of one unit with the cached family handle. Memory
+ * Manager must have been initialized with mm_init()*/
+template <typename T>
+class pooled{
+
+public:
+    static void *
+    operator new(std::size_t size){
+
+        void *ptr = alloc(size);
+
+        if(!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    static void *
+    operator new(std::size_t size, const std::nothrow_t &) noexcept {
+
+        return alloc(size);
+    }
+
+    static void *
+    operator new(std::size_t, void *ptr) noexcept {
+
+        return ptr;
+    }
+
+    static void *
+    operator new[](std::size_t size){
+
+        void *ptr = alloc(size);
+
+        if(!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    static void *
+    operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+
+        return alloc(size);
+    }
+
+    static void *
+    operator new[](std::size_t, void *ptr) noexcept {
+
+        return ptr;
+    }
+
+    static void
+    operator delete(void *ptr) noexcept {
+
+        if(ptr)
+            xfree(ptr);
+    }
+
+    static void
+    operator delete(void *ptr, const std::nothrow_t &) noexcept {
+
+        if(ptr)
+            xfree(ptr);
+    }
+
+    static void
+    operator delete(void *, void *) noexcept {}
+
+    static void
+    operator delete[](void *ptr) noexcept {
+
+        if(ptr)
+            xfree(ptr);
+    }
+
+    static void
+    operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+
+        if(ptr)
+            xfree(ptr);
+    }
+
+    static void
+    operator delete[](void *, void *) noexcept {}
+
+private:
+    static void *
+    alloc(std::size_t size) noexcept {
+
+        /*No VM page holds more than the biggest buffer, rejecting bigger
+         *sizes here keeps units * sizeof(T) in range*/
+        if(size > mm_get_buff_max_size())
+            return NULL;
+
+        std::size_t units = (size + sizeof(T) - 1) / sizeof(T);
+
+        return family<T>::alloc(units ? (int)units : 1);
+    }
+};
+
+#if __cplusplus >= 201703L
+
+/* Polymorphic memory resource of C++17 pmr containers. Buffers mode,
+ * the default, serves every allocation from the xcalloc_buff() size
+ * classes and frees it individually, so all buffers mode resources are
+ * equal and containers can share them. Arena mode, selected by giving
+ * an arena name, bump allocates from an arena of its own, deallocation
+ * is a no op and release() frees all the memory at once, so an arena
+ * mode resource is equal only to itself. Requests too big for a buffer,
+ * or bigger than a quarter of an arena VM page, come from operator new*/
+class memory_resource : public std::pmr::memory_resource{
+
+public:
+    memory_resource() noexcept : arena(NULL), big_blocks(NULL) {}
+
+    /*Throws std::bad_alloc if arena_name is a registered page family*/
+    explicit memory_resource(const char *arena_name) : big_blocks(NULL){
+
+        char name[MM_MAX_STRUCT_NAME];
+
+        std::snprintf(name, sizeof(name), "%s", arena_name);
+        arena = mm_arena_create(name);
+        if(!arena)
+            throw std::bad_alloc();
+    }
+
+    memory_resource(const memory_resource &) = delete;
+    memory_resource &operator=(const memory_resource &) = delete;
+
+    ~memory_resource(){
+
+        release();
+        if(arena)
+            mm_arena_destroy(arena);
+    }
+
+    /*Arena mode only, buffers are freed by their containers*/
+    void
+    release() noexcept {
+
+        big_block_t *big_block;
+
+        while(big_blocks){
+            big_block = big_blocks;
+            big_blocks = big_block->next;
+            ::operator delete(big_block->raw, big_block->align_val);
+        }
+        if(arena)
+            mm_arena_reset(arena);
+    }
+
+private:
+    /*Arena mode, header of an operator new block, lies just below it*/
+    typedef struct big_block_{
+
+        struct big_block_ *next;
+        void *raw;
+        std::align_val_t align_val;
+    } big_block_t;
+
+    /*Alignment of buffers and of arena memory*/
+    static constexpr std::size_t base_align = 16;
+
+    mm_arena_t *arena;
+    big_block_t *big_blocks;
+
+    static uintptr_t
+    align_up(uintptr_t x, std::size_t align){
+
+        return (x + align - 1) & ~((uintptr_t)align - 1);
+    }
+
+    static std::size_t
+    big_align(std::size_t align){
+
+        return align > base_align ? align : base_align;
+    }
+
+    /* Buffers are aligned to 16B, a buffer aligned beyond is carved out
+     * of a bigger one, which is remembered just below the aligned one*/
+    void *
+    buff_allocate(std::size_t bytes, std::size_t align){
+
+        char *raw, *ptr;
+
+        if(align <= base_align)
+            return xcalloc_buff((uint32_t)bytes);
+
+        raw = (char *)xcalloc_buff((uint32_t)(bytes + align));
+        if(!raw)
+            return NULL;
+        ptr = (char *)align_up((uintptr_t)raw + sizeof(void *), align);
+        ((void **)ptr)[-1] = raw;
+        return ptr;
+    }
+
+    void *
+    arena_allocate(std::size_t bytes, std::size_t align){
+
+        char *raw = (char *)mm_arena_alloc(arena,
+            (uint32_t)(bytes + (align > base_align ? align : 0)));
+
+        if(!raw)
+            return NULL;
+        return (void *)align_up((uintptr_t)raw, align);
+    }
+
+    void *
+    big_allocate(std::size_t bytes, std::size_t align){
+
+        std::size_t header_size = align_up(sizeof(big_block_t), big_align(align));
+        std::align_val_t align_val = (std::align_val_t)big_align(align);
+        char *raw = (char *)::operator new(header_size + bytes, align_val);
+        big_block_t *big_block = (big_block_t *)(raw + header_size) - 1;
+
+        big_block->raw = raw;
+        big_block->align_val = align_val;
+        big_block->next = big_blocks;
+        big_blocks = big_block;
+        return raw + header_size;
+    }
+
+    void *
+    do_allocate(std::size_t bytes, std::size_t align) override {
+
+        void *ptr;
+        std::size_t max_size = mm_get_buff_max_size();
+
+        if(arena){
+            if(bytes + align > max_size / 4)
+                return big_allocate(bytes, align);
+            ptr = arena_allocate(bytes, align);
+        }
+        else{
+            if(bytes + align > max_size)
+                return ::operator new(bytes, (std::align_val_t)big_align(align));
+            ptr = buff_allocate(bytes, align);
+        }
+        if(!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    void
+    do_deallocate(void *ptr, std::size_t bytes, std::size_t align) override {
+
+        if(arena)
+            return;
+
+        if(bytes + align > mm_get_buff_max_size())
+            ::operator delete(ptr, (std::align_val_t)big_align(align));
+        else if(align <= base_align)
+            xfree(ptr);
+        else
+            xfree(((void **)ptr)[-1]);
+    }
+
+    bool
+    do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+
+        const memory_resource *mm_other =
+            dynamic_cast<const memory_resource *>(&other);
+
+        if(!mm_other)
+            return false;
+        if(arena || mm_other->arena)
+            return this == mm_other;
+        return true;
+    }
+};
+
+#endif
+
+} // namespace mm
+
+#endif /* __UAPI_MM_HPP__ */